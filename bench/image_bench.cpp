@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../hpp/libspu.hpp"
+
+//many instances of one program with a snap, each started from pc 0 and then from an image of it:
+//./image_bench bin/output_bin.asm [instances 1000]
+//all of them stay alive until the end of a round, so the private memory it grew by is what they take; pages of the
+//image they only read are shared and not counted. what the program prints before its snap only the template prints
+
+const size_t DEFAULT_INSTANCES = 1000;
+
+typedef struct round{
+    double      seconds;
+    double      privateMB;
+    uint64_t    instructions;
+    uint64_t    checksum;
+    bool        same;                                       //every instance printed the same
+} round_t;
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+//resident and not backed by a file, 0 where there is no /proc
+static double PrivateMB(){
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+
+    unsigned long size = 0, resident = 0, shared = 0;
+    if (fscanf(statm, "%lu %lu %lu", &size, &resident, &shared) != 3) resident = shared = 0;
+    fclose(statm);
+
+    return (double)(resident - shared) * (double)sysconf(_SC_PAGESIZE) / (1 << 20);
+}
+
+static int CountOutput(void* data, int64_t value, bool isFloat){
+    uint64_t* checksum = (uint64_t*)data;
+    (void)isFloat;
+
+    *checksum = *checksum * 31 + (uint64_t)value;
+
+    return 0;
+}
+
+static int NoInput(void* data, int64_t* value, bool isFloat){
+    (void)data;
+    (void)value;
+    (void)isFloat;
+
+    return -1;
+}
+
+/*=================================================================*/
+//image nullptr - every instance runs the whole program
+
+static int Round(const spuProgram_t* program, const spuImage_t* image, spuContext_t* contexts, uint64_t* checksums,
+                 size_t numInstances, round_t* result){
+    *result = {};
+    result->same = true;
+
+    double memory   = PrivateMB();
+    double start    = Seconds();
+    int    status   = 0;
+
+    for (size_t i = 0; i < numInstances && !status; i++){
+        spuIo_t io = {checksums + i, NoInput, CountOutput};
+        checksums[i] = 0;
+
+        status = (image) ? SpuContextFromImage(contexts + i, image, &io) : SpuContextCtor(contexts + i, program, &io);
+
+        if (!status && SpuRun(contexts + i) != SPU_HALTED) status = -1;
+    }
+
+    result->seconds    = Seconds() - start;
+    result->privateMB  = PrivateMB() - memory;
+    result->checksum   = checksums[0];
+
+    for (size_t i = 0; i < numInstances; i++){
+        result->instructions += contexts[i].instructions;
+        if (checksums[i] != checksums[0]) result->same = false;
+
+        SpuContextDtor(contexts + i);
+    }
+
+    return status;
+}
+
+static void PrintRound(const char* name, const round_t* round, size_t numInstances){
+    printf("image: %-10s %8.1f ms, %6.1f us and %6.1f KB an instance, %8.1f M instructions%s\n",
+           name, round->seconds * 1e3, round->seconds * 1e6 / (double)numInstances,
+           round->privateMB * 1024 / (double)numInstances, (double)round->instructions * 1e-6,
+           (round->same) ? "" : ", instances printed different things");
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    const char* fileName     = (argc > 1) ? argv[1] : "./bin/output_bin.asm";
+    size_t      numInstances = (argc > 2) ? strtoul(argv[2], nullptr, 10) : DEFAULT_INSTANCES;
+
+    spuProgram_t program = {};
+    spuImage_t   image   = {};
+
+    if (!numInstances) return 1;
+
+    if (SpuProgramLoad(&program, fileName)){
+        printf("image: can not load \"%s\"\n", fileName);
+        return 1;
+    }
+
+    spuContext_t* contexts  = (spuContext_t*)calloc(sizeof(spuContext_t), numInstances);
+    uint64_t*     checksums = (uint64_t*)    calloc(sizeof(uint64_t),     numInstances);
+    if (!contexts || !checksums) return 1;
+
+    round_t cold = {}, snapped = {};
+
+    if (Round(&program, nullptr, contexts, checksums, numInstances, &cold)){
+        printf("image: \"%s\" does not halt on its own\n", fileName);
+        return 1;
+    }
+
+    double start = Seconds();
+
+    if (SpuImageCtor(&image, &program, nullptr)){
+        printf("image: \"%s\" has no snap it gets to\n", fileName);
+        return 1;
+    }
+
+    double imaged = Seconds();
+
+    if (Round(&program, &image, contexts, checksums, numInstances, &snapped)){
+        printf("image: an instance of the image failed\n");
+        return 1;
+    }
+
+    printf("image: the template ran %lu instructions up to the snap in %.1f us\n", image.instructions, (imaged - start) * 1e6);
+
+    PrintRound("from pc 0",  &cold,    numInstances);
+    PrintRound("from image", &snapped, numInstances);
+
+    if (cold.checksum != snapped.checksum) printf("image: the image prints something else than the program\n");
+
+    SpuImageDtor(&image);
+    free(checksums);
+    free(contexts);
+    SpuProgramDtor(&program);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../hpp/lexer.hpp"
+
+//synthetic source: labels, push/pop with every operand form, jumps, block commands and comments
+
+const size_t DEFAULT_SIZE_MB    = 256;
+const int    NUM_RUNS           = 5;
+
+static const char* SAMPLE_LINES[] = {
+    "loop_%lu:\n",
+    "    push [ax+%lu]\n",
+    "    push bx\n",
+    "    push %lu\n",
+    "    pop [%lu]\n",
+    "    add\n",
+    "    ja loop_%lu:            // back edge\n",
+    "    copy %lu, cx, 64\n",
+    "    vadd [ax], bx, 1024, 16\n",
+    "// %lu\n",
+    "    pop cx\n",
+    "    call func_%lu:\n"
+};
+
+static const size_t NUM_SAMPLE_LINES = sizeof(SAMPLE_LINES) / sizeof(SAMPLE_LINES[0]);
+
+/*=================================================================*/
+
+static char* GenerateSource(size_t size){
+    char* source = (char*)calloc(size + 128, sizeof(char));
+    if (!source) return nullptr;
+
+    size_t pos  = 0;
+    size_t line = 0;
+
+    while (pos < size){
+        pos += (size_t)sprintf(source + pos, SAMPLE_LINES[line % NUM_SAMPLE_LINES], line);
+        line++;
+    }
+
+    return source;
+}
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    size_t sizeMb = (argc > 1) ? strtoul(argv[1], nullptr, 10) : DEFAULT_SIZE_MB;
+    size_t size   = sizeMb << 20;
+
+    char* source = GenerateSource(size);
+    if (!source) return 1;
+
+    size = strlen(source);
+
+    double best      = 0;
+    size_t numTokens = 0;
+
+    for (int run = 0; run < NUM_RUNS; run++){
+        lexer_t lexer = {};
+        if (LexerCtor(&lexer, source, size)) return 1;
+
+        numTokens = 0;
+        double start = Seconds();
+
+        while (!LexTokens(&lexer) && lexer.numTokens) numTokens += lexer.numTokens;
+
+        double time = Seconds() - start;
+        if (!run || time < best) best = time;
+
+        LexerDtor(&lexer);
+    }
+
+    printf("lexer: %lu MB, %lu tokens, %.3f s, %.1f MB/s\n", size >> 20, numTokens, best, (double)size / best / (1 << 20));
+
+    free(source);
+
+    return 0;
+}
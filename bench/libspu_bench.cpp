@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../hpp/libspu.hpp"
+#include "../hpp/operations.hpp"
+
+//one program loaded once, then reset and run in the same context: ./libspu_bench bin/output_bin.asm 10000 [fuel]
+//the first run prints what the program outputs, the rest only count it; with fuel every run goes in slices of it
+
+const size_t DEFAULT_RUNS = 10000;
+
+typedef struct benchOutput{
+    bool        print;
+    uint64_t    numValues;
+    uint64_t    checksum;
+} benchOutput_t;
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static int CountOutput(void* data, int64_t value, bool isFloat){
+    benchOutput_t* output = (benchOutput_t*)data;
+
+    if (output->print){
+        if (isFloat) printf("%.*lg\n", FLOAT_OUT_PRECISION, WordToDouble(value));
+        else         printf("%lld\n",  (long long)value);
+    }
+
+    output->numValues++;
+    output->checksum = output->checksum * 31 + (uint64_t)value;
+
+    return 0;
+}
+
+static int NoInput(void* data, int64_t* value, bool isFloat){
+    (void)data;
+    (void)value;
+    (void)isFloat;
+
+    return -1;
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    const char* fileName = (argc > 1) ? argv[1] : "./bin/output_bin.asm";
+    size_t      numRuns  = (argc > 2) ? strtoul(argv[2], nullptr, 10) : DEFAULT_RUNS;
+    uint64_t    fuel     = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 0;
+
+    spuProgram_t  program = {};
+    spuContext_t  ctx     = {};
+    benchOutput_t output  = {true, 0, 0};
+    spuIo_t       io      = {&output, NoInput, CountOutput};
+
+    double start = Seconds();
+
+    if (SpuProgramLoad(&program, fileName)){
+        printf("libspu: can not load \"%s\"\n", fileName);
+        return 1;
+    }
+
+    double loaded = Seconds();
+
+    if (SpuContextCtor(&ctx, &program, &io)) return 1;
+
+    double created = Seconds();
+
+    spuStatus status = SpuRun(&ctx);
+    printf("libspu: %s after %lu instructions\n", SpuStatusName(status), ctx.instructions);
+
+    output.print = false;
+    uint64_t firstChecksum     = output.checksum;
+    uint64_t firstInstructions = ctx.instructions;
+    uint64_t instructions      = 0;
+    uint64_t slices            = 0;
+
+    double runs = Seconds();
+
+    for (size_t run = 0; run < numRuns; run++){
+        output.checksum = 0;
+
+        SpuContextReset(&ctx);
+
+        if (!fuel) SpuRun(&ctx);
+        else{
+            while (SpuRunSlice(&ctx, fuel) == SPU_OUT_OF_FUEL) slices++;
+            slices++;
+        }
+
+        instructions += ctx.instructions;
+        if (output.checksum != firstChecksum || ctx.instructions != firstInstructions){
+            printf("libspu: run %lu went some other way\n", run);
+        }
+    }
+
+    double end = Seconds();
+    double perRun = (end - runs) / (double)((numRuns) ? numRuns : 1);
+
+    printf("libspu: load %.1f us, context %.1f us, %lu runs, %.2f us per reset and run, %.1f M instructions/s\n",
+           (loaded - start) * 1e6, (created - loaded) * 1e6, numRuns, perRun * 1e6,
+           (double)instructions / (end - runs) * 1e-6);
+
+    if (fuel) printf("libspu: slices of %llu fuel, %.1f per run\n", (unsigned long long)fuel, (double)slices / (double)((numRuns) ? numRuns : 1));
+
+    SpuContextDtor(&ctx);
+    SpuProgramDtor(&program);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//par on 1, 2, 4 ... threads, timed from outside: ./compile tests/par_reduce && ./par_bench [./main] [threads, all cores]
+//main takes the thread count with in, its two outputs must match each other and the ones of every other count
+
+const size_t MAX_COMMAND = 512;
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static int RunMain(const char* mainPath, size_t numThreads, double* seconds, long long* result){
+    char command[MAX_COMMAND] = {};
+    snprintf(command, sizeof(command), "%s > /dev/null 2>&1", mainPath);
+
+    remove("meow.txt");                                                     //the exit code says nothing, a debug main leaks
+
+    double start = Seconds();
+
+    FILE* input = popen(command, "w");
+    if (!input) return -1;
+
+    fprintf(input, "%lu\n", numThreads);
+    if (pclose(input) == -1) return -1;
+
+    *seconds = Seconds() - start;
+
+    FILE* output = fopen("meow.txt", "r");
+    if (!output) return -1;
+
+    long long total = 0, again = 0;
+    int       read  = fscanf(output, "%lld %lld", &total, &again);
+    fclose(output);
+
+    if (read != 2 || total != again) return -1;
+
+    *result = total;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    const char* mainPath   = (argc > 1) ? argv[1] : "./main";
+    size_t      maxThreads = (argc > 2) ? strtoul(argv[2], nullptr, 10) : (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (!maxThreads) return 1;
+
+    double    single = 0;
+    long long first  = 0;
+
+    for (size_t numThreads = 1; ; numThreads *= 2){
+        if (numThreads > maxThreads) numThreads = maxThreads;
+
+        double    seconds = 0;
+        long long result  = 0;
+
+        if (RunMain(mainPath, numThreads, &seconds, &result)){
+            printf("par: %s on %lu threads failed\n", mainPath, numThreads);
+            return 1;
+        }
+
+        if (numThreads == 1){
+            single = seconds;
+            first  = result;
+        }
+
+        printf("par: %3lu threads, %8.1f ms, x%.2f%s\n", numThreads, seconds * 1e3, single / seconds,
+               (result == first) ? "" : ", a different result");
+
+        if (numThreads == maxThreads) break;
+    }
+
+    return 0;
+}
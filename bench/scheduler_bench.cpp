@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../hpp/scheduler.hpp"
+#include "../hpp/operations.hpp"
+
+//many copies of one program on 1, 2, 4 ... workers next to idle ones parked on in:
+//./scheduler_bench bin/output_bin.asm [tasks 1000] [idle 10000] [fuel] [workers, all cores]
+//the busy ones get their input closed, so an in reads 0; the idle ones get a value fed at the end of each round
+
+const size_t DEFAULT_TASKS = 1000;
+const size_t DEFAULT_IDLE  = 10000;
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static int CountOutput(void* data, int64_t value, bool isFloat){
+    uint64_t* checksum = (uint64_t*)((spuTask_t*)data)->data;
+    (void)isFloat;
+
+    *checksum = *checksum * 31 + (uint64_t)value;
+
+    return 0;
+}
+
+//in, out, hlt: waits for one value and gives it back
+static int IdleProgram(spuProgram_t* program){
+    struct{
+        header_t header;
+        int64_t  code[3];
+    } image = {{SIGNATURE, VERSION, 3}, {IN, OUT, HLT}};
+
+    return SpuProgramFromMemory(program, &image, sizeof(image));
+}
+
+/*=================================================================*/
+
+static int Round(spuTask_t* tasks, size_t numTasks, size_t numIdle, uint64_t* checksums, size_t numWorkers, uint64_t fuel,
+                 double* seconds, uint64_t* instructions){
+    scheduler_t scheduler = {};
+    if (SchedulerCtor(&scheduler, numWorkers, fuel)) return -1;
+
+    size_t numAll = numTasks + numIdle;
+
+    for (size_t i = 0; i < numAll; i++){
+        SpuTaskReset(tasks + i);
+        if (i < numTasks) SchedulerClose(tasks + i);
+
+        checksums[i] = 0;
+    }
+
+    for (size_t i = numTasks; i < numAll; i++) SchedulerSpawn(&scheduler, tasks + i);
+    SchedulerWait(&scheduler);                                              //all idle ones parked
+
+    double start = Seconds();
+
+    for (size_t i = 0; i < numTasks; i++) SchedulerSpawn(&scheduler, tasks + i);
+    SchedulerWait(&scheduler);
+
+    *seconds      = Seconds() - start;
+    *instructions = 0;
+
+    for (size_t i = 0; i < numTasks; i++) *instructions += tasks[i].ctx.instructions;
+
+    for (size_t i = numTasks; i < numAll; i++) SchedulerFeed(tasks + i, (int64_t)i);
+    SchedulerWait(&scheduler);
+
+    SchedulerDtor(&scheduler);
+
+    int status = 0;
+
+    for (size_t i = 0; i < numAll; i++){
+        if (tasks[i].ctx.status != SPU_HALTED) status = -1;
+        if (i < numTasks && checksums[i] != checksums[0]) status = -1;
+        if (i >= numTasks && checksums[i] != i) status = -1;
+    }
+
+    return status;
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    const char* fileName   = (argc > 1) ? argv[1] : "./bin/output_bin.asm";
+    size_t      numTasks   = (argc > 2) ? strtoul (argv[2], nullptr, 10) : DEFAULT_TASKS;
+    size_t      numIdle    = (argc > 3) ? strtoul (argv[3], nullptr, 10) : DEFAULT_IDLE;
+    uint64_t    fuel       = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 0;
+    size_t      maxWorkers = (argc > 5) ? strtoul (argv[5], nullptr, 10) : (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    spuProgram_t program = {};
+    spuProgram_t idle    = {};
+
+    if (!numTasks || !maxWorkers) return 1;
+
+    if (SpuProgramLoad(&program, fileName) || IdleProgram(&idle)){
+        printf("scheduler: can not load \"%s\"\n", fileName);
+        return 1;
+    }
+
+    size_t     numAll    = numTasks + numIdle;
+    spuTask_t* tasks     = (spuTask_t*)calloc(sizeof(spuTask_t), numAll);
+    uint64_t*  checksums = (uint64_t*) calloc(sizeof(uint64_t),  numAll);
+    if (!tasks || !checksums) return 1;
+
+    for (size_t i = 0; i < numAll; i++){
+        if (SpuTaskCtor(tasks + i, (i < numTasks) ? &program : &idle, CountOutput, checksums + i)){
+            printf("scheduler: no memory for task %lu\n", i);
+            return 1;
+        }
+    }
+
+    printf("scheduler: %lu tasks of \"%s\", %lu idle ones parked on in\n", numTasks, fileName, numIdle);
+
+    double single = 0;
+
+    for (size_t numWorkers = 1; ; numWorkers *= 2){
+        if (numWorkers > maxWorkers) numWorkers = maxWorkers;
+
+        double   seconds      = 0;
+        uint64_t instructions = 0;
+
+        if (Round(tasks, numTasks, numIdle, checksums, numWorkers, fuel, &seconds, &instructions)){
+            printf("scheduler: %lu workers went some other way\n", numWorkers);
+        }
+
+        if (numWorkers == 1) single = seconds;
+
+        printf("scheduler: %3lu workers, %8.1f ms, %10.0f tasks/s, %8.1f M instructions/s, x%.2f\n",
+               numWorkers, seconds * 1e3, (double)numTasks / seconds, (double)instructions / seconds * 1e-6, single / seconds);
+
+        if (numWorkers == maxWorkers) break;
+    }
+
+    for (size_t i = 0; i < numAll; i++) SpuTaskDtor(tasks + i);
+
+    free(checksums);
+    free(tasks);
+    SpuProgramDtor(&idle);
+    SpuProgramDtor(&program);
+
+    return 0;
+}
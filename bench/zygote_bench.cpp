@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../hpp/zygote.hpp"
+
+//latency of one job: a fork and exec of main against a request to a running ./zygote on the same binary
+//./zygote bin/output_bin.asm & ./zygote_bench [jobs 1000] [socket] [./main]
+//every job reads /dev/null and writes to /dev/null, main is given the same binary in ./bin/output_bin.asm
+
+const size_t DEFAULT_JOBS = 1000;
+
+/*=================================================================*/
+
+static double Seconds(){
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static int CompareDoubles(const void* first, const void* second){
+    double a = *(const double*)first, b = *(const double*)second;
+
+    return (a > b) - (a < b);
+}
+
+static void PrintLatencies(const char* name, double* latencies, size_t numJobs, size_t numFailed){
+    qsort(latencies, numJobs, sizeof(double), CompareDoubles);
+
+    double sum = 0;
+    for (size_t i = 0; i < numJobs; i++) sum += latencies[i];
+
+    printf("zygote: %-6s mean %8.1f us, p50 %8.1f us, p99 %8.1f us, %lu failed\n", name,
+           sum / (double)numJobs * 1e6, latencies[numJobs / 2] * 1e6, latencies[numJobs * 99 / 100] * 1e6, numFailed);
+}
+
+/*=================================================================*/
+
+static int ExecJob(const char* mainPath, int devNull){
+    pid_t pid = fork();
+
+    if (!pid){
+        dup2(devNull, STDIN_FILENO);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+
+        execl(mainPath, mainPath, (char*)nullptr);
+        _exit(127);
+    }
+
+    if (pid < 0) return -1;
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) return -1;
+
+    return (WEXITSTATUS(status) == 127) ? -1 : 0;                           //main's own exit codes say little
+}
+
+/*=================================================================*/
+
+int main(int argc, char* argv[]){
+    size_t      numJobs    = (argc > 1) ? strtoul(argv[1], nullptr, 10) : DEFAULT_JOBS;
+    const char* socketPath = (argc > 2) ? argv[2] : ZYGOTE_DEFAULT_SOCKET;
+    const char* mainPath   = (argc > 3) ? argv[3] : "./main";
+
+    if (!numJobs) return 1;
+
+    int     devNull   = open("/dev/null", O_RDWR);
+    double* latencies = (double*)calloc(sizeof(double), numJobs);
+    if (devNull < 0 || !latencies) return 1;
+
+    size_t numFailed = 0;
+
+    for (size_t i = 0; i < numJobs; i++){
+        double  start    = Seconds();
+        int32_t exitCode = 0;
+
+        if (ZygoteRequest(socketPath, devNull, devNull, &exitCode)){
+            printf("zygote: no server on \"%s\"\n", socketPath);
+            return 1;
+        }
+
+        latencies[i] = Seconds() - start;
+        if (exitCode) numFailed++;
+    }
+
+    PrintLatencies("zygote", latencies, numJobs, numFailed);
+
+    numFailed = 0;
+
+    for (size_t i = 0; i < numJobs; i++){
+        double start = Seconds();
+
+        if (ExecJob(mainPath, devNull)) numFailed++;
+
+        latencies[i] = Seconds() - start;
+    }
+
+    PrintLatencies("exec", latencies, numJobs, numFailed);
+
+    free(latencies);
+    close(devNull);
+
+    return 0;
+}
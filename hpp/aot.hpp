@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "processor.hpp"
+
+const size_t AOT_MAX_STACK      = 1 << 16;                  //words of the evaluation stack in the generated main()
+const size_t AOT_MAX_CALLS      = 1 << 14;
+
+typedef struct aotReport{
+    size_t      numInstrs;
+    size_t      numLabels;                                  //jump targets and return sites
+    size_t      numCallSites;
+    size_t      numRets;
+} aotReport_t;
+
+typedef struct aot{
+    const int64_t*  code;
+    size_t          numCommands;
+
+    const int64_t*  data;                                   //copied into RAM at dataAddress before the first instruction
+    size_t          numData;
+    size_t          dataAddress;
+
+    bool*           isStart;                                //an instruction starts at this address
+    bool*           isLabel;                                //something jumps or returns here
+    bool            usesCalls;
+    bool            usesHalt;
+
+    aotReport_t     report;
+} aot_t;
+
+//0 - ok, AotCtor() fails on code it can not decode, bad registers, jumps into the middle of an instruction
+//or thread opcodes, those only run on main
+int     AotCtor         (aot_t* aot, const int64_t* code, size_t numCommands);
+int     AotDtor         (aot_t* aot);
+
+//the whole program as one C main(): pc - label, jumps - goto, ret - switch over the call sites
+int     EmitC           (aot_t* aot, FILE* file, const char* binaryName);
+void    PrintAotReport  (const aotReport_t* report, FILE* file);
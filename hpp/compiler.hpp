@@ -11,41 +11,60 @@ enum checkMarkParams{
     FROM_FUNC = 1
 };
 
-typedef struct header{
-
-    int64_t     signature;
-    int64_t     version;
-    uint64_t    numCommands;
-
-} header_t;
-
 typedef struct fileNames{
     const char* inputFileName;
     const char* outputFileName;
     const char* logFileName;
+    const char* objectFileName;                             //-c: write an object instead of the binary
 
 } fileNames_t;
 
+typedef struct compileOptions{
+    size_t      numThreads;                                 //0 - one per core
+    const char* cacheName;                                  //incremental assembly
+    bool        optimize;                                   //-O
+    bool        optReport;                                  //-R, bytes and instructions saved by -O
+    const char* profileName;                                    //-P, block layout from a main -p profile
+
+} compileOptions_t;
+
 typedef struct string{
-    size_t size;
-    char*  addr;
+    size_t      size;
+    const char* addr;
 } string_t;
 
+typedef struct operand{
+    bool        mem;
+    bool        reg;
+    bool        imm;
+
+    int64_t     numReg;
+    int64_t     numArg;
+} operand_t;
+
 typedef struct label{
-    char    name[64];
-    int64_t  addr;
+    const char* name;                                       //interned in commands_t::nameBlocks
+    size_t      nameSize;
+    uint64_t    hash;
+    int64_t     addr;
 
 } label_t;
 
+//a source line with code: pc of its first word, line within the unit; file is set once units are linked
+typedef struct lineMark{
+    int64_t  pc;
+    int64_t  line;
+    uint64_t file;
+} lineMark_t;
+
 typedef struct fixup{
     int64_t  codeAdr;
-    int64_t  labelNum;
+    int64_t  labelNum;                                      //RELOCATION - add the chunk base instead
 
 } fixup_t;
 
 typedef struct commands{
     const char*     name;
-    header_t        header;
 
     void*           codePointer;
 
@@ -57,14 +76,36 @@ typedef struct commands{
     size_t          sizeLabels;
     size_t          numElemsLabels;
 
+    size_t*         labelsHash;                             //open addressing, label index + 1, 0 - empty
+    size_t          sizeLabelsHash;
+
+    char**          nameBlocks;
+    size_t          numNameBlocks;
+    size_t          nameBlockUsed;
+
     fixup_t*        fixupPointer;
     size_t          sizeFixup;
     size_t          numElemsFixup;
 
-    void*           fileBuffer;
+    int64_t*        dataPointer;                            //.data and .zero runs: address, count, words;
+    size_t          sizeData;                               //count < 0 - that many zeros, no words
+    size_t          numData;
+
+    lineMark_t*     linesPointer;
+    size_t          sizeLines;
+    size_t          numMarks;
+
+    const char**    lineFiles;                              //file of each lineMark_t::file after the link
+    size_t          numLineFiles;
+
+    const char*     fileBuffer;                             //mapped input file, read-only
     size_t          sizeFileBuffer;
-    string_t*       splittedInput;
-    size_t          numSplitted;
+    bool            isMapped;
+    size_t          numLine;
+
+    bool            relocatable;                            //code is moved after assembly, see chunk_t
+    const char*     errorLine;
+    size_t          errorLineSize;
 
     fileNames_t*    fileNames;
     FILE*           logFile;
@@ -72,3 +113,65 @@ typedef struct commands{
     FILE*           outputFile;
     FILE*           outputBinFile;
 } commands_t;
+
+//a slice of the source assembled on its own thread with local labels and fixups
+typedef struct chunk{
+    commands_t      unit;
+
+    const char*     begin;
+    size_t          size;
+
+    size_t          base;                                   //code offset after the merge
+    size_t          firstLine;
+    int64_t*        labelValues;                            //per local label, value for its fixups
+
+    int64_t*        code;                                   //merged code buffer
+    errors          result;
+
+    uint64_t        hash;                                   //of the source text, key in the cache
+    const char*     cached;                                 //cache entry with the encoded unit or nullptr
+    const char*     fileName;                               //object file the unit was linked from
+} chunk_t;
+
+typedef struct chunkPool{
+    chunk_t*        chunks;
+    size_t          numChunks;
+    size_t          next;                                   //taken atomically by the workers
+    void*         (*worker)(void*);
+} chunkPool_t;
+
+//cache and object files: unitsHeader_t, then numEntries of unitEntry_t followed by
+//code words, data runs, line marks, label records, fixups and label names, all padded to 8 bytes.
+//in an object file labels with addr == -1 are imports, the rest are exports
+typedef struct unitsHeader{
+    int64_t         signature;
+    int64_t         version;
+    uint64_t        numEntries;
+} unitsHeader_t;
+
+typedef struct unitEntry{
+    uint64_t        hash;
+    uint64_t        sourceSize;
+    uint64_t        numCommands;
+    uint64_t        numLine;
+    uint64_t        numLabels;
+    uint64_t        numFixups;
+    uint64_t        numData;                                //words of the data runs
+    uint64_t        numMarks;
+    uint64_t        sizeEntry;                              //in bytes, with this header
+} unitEntry_t;
+
+typedef struct unitLabel{
+    int64_t         addr;
+    uint64_t        nameSize;
+} unitLabel_t;
+
+typedef struct cache{
+    const char*     name;
+    char*           buffer;
+    size_t          size;
+    size_t          numEntries;
+
+    const char**    table;                                  //open addressing by entry hash
+    size_t          sizeTable;
+} cache_t;
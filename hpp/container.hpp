@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+//sectioned binary: containerHeader_t and the section table in the first page, then every section on a page
+//of its own, so a loader maps the file once and takes pointers into it. code is the program's words; zero has
+//no bytes in the file, its words of RAM are cleared first and data is copied over them at its own address;
+//symbols are containerSymbol_t records with their names, lines is the debug line table
+//the old flat binary, header_t and the code right after it, still loads everywhere
+
+const int64_t   CONTAINER_SIGNATURE = 0x4E4F43574F454D;     //MEOWCON
+const int64_t   CONTAINER_VERSION   = 1;
+const size_t    CONTAINER_ALIGN     = 4096;
+const size_t    CONTAINER_BLOCK     = 1 << 16;              //bytes, a checksum is summed up of these
+const size_t    MAX_SECTIONS        = 8;
+
+enum sectionType{
+    SECTION_CODE    = 1,
+    SECTION_DATA    = 2,
+    SECTION_ZERO    = 3,
+    SECTION_SYMBOLS = 4,
+    SECTION_LINES   = 5
+};
+
+typedef struct containerHeader{
+    int64_t     signature;
+    int64_t     version;
+    uint64_t    numSections;
+    uint64_t    fileSize;
+} containerHeader_t;
+
+typedef struct section{
+    uint64_t    type;
+    uint64_t    offset;                                     //a multiple of CONTAINER_ALIGN, 0 - nothing in the file
+    uint64_t    size;                                       //bytes in the file, a multiple of 8; words for zero
+    int64_t     address;                                    //RAM word data and zero start at
+    uint64_t    checksum;                                   //of the bytes in the file
+} section_t;
+
+typedef struct containerSymbol{
+    int64_t     addr;                                       //pc of the label
+    uint64_t    nameSize;                                   //the name follows, padded to 8 bytes
+} containerSymbol_t;
+
+typedef struct container{
+    const char*         file;                               //mapped or the caller's, never written
+    size_t              size;
+    bool                mapped;
+
+    const section_t*    sections;
+    size_t              numSections;
+    bool                verified[MAX_SECTIONS];
+} container_t;
+
+//what ContainerWrite() lays out, data nullptr for zero
+typedef struct sectionData{
+    sectionType type;
+    const void* data;
+    size_t      size;
+    int64_t     address;
+} sectionData_t;
+
+//the header and the table are checked here, checksums only when a section is asked for or by ContainerVerify()
+int             ContainerMap        (container_t* container, int fd);
+int             ContainerFromMemory (container_t* container, const void* image, size_t size);       //image stays the caller's
+int             ContainerClose      (container_t* container);
+bool            IsContainer         (const void* image, size_t size);
+
+const section_t* ContainerFind      (const container_t* container, sectionType type);             //nullptr - no such section
+
+//the bytes of a section, its checksum is verified the first time; nullptr - no such section or a bad checksum
+const void*     ContainerSection    (container_t* container, sectionType type, size_t* size);
+
+//every section not verified yet, the blocks of all of them spread over numThreads, 0 - one per core; -1 - a bad one
+int             ContainerVerify     (container_t* container, size_t numThreads);
+
+int             ContainerWrite      (FILE* file, const sectionData_t* sections, size_t numSections);
+uint64_t        SectionChecksum     (const void* data, size_t size);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "/Users/asssh/Desktop/mystack/mystack.hpp"
+#include "processor.hpp"
+
+//green threads of one processor: spawn, yield, join, exit
+//a thread has its own pc, registers, stack and return stack, RAM is shared; only one runs at a time and
+//it runs until it yields, joins a live thread or exits, so nothing between two of those can be interleaved
+//a switch only swaps the processor's pc, register and stack pointers, no OS thread is involved
+
+const uint32_t GREEN_NONE       = UINT32_MAX;
+const size_t   GREEN_MIN_SLOTS  = 16;
+
+enum greenResult{
+    GREEN_OK        = 0,
+    GREEN_DONE      = 1,                                    //the last thread exited
+    GREEN_DEADLOCK  = 2,                                    //join with nobody left to run
+    GREEN_BAD_ID    = 3,
+    GREEN_NO_MEMORY = 4
+};
+
+typedef struct greenThread{
+    size_t      pc;                                         //saved while it does not run
+    int64_t*    registers;
+    Stack_t*    stk;
+    Stack_t*    returnStack;
+
+    uint32_t    generation;                                 //bumped when the slot is freed, old ids stop matching
+    bool        live;
+    uint32_t    waiters;                                    //first thread joined on this one
+    uint32_t    nextWaiter;
+
+    int64_t     ownRegisters[REGISTER_NUM + 1];             //slot 0 keeps the processor's
+} greenThread_t;
+
+typedef struct greenStats{
+    uint64_t    spawned;
+    uint64_t    switches;
+    uint64_t    joinsWaited;
+    size_t      maxLive;
+} greenStats_t;
+
+//thread id: generation << 32 | slot, the thread Run() starts with is 0
+typedef struct green{
+    size_t*         pc;                                     //the processor's fields a switch loads
+    void**          registers;
+    Stack_t**       stk;
+    Stack_t**       returnStack;
+
+    greenThread_t** threads;                                //by slot, nothing until the first spawn
+    size_t          numThreads;
+    size_t          sizeThreads;
+    uint32_t        current;
+    size_t          numLive;
+
+    uint32_t*       runQueue;                               //ring of slots, as big as threads
+    size_t          runHead;
+    size_t          numRunnable;
+
+    uint32_t*       freeSlots;
+    size_t          numFree;
+
+    greenStats_t    stats;
+} green_t;
+
+int         GreenCtor       (green_t* green, size_t* pc, void** registers, Stack_t** stk, Stack_t** returnStack);
+int         GreenDtor       (green_t* green);                                   //gives the processor back thread 0's state
+
+//the new thread starts at target with a copy of the registers and empty stacks, it runs after the ones queued now
+greenResult GreenSpawn      (green_t* green, size_t target, int64_t* id);
+
+//pc must already point past the instruction, a switch saves it
+greenResult GreenYield      (green_t* green);
+greenResult GreenJoin       (green_t* green, int64_t id);
+greenResult GreenExit       (green_t* green);
+
+void        PrintGreenStats (const green_t* green, FILE* file);
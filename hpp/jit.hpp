@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "/Users/asssh/Desktop/mystack/mystack.hpp"
+#include "processor.hpp"
+
+const uint64_t JIT_HOT_LOOP         = 64;                   //back jumps to a pc before its loop is traced
+const size_t   JIT_MAX_TRACE        = 256;                  //stack instructions in one trace
+const size_t   JIT_MAX_DEPTH        = 32;                   //stack values a trace keeps in its frame
+const uint32_t JIT_MAX_ABORTS       = 3;
+
+typedef struct traceStep{
+    size_t      pc;
+    size_t      nextPc;                                     //where the interpreter went, gives the guard direction
+} traceStep_t;
+
+typedef struct traceValue{
+    bool        isConst;
+    int64_t     value;                                      //the constant, frame[i] otherwise
+} traceValue_t;
+
+typedef struct traceExit{
+    size_t      pc;                                         //the interpreter goes on here
+    size_t      depth;                                      //stack values pushed back on the exit
+    size_t      firstValue;
+    size_t      pos;                                        //stack instructions run in the last iteration
+    bool        inLoop;                                     //a branch went the other way, not the loop's own exit
+} traceExit_t;
+
+typedef struct trace{
+    void*           native;                                 //int (*)(jitState_t*), returns the exit
+    size_t          nativeSize;
+    size_t          length;
+
+    traceExit_t*    exits;
+    size_t          numExits;
+    traceValue_t*   values;
+} trace_t;
+
+typedef struct jitState{
+    int64_t*    registers;
+    int64_t*    RAM;
+    int64_t*    frame;
+    FILE*       outputFile;
+    uint64_t    iterations;                                 //bumped by the native code on every loop back
+} jitState_t;
+
+typedef struct jitStats{
+    uint64_t    tracesCompiled;
+    uint64_t    tracesAborted;
+    uint64_t    traceEntries;
+    uint64_t    iterations;
+    uint64_t    guardExits;                                 //exits back into the loop body, the rest leave the loop
+    uint64_t    nativeInstrs;                               //stack instructions run as native code
+    uint64_t    interpreted;
+} jitStats_t;
+
+typedef struct jit{
+    const int64_t*  code;
+    size_t          numCommands;
+
+    uint64_t*       backJumps;                              //by target pc
+    uint32_t*       aborts;
+    trace_t**       traces;
+
+    bool            recording;
+    size_t          recordStart;
+    traceStep_t     steps[JIT_MAX_TRACE];
+    size_t          numSteps;
+
+    int64_t         frame[JIT_MAX_DEPTH];
+    jitStats_t      stats;
+} jit_t;
+
+//0 - ok, JitCtor() fails where there is no x86-64 code generator
+int     JitCtor         (jit_t* jit, const int64_t* code, size_t numCommands);
+int     JitDtor         (jit_t* jit);
+
+//-1 - no trace at pc, Run() goes on by itself
+int     JitRun          (jit_t* jit, int64_t* registers, int64_t* RAM, Stack_t* stk, FILE* outputFile, size_t* pc);
+
+//after every interpreted instruction: counts back jumps, records traces
+void    JitObserve      (jit_t* jit, size_t pc, size_t nextPc);
+void    PrintJitStats   (const jitStats_t* stats, FILE* file);
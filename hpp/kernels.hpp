@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+void    RamFill     (int64_t* dst, int64_t value, size_t count);
+void    RamCopy     (int64_t* dst, const int64_t* src, size_t count);
+int64_t RamCompare  (const int64_t* first, const int64_t* second, size_t count);
+
+typedef struct vectorKernels{
+    const char* name;
+
+    void    (*add)      (int64_t* dst, const int64_t* first, const int64_t* second, size_t count);
+    void    (*sub)      (int64_t* dst, const int64_t* first, const int64_t* second, size_t count);
+    void    (*mul)      (int64_t* dst, const int64_t* first, const int64_t* second, size_t count);
+    void    (*scale)    (int64_t* dst, const int64_t* src, int64_t factor, size_t count);
+
+    int64_t (*dot)      (const int64_t* first, const int64_t* second, size_t count);
+    int64_t (*sum)      (const int64_t* src, size_t count);
+    int64_t (*min)      (const int64_t* src, size_t count);
+    int64_t (*max)      (const int64_t* src, size_t count);
+} vectorKernels_t;
+
+//the fastest table the cpu runs, and the scalar one every other table gives the same results as
+const vectorKernels_t* KernelsInit();
+const vectorKernels_t* KernelsScalar();
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum tokenType{
+    TOKEN_WORD      = 0,
+    TOKEN_NEWLINE   = 1,
+    TOKEN_COLON     = 2,
+    TOKEN_LBRACKET  = 3,
+    TOKEN_RBRACKET  = 4,
+    TOKEN_PLUS      = 5,
+    TOKEN_COMMA     = 6
+};
+
+typedef struct token{
+    tokenType   type;
+    uint32_t    size;
+    const char* addr;
+} token_t;
+
+typedef struct lexer{
+    const char* buffer;
+    size_t      size;
+    size_t      pos;
+
+    token_t*    tokens;                                     //only whole lines, refilled by LexTokens()
+    size_t      numTokens;
+    size_t      sizeTokens;
+} lexer_t;
+
+//0 - ok, LexTokens() leaves numTokens == 0 at the end of input
+int     LexerCtor   (lexer_t* lexer, const char* buffer, size_t size);
+int     LexerDtor   (lexer_t* lexer);
+int     LexTokens   (lexer_t* lexer);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "processor.hpp"
+#include "kernels.hpp"
+
+//embeddable processor: a program is loaded and verified once, then any number of contexts run it
+//a program is never written after SpuProgramLoad() and an image after SpuImageCtor(), threads may share them,
+//a context belongs to one thread at a time
+
+const size_t SPU_MIN_STACK      = 64;                       //words, stacks grow on demand and keep their size on reset
+const int    SPU_IO_BLOCKED     = 1;                        //input has nothing yet, see spuIo_t
+
+enum spuStatus{
+    SPU_READY           = 0,                                //not started or stopped in the middle
+    SPU_HALTED          = 1,
+    SPU_OUT_OF_FUEL     = 2,                                //the slice is used up, the next one goes on from pc
+    SPU_BLOCKED         = 3,                                //in has no input yet, the next slice runs the in again
+    SPU_SNAPPED         = 4,                                //a template stopped at snap, see spuImage_t
+    SPU_ERR_STACK       = 5,                                //pop from an empty stack
+    SPU_ERR_RET         = 6,                                //ret without a call
+    SPU_ERR_RAM         = 7,
+    SPU_ERR_DIV         = 8,
+    SPU_ERR_PC          = 9,                                //ran past the end of the code
+    SPU_ERR_MEMORY      = 10
+};
+
+typedef struct spuProgram{
+    int64_t*    code;
+    size_t      numCommands;
+
+    int64_t*    data;                                       //RAM words a context starts with, from a container
+    size_t      numData;
+    size_t      dataAddress;
+
+    uint32_t*   blockCost;                                  //instructions from pc up to the next jump, call, ret or hlt
+} spuProgram_t;
+
+//callbacks of a context, nullptr - stdin and stdout the way main does them
+typedef struct spuIo{
+    void*       data;
+    int         (*input) (void* data, int64_t* value, bool isFloat);       //0 - ok, -1 - no input, in pushes 0,
+                                                                            //SPU_IO_BLOCKED - the slice stops at the in
+    int         (*output)(void* data, int64_t value,  bool isFloat);       //float values come as their bits
+} spuIo_t;
+
+//a program run once up to its snap: contexts made from it start right after the snap with the template's registers,
+//stacks and RAM instead of running the code before it again; the RAM is one file mapped copy-on-write into each
+//of them, so a context only has its own copy of the pages it writes
+typedef struct spuImage{
+    const spuProgram_t*     program;
+    size_t                  pc;                             //past the snap
+    int64_t                 registers[REGISTER_NUM + 1];
+
+    int64_t*                stack;
+    size_t                  sp;
+    size_t*                 calls;
+    size_t                  csp;
+
+    int                     fd;                             //memfd with the RAM
+    int64_t*                RAM;                            //the same, mapped shared and read only
+    uint64_t                instructions;                   //up to the snap, what each context saves
+} spuImage_t;
+
+typedef struct spuContext{
+    const spuProgram_t*     program;
+    const spuImage_t*       image;                          //nullptr - starts at pc 0 with zeroed RAM
+    spuIo_t                 io;
+
+    size_t                  pc;
+    int64_t                 registers[REGISTER_NUM + 1];
+
+    int64_t*                stack;
+    size_t                  sp;
+    size_t                  sizeStack;
+
+    size_t*                 calls;                          //pcs of the calls
+    size_t                  csp;
+    size_t                  sizeCalls;
+
+    int64_t*                RAM;
+    size_t                  ramLow;                         //written since the last reset
+    size_t                  ramHigh;
+    const vectorKernels_t*  kernels;
+
+    spuStatus               status;
+    size_t                  errorPc;
+    uint64_t                instructions;
+    uint64_t                fuel;                           //left in this slice, charged a block at a time
+    bool                    stopAtSnap;                     //only the template, the rest run through snap
+} spuContext_t;
+
+//0 - ok, -1 - no file, bad header or code that does not verify: unknown opcodes, bad registers, jumps out of the code,
+//thread opcodes, a task of the scheduler is the thread here; a container also fails on a bad checksum, all of them
+//are verified at once on every core, or data and zero sections out of RAM
+int         SpuProgramLoad      (spuProgram_t* program, const char* fileName);
+int         SpuProgramFromMemory(spuProgram_t* program, const void* image, size_t size);      //header_t and the code,
+                                                                                              //or a container
+int         SpuProgramDtor      (spuProgram_t* program);
+
+int         SpuContextCtor      (spuContext_t* ctx, const spuProgram_t* program, const spuIo_t* io);
+int         SpuContextReset     (spuContext_t* ctx);                                          //back to pc 0 or the image,
+                                                                                              //nothing reallocated
+int         SpuContextDtor      (spuContext_t* ctx);
+
+//the template runs with io and must reach snap without halting, failing or waiting for input, else -1
+int         SpuImageCtor        (spuImage_t* image, const spuProgram_t* program, const spuIo_t* io);
+int         SpuImageDtor        (spuImage_t* image);                                          //after the contexts made of it
+int         SpuContextFromImage (spuContext_t* ctx, const spuImage_t* image, const spuIo_t* io);
+
+//runs until hlt or an error
+spuStatus   SpuRun              (spuContext_t* ctx);
+
+//at most about fuel instructions: fuel is only charged on jumps, calls and rets, for the whole block they enter,
+//so a slice stops at the first block it can not pay for; the first block always runs, a slice never stalls
+spuStatus   SpuRunSlice         (spuContext_t* ctx, uint64_t fuel);
+const char* SpuStatusName       (spuStatus status);
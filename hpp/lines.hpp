@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "container.hpp"
+
+//debug line table, the lines section of a container: linesHeader_t, the file names each ending with 0 and
+//padded to 8 together, then one row per source line with code, by pc, as varints: the pc delta shifted left
+//with the low bit set if the file changes, then the new file index, then the line delta zigzag encoded
+//labels come from the symbols section, the one at or before a pc is the one it is in
+
+typedef struct linesHeader{
+    uint64_t    numFiles;
+    uint64_t    numRows;
+    uint64_t    sizeNames;                                  //padded
+    uint64_t    sizeRows;                                   //bytes of varints, unpadded
+} linesHeader_t;
+
+typedef struct lineRow{
+    int64_t     pc;                                         //first word of the line's code
+    uint64_t    line;                                       //from 1
+    uint64_t    file;
+} lineRow_t;
+
+//what a pc maps to, file and label point into the container
+typedef struct sourceLine{
+    const char* file;
+    uint64_t    line;
+    const char* label;                                      //nullptr - no label at or before the pc
+    size_t      labelSize;
+    int64_t     labelAddr;
+} sourceLine_t;
+
+//decoded once, looked up by binary search; nothing of it is touched while the code runs
+typedef struct lineTable{
+    int64_t*                    pcs;
+    uint64_t*                   lines;
+    uint64_t*                   files;
+    size_t                      numRows;
+
+    const char**                fileNames;
+    size_t                      numFiles;
+
+    const containerSymbol_t**   symbols;                    //by addr
+    size_t                      numSymbols;
+} lineTable_t;
+
+//rows by pc; section is calloc'ed, padded to 8 and the caller's to free
+int     EncodeLines     (const lineRow_t* rows, size_t numRows, const char* const* files, size_t numFiles,
+                         char** section, size_t* size);
+
+//0 - ok, -1 - no lines section, a bad checksum or a bad table; the symbols section is optional
+int     LineTableCtor   (lineTable_t* table, container_t* container);
+int     LineTableDtor   (lineTable_t* table);
+
+//0 - found, -1 - the pc is before the first row
+int     LineTableFind   (const lineTable_t* table, int64_t pc, sourceLine_t* line);
@@ -1,41 +1,265 @@
 #pragma once
 
-const size_t MAX_NUM_COMMANDS = 512;
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
 const size_t SIZE_COMMAND = 8;
 const size_t SIZE_ARG = 8;
 
+const int64_t OPERATOR_MASK   = 0xFF;
+const int64_t immediateMask   = 0x100;
+const int64_t registerMask    = 0x200;
+const int64_t memoryMask      = 0x400;
+
+const int     FLOAT_OUT_PRECISION = 15;
+
+const size_t  MAX_BLOCK_ARGS  = 4;
+const int64_t BLOCK_REG_ARG   = 0x100;                      // arg i of block/vector commands is a register if (BLOCK_REG_ARG << i) is set
+
+enum argShape{
+    ARGS_NONE   = 0,
+    ARGS_PUSH   = 1,
+    ARGS_POP    = 2,
+    ARGS_LABEL  = 3,
+    ARGS_BLOCK2 = 4,
+    ARGS_BLOCK3 = 5,
+    ARGS_BLOCK4 = 6
+};
+
+//      name        code    mnemonic        args
+#define INSTRUCTIONS(DEF)                                       \
+    DEF(PUSH,       1,      "push",         ARGS_PUSH)          \
+    DEF(ADD,        2,      "add",          ARGS_NONE)          \
+    DEF(SUB,        3,      "sub",          ARGS_NONE)          \
+    DEF(MUL,        4,      "mul",          ARGS_NONE)          \
+    DEF(DIV,        5,      "div",          ARGS_NONE)          \
+                                                                \
+    DEF(SQRT,       6,      "sqrt",         ARGS_NONE)          \
+    DEF(SIN,        7,      "sin",          ARGS_NONE)          \
+    DEF(COS,        8,      "cos",          ARGS_NONE)          \
+                                                                \
+    DEF(POP,        9,      "pop",          ARGS_POP)           \
+    DEF(OUT,        10,     "out",          ARGS_NONE)          \
+    DEF(IN,         11,     "in",           ARGS_NONE)          \
+    DEF(DUMP,       12,     "dump",         ARGS_NONE)          \
+    DEF(JMP,        13,     "jmp",          ARGS_LABEL)         \
+    DEF(JA,         14,     "ja",           ARGS_LABEL)         \
+    DEF(JAE,        15,     "jae",          ARGS_LABEL)         \
+    DEF(JE,         16,     "je",           ARGS_LABEL)         \
+    DEF(JNE,        17,     "jne",          ARGS_LABEL)         \
+                                                                \
+    DEF(HLT,        18,     "hlt",          ARGS_NONE)          \
+                                                                \
+    DEF(CALL,       19,     "call",         ARGS_LABEL)         \
+    DEF(RET,        20,     "ret",          ARGS_NONE)          \
+    DEF(DRAW,       21,     "draw",         ARGS_NONE)          \
+    DEF(MOD,        22,     "mod",          ARGS_NONE)          \
+                                                                \
+    DEF(LS_EQ,      23,     "less_equal",   ARGS_NONE)          \
+    DEF(MR_EQ,      24,     "more_equal",   ARGS_NONE)          \
+    DEF(EQL,        25,     "equal",        ARGS_NONE)          \
+    DEF(LS,         26,     "less",         ARGS_NONE)          \
+    DEF(MR,         27,     "more",         ARGS_NONE)          \
+                                                                \
+    DEF(FILL,       28,     "fill",         ARGS_BLOCK3)        \
+    DEF(COPY,       29,     "copy",         ARGS_BLOCK3)        \
+    DEF(CMP,        30,     "cmp",          ARGS_BLOCK3)        \
+                                                                \
+    DEF(VADD,       31,     "vadd",         ARGS_BLOCK4)        \
+    DEF(VSUB,       32,     "vsub",         ARGS_BLOCK4)        \
+    DEF(VMUL,       33,     "vmul",         ARGS_BLOCK4)        \
+    DEF(VSCALE,     34,     "vscale",       ARGS_BLOCK4)        \
+    DEF(VDOT,       35,     "vdot",         ARGS_BLOCK3)        \
+    DEF(VSUM,       36,     "vsum",         ARGS_BLOCK2)        \
+    DEF(VMIN,       37,     "vmin",         ARGS_BLOCK2)        \
+    DEF(VMAX,       38,     "vmax",         ARGS_BLOCK2)        \
+                                                                \
+    DEF(FADD,       39,     "fadd",         ARGS_NONE)          \
+    DEF(FSUB,       40,     "fsub",         ARGS_NONE)          \
+    DEF(FMUL,       41,     "fmul",         ARGS_NONE)          \
+    DEF(FDIV,       42,     "fdiv",         ARGS_NONE)          \
+    DEF(FSQRT,      43,     "fsqrt",        ARGS_NONE)          \
+    DEF(FSIN,       44,     "fsin",         ARGS_NONE)          \
+    DEF(FCOS,       45,     "fcos",         ARGS_NONE)          \
+    DEF(ITOF,       46,     "itof",         ARGS_NONE)          \
+    DEF(FTOI,       47,     "ftoi",         ARGS_NONE)          \
+    DEF(FOUT,       48,     "fout",         ARGS_NONE)          \
+    DEF(FIN,        49,     "fin",          ARGS_NONE)          \
+                                                                \
+    DEF(SPAWN,      50,     "spawn",        ARGS_LABEL)         \
+    DEF(YIELD,      51,     "yield",        ARGS_NONE)          \
+    DEF(JOIN,       52,     "join",         ARGS_NONE)          \
+    DEF(EXIT,       53,     "exit",         ARGS_NONE)          \
+                                                                \
+    DEF(PAR,        54,     "par",          ARGS_LABEL)         \
+    DEF(XADD,       55,     "xadd",         ARGS_NONE)          \
+    DEF(XCHG,       56,     "xchg",         ARGS_NONE)          \
+    DEF(CMPXCHG,    57,     "cmpxchg",      ARGS_NONE)          \
+    DEF(BARRIER,    58,     "barrier",      ARGS_NONE)          \
+                                                                \
+    DEF(SNAP,       59,     "snap",         ARGS_NONE)
+
 enum operations{
-    PUSH    = 1,
-    ADD     = 2,
-    SUB     = 3,
-    MUL     = 4,
-    DIV     = 5,
-
-    SQRT    = 6,
-    SIN     = 7,
-    COS     = 8,
-
-    POP     = 9,
-    OUT     = 10,
-    IN      = 11,
-    DUMP    = 12,
-    JMP     = 13,
-    JA      = 14,
-    JAE     = 15,
-    JE      = 16,
-    JNE     = 17,
-
-    HLT     = 18,
-
-    CALL    = 19,
-    RET     = 20,
-    DRAW    = 21,
-    MOD     = 22,
-
-    LS_EQ   = 23,
-    MR_EQ   = 24,
-    EQL     = 25,
-    LS      = 26,
-    MR      = 27,
+    #define DEF_OPERATION(name, code, mnemonic, args) name = code,
+    INSTRUCTIONS(DEF_OPERATION)
+    #undef DEF_OPERATION
+};
+
+typedef struct instruction{
+    const char* mnemonic;
+    int64_t     code;
+    argShape    args;
+} instruction_t;
 
+constexpr instruction_t INSTRUCTION_TABLE[] = {
+    #define DEF_INSTRUCTION(name, code, mnemonic, args) {mnemonic, code, args},
+    INSTRUCTIONS(DEF_INSTRUCTION)
+    #undef DEF_INSTRUCTION
 };
+
+const size_t NUM_INSTRUCTIONS = sizeof(INSTRUCTION_TABLE) / sizeof(INSTRUCTION_TABLE[0]);
+
+/*=================================================================*/
+//opcode -> table index + 1, 0 - unknown opcode
+
+typedef struct opcodeIndex{
+    uint8_t index[OPERATOR_MASK + 1];
+} opcodeIndex_t;
+
+constexpr opcodeIndex_t BuildOpcodeIndex(){
+    opcodeIndex_t opcodes = {};
+
+    for (size_t i = 0; i < NUM_INSTRUCTIONS; i++){
+        opcodes.index[(size_t)INSTRUCTION_TABLE[i].code] = (uint8_t)(i + 1);
+    }
+
+    return opcodes;
+}
+
+constexpr opcodeIndex_t OPCODE_INDEX = BuildOpcodeIndex();
+
+inline const instruction_t* FindInstructionByCode(int64_t command){
+    uint8_t index = OPCODE_INDEX.index[(size_t)(command & OPERATOR_MASK)];
+
+    return (index) ? INSTRUCTION_TABLE + index - 1 : nullptr;
+}
+
+inline size_t InstructionLength(int64_t command){
+    const instruction_t* instruction = FindInstructionByCode(command);
+    if (!instruction) return 1;
+
+    switch (instruction->args){
+        case ARGS_PUSH:
+        case ARGS_POP:      return 1 + ((command & registerMask) ? 1u : 0u) + ((command & immediateMask) ? 1u : 0u);
+        case ARGS_LABEL:    return 2;
+        case ARGS_BLOCK2:   return 1 + 2;
+        case ARGS_BLOCK3:   return 1 + 3;
+        case ARGS_BLOCK4:   return 1 + 4;
+        case ARGS_NONE:
+        default:            return 1;
+    }
+}
+
+//green threads, par and the atomics only run on main, aot and libspu turn such programs down
+inline bool IsThreadOp(int64_t command){
+    int64_t op = command & OPERATOR_MASK;
+
+    return op == SPAWN || op == YIELD || op == JOIN || op == EXIT ||
+           op == PAR   || op == XADD  || op == XCHG || op == CMPXCHG || op == BARRIER;
+}
+
+/*=================================================================*/
+//perfect hash over mnemonics, the seed is searched for at compile time
+
+const size_t MNEMONIC_HASH_SIZE = 512;
+
+typedef struct mnemonicHash{
+    bool        found;
+    uint64_t    seed;
+    uint8_t     slots[MNEMONIC_HASH_SIZE];                  //table index + 1, 0 - empty
+} mnemonicHash_t;
+
+constexpr char LowerChar(char symbol){
+    return (symbol >= 'A' && symbol <= 'Z') ? (char)(symbol - 'A' + 'a') : symbol;
+}
+
+constexpr size_t MnemonicLength(const char* mnemonic){
+    size_t size = 0;
+    while (mnemonic[size]) size++;
+
+    return size;
+}
+
+constexpr uint64_t HashMnemonic(const char* mnemonic, size_t size, uint64_t seed){
+    uint64_t hash = 0xcbf29ce484222325 ^ seed;
+
+    for (size_t i = 0; i < size; i++){
+        hash ^= (unsigned char)LowerChar(mnemonic[i]);
+        hash *= 0x100000001b3;
+    }
+
+    return hash ^ (hash >> 29);
+}
+
+constexpr mnemonicHash_t BuildMnemonicHash(){
+    for (uint64_t seed = 0; seed < 100000; seed++){
+        mnemonicHash_t table = {true, seed, {}};
+        bool collision = false;
+
+        for (size_t i = 0; i < NUM_INSTRUCTIONS && !collision; i++){
+            const char* mnemonic = INSTRUCTION_TABLE[i].mnemonic;
+            size_t slot = HashMnemonic(mnemonic, MnemonicLength(mnemonic), seed) & (MNEMONIC_HASH_SIZE - 1);
+
+            if (table.slots[slot]) collision = true;
+            else                   table.slots[slot] = (uint8_t)(i + 1);
+        }
+
+        if (!collision) return table;
+    }
+
+    return {};
+}
+
+constexpr mnemonicHash_t MNEMONIC_HASH = BuildMnemonicHash();
+
+static_assert(MNEMONIC_HASH.found, "no perfect hash seed for mnemonics, grow MNEMONIC_HASH_SIZE");
+
+//mnemonics are case-insensitive, size - length of the word, it need not be '\0'-terminated
+inline const instruction_t* FindInstruction(const char* mnemonic, size_t size){
+    size_t  slot  = HashMnemonic(mnemonic, size, MNEMONIC_HASH.seed) & (MNEMONIC_HASH_SIZE - 1);
+    uint8_t index = MNEMONIC_HASH.slots[slot];
+    if (!index) return nullptr;
+
+    const instruction_t* instruction = INSTRUCTION_TABLE + index - 1;
+
+    for (size_t i = 0; i < size; i++){
+        if (!instruction->mnemonic[i] || instruction->mnemonic[i] != LowerChar(mnemonic[i])) return nullptr;
+    }
+
+    return (instruction->mnemonic[size]) ? nullptr : instruction;
+}
+
+//float commands keep doubles in the same 64-bit stack slots and registers, bit for bit
+inline double WordToDouble(int64_t word){
+    double value = 0;
+    memcpy(&value, &word, sizeof(value));
+
+    return value;
+}
+
+inline int64_t DoubleToWord(double value){
+    int64_t word = 0;
+    memcpy(&word, &value, sizeof(word));
+
+    return word;
+}
+
+//ftoi: toward zero, nan is 0 and the rest saturates, casting them is undefined
+inline int64_t DoubleToInt(double value){
+    if (isnan(value))                   return 0;
+    if (value >= (double)INT64_MAX)     return INT64_MAX;           //2^63 once rounded
+    if (value <= (double)INT64_MIN)     return INT64_MIN;
+
+    return (int64_t)value;
+}
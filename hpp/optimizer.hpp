@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "operations.hpp"
+
+typedef struct optInstr{
+    int64_t     command;
+    int64_t     args[MAX_BLOCK_ARGS];                       //words after the command
+    size_t      length;
+
+    size_t      target;                                     //instruction index for ARGS_LABEL, numInstrs - end of code
+    bool        removed;
+    bool        leader;                                     //some jump lands here
+    bool        reachable;
+    bool        cold;                                       //never ran in the profile
+
+    uint64_t    executed;                                   //profile counts, jumps and calls only
+    uint64_t    taken;
+} optInstr_t;
+
+typedef struct optReport{
+    size_t      numFolded;
+    size_t      numIdentities;
+    size_t      numRoundTrips;
+    size_t      numThreaded;
+    size_t      numJumpsToNext;
+    size_t      numInlined;
+    size_t      numTailCalls;
+    size_t      numDead;
+
+    size_t      numBlocksMoved;
+    size_t      numInverted;
+    size_t      numJumpsAdded;
+    size_t      coldStart;                                  //address of the cold code at the end
+    size_t      coldWords;
+
+    size_t      instrsBefore;
+    size_t      instrsAfter;
+    size_t      wordsBefore;
+    size_t      wordsAfter;
+} optReport_t;
+
+typedef struct optimizer{
+    optInstr_t* instrs;
+    size_t      numInstrs;
+    size_t      sizeInstrs;
+
+    size_t      numCommands;                                //of the input code
+    size_t      numInput;                                   //instructions in the input code
+    int64_t*    addrIndex;                                  //input address -> input instruction, -1 - inside one
+    size_t*     indexMap;                                   //input instruction -> current one
+
+    bool        profiled;
+    optReport_t report;
+} optimizer_t;
+
+//0 - ok, OptimizerCtor() fails on code it can not decode or jumps into the middle of an instruction
+int     OptimizerCtor   (optimizer_t* opt, const int64_t* code, size_t numCommands);
+int     OptimizerDtor   (optimizer_t* opt);
+int     OptimizeCode    (optimizer_t* opt);
+
+//profile written by main -p, "spu-profile <numCommands>" then "<pc> <executed> <taken>" lines
+//pcs are addresses of the code given to OptimizerCtor(), -1 - the profile is of some other code
+int     LoadProfile     (optimizer_t* opt, const char* fileName);
+
+//new code is allocated, addrMap[input address] - new address or -1, numCommands + 1 entries
+int     EmitOptimized   (optimizer_t* opt, int64_t** code, size_t* numCommands, int64_t* addrMap);
+void    PrintOptReport  (const optReport_t* report, FILE* file);
@@ -1,6 +1,13 @@
 #pragma once
 
-#include "/Users/asssh/Desktop/mystack/mystack.hpp"
+#include <stdint.h>
+
+const int64_t   SIGNATURE       = 0x574f454d;
+const int64_t   VERSION         = 6;
+const int       REGISTER_NUM    = 5;                            //ax..ex, registers[0] is the scratch one
+const int64_t   DRAW_RES_X      = 200;
+const int64_t   DRAW_RES_Y      = 200;
+const int       SIZE_RAM        = DRAW_RES_X * DRAW_RES_Y;        //Draw1 canvas lives in RAM
 
 typedef struct header{
 
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "/Users/asssh/Desktop/mystack/mystack.hpp"
+#include "processor.hpp"
+
+const size_t RV_NUM_SPU_REGS    = REGISTER_NUM + 1;         //registers[0] is the scratch one push imm writes
+const size_t RV_MAX_FRAME       = 512;
+
+enum rvOp{
+    RV_POP      = 0,
+    RV_ADD      = 1,
+    RV_SUB      = 2,
+    RV_MUL      = 3,
+    RV_DIV      = 4,
+    RV_MOD      = 5,
+    RV_LS_EQ    = 6,
+    RV_MR_EQ    = 7,
+    RV_EQL      = 8,
+    RV_LS       = 9,
+    RV_MR       = 10,
+    RV_LOAD     = 11,
+    RV_STORE    = 12,
+    RV_OUT      = 13
+};
+
+enum rvExit{
+    RV_EXIT_PC  = 0,                                        //the interpreter runs the instruction at target
+    RV_EXIT_JMP = 1,
+    RV_EXIT_JA  = 2,
+    RV_EXIT_JAE = 3,
+    RV_EXIT_JE  = 4,
+    RV_EXIT_JNE = 5
+};
+
+typedef struct rvInstr{
+    uint16_t    op;
+    uint16_t    dst;
+    uint16_t    a;                                          //frame slots
+    uint16_t    b;
+} rvInstr_t;
+
+//frame: spu registers, then constants, then temporaries
+//a region ends at the first call or ret, a loop with a call in its body gets no region past it
+typedef struct region{
+    rvInstr_t*  code;
+    size_t      numCode;
+
+    int64_t*    consts;
+    size_t      numConsts;
+
+    uint16_t*   pushSlots;                                  //left on the stack, bottom first
+    size_t      numPushes;
+
+    uint16_t*   writeDst;                                   //spu registers changed by the region
+    uint16_t*   writeSrc;
+    size_t      numWrites;
+
+    rvExit      exit;
+    uint16_t    condFirst;                                  //top of the stack for the jumps
+    uint16_t    condSecond;
+    size_t      target;
+    size_t      fallPc;
+
+    size_t      numStackInstrs;
+} region_t;
+
+typedef struct regVmStats{
+    uint64_t    stackInstrs;                                //covered by regions
+    uint64_t    vmInstrs;                                   //register instructions and region exits dispatched
+    uint64_t    interpreted;                                //left to Run()
+    uint64_t    regionsRun;
+    uint64_t    regionsBuilt;
+} regVmStats_t;
+
+typedef struct regVm{
+    const int64_t*  code;
+    size_t          numCommands;
+    region_t**      regions;                                //by entry pc, lazily built
+
+    regVmStats_t    stats;
+} regVm_t;
+
+typedef struct regVmState{
+    int64_t*    registers;
+    int64_t*    RAM;
+    Stack_t*    stk;
+    FILE*       outputFile;
+} regVmState_t;
+
+//0 - ok, RegVmRun() returns -1 when Run() has to execute the instruction at pc itself
+int     RegVmCtor       (regVm_t* vm, const int64_t* code, size_t numCommands);
+int     RegVmDtor       (regVm_t* vm);
+int     RegVmRun        (regVm_t* vm, regVmState_t* state, size_t* pc);
+void    PrintRegVmStats (const regVmStats_t* stats, FILE* file);
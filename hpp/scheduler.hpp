@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "libspu.hpp"
+
+//M:N scheduler: tasks are libspu contexts, a fixed pool of workers runs them a fuel slice at a time
+//each worker has its own run queue and steals half of another one when its own is empty,
+//a task that runs out of fuel goes to the back of its worker's queue, one waiting for input is parked
+//until SchedulerFeed() gives it some, a parked task costs no worker any time
+
+const size_t   SCHED_LOCAL_QUEUE    = 256;                  //tasks, a power of two, the rest spill to the global queue
+const size_t   SCHED_TASK_INPUT     = 16;                   //values fed to a task and not read yet
+const uint64_t SCHED_DEFAULT_FUEL   = 20000;                //instructions in a slice
+const unsigned SCHED_GLOBAL_EVERY   = 61;                   //slices, a worker looks at the global queue first this often
+
+enum taskState{
+    TASK_RUNNABLE   = 0,                                    //queued or running
+    TASK_PARKED     = 1,                                    //waits for input, in no queue
+    TASK_DONE       = 2                                     //halted or failed, ctx.status says which
+};
+
+typedef struct spuTask{
+    spuContext_t        ctx;                                //the per instance state, what spu_t is to main
+    void*               data;                               //the caller's, output gets the task
+
+    pthread_mutex_t     lock;                               //state and input
+    taskState           state;
+    int64_t             input[SCHED_TASK_INPUT];
+    size_t              inputHead;
+    size_t              inputTail;
+    bool                inputClosed;                        //in pushes 0 once the input is read out
+
+    uint64_t            slices;
+    struct spuTask*     next;                               //in the global queue
+    struct scheduler*   scheduler;
+} spuTask_t;
+
+typedef struct localQueue{
+    spuTask_t*  tasks[SCHED_LOCAL_QUEUE];
+    uint64_t    head;                                       //the owner and thieves take here
+    uint64_t    tail;                                       //only the owner puts here
+} localQueue_t;
+
+typedef struct worker{
+    struct scheduler*   scheduler;
+    pthread_t           thread;
+    localQueue_t        queue;
+    uint64_t            seed;                               //who to steal from
+
+    unsigned            tick;
+    uint64_t            slices;
+    uint64_t            steals;
+} worker_t;
+
+typedef struct scheduler{
+    worker_t*       workers;
+    size_t          numWorkers;
+    uint64_t        fuel;
+
+    pthread_mutex_t lock;                                   //everything below
+    pthread_cond_t  wake;                                   //sleeping workers
+    pthread_cond_t  idle;                                   //SchedulerWait()
+    spuTask_t*      globalHead;
+    spuTask_t*      globalTail;
+    size_t          numGlobal;                              //also read without the lock, as a hint
+    size_t          numSleeping;
+    uint64_t        numLive;                                //spawned and not done
+    uint64_t        numParked;
+    bool            stop;
+} scheduler_t;
+
+//fuel 0 - SCHED_DEFAULT_FUEL; 0 - ok, -1 - no memory or no threads
+int SchedulerCtor   (scheduler_t* scheduler, size_t numWorkers, uint64_t fuel);
+int SchedulerDtor   (scheduler_t* scheduler);                                   //stops the workers, tasks stay the caller's
+
+//output is called with the task as data, nullptr - stdout; input only comes from SchedulerFeed()
+int SpuTaskCtor     (spuTask_t* task, const spuProgram_t* program, int (*output)(void* data, int64_t value, bool isFloat), void* data);
+int SpuTaskFromImage(spuTask_t* task, const spuImage_t* image, int (*output)(void* data, int64_t value, bool isFloat), void* data);
+int SpuTaskReset    (spuTask_t* task);                                          //back to pc 0 or the image with no input,
+                                                                                //to be spawned again
+int SpuTaskDtor     (spuTask_t* task);                                          //not while it is spawned and not done
+
+int SchedulerSpawn  (scheduler_t* scheduler, spuTask_t* task);
+int SchedulerFeed   (spuTask_t* task, int64_t value);                           //-1 - the input is full
+int SchedulerClose  (spuTask_t* task);                                          //no more input
+
+//until every spawned task is done or parked
+int SchedulerWait   (scheduler_t* scheduler);
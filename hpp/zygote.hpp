@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "libspu.hpp"
+
+//fork server: the program is loaded, verified and run up to its snap once, then every job is one fork of that
+//a client connects to the server's unix socket and sends one byte with its input and output fds attached,
+//the child reads in from the first and writes out to the second; the server answers with the exit code
+//as an int32_t once the child is gone
+
+const char* const ZYGOTE_DEFAULT_SOCKET = "/tmp/spu_zygote.sock";
+const int         ZYGOTE_BACKLOG        = 64;
+const int32_t     ZYGOTE_NO_CHILD       = -1;               //the answer when fork failed
+const int32_t     ZYGOTE_BAD_REQUEST    = 125;              //the child got no fds from the client
+
+//exit code of a job: 0 - halted, a spuStatus - it stopped with that one, 128 + n - killed by signal n
+
+typedef struct zygoteJob{
+    int         pid;
+    int         connection;                                 //the client, the answer goes here
+} zygoteJob_t;
+
+typedef struct zygote{
+    spuContext_t    ctx;                                    //stopped at the snap or at pc 0, what a child starts with
+    bool            snapped;
+
+    int             listener;
+    int             wake[2];                                //SIGCHLD writes here, a self pipe
+
+    zygoteJob_t*    jobs;
+    size_t          numJobs;
+    size_t          sizeJobs;
+
+    uint64_t        served;
+} zygote_t;
+
+//an old socket file at the path is removed; 0 - ok, -1 - no socket or no context
+int ZygoteCtor      (zygote_t* zygote, const spuProgram_t* program, const char* socketPath);
+int ZygoteDtor      (zygote_t* zygote, const char* socketPath);
+
+//until a signal other than SIGCHLD stops it, -1 - poll failed for another reason
+int ZygoteServe     (zygote_t* zygote);
+
+//one job on the server at socketPath, *exitCode as above; 0 - answered, -1 - no server or it went away
+int ZygoteRequest   (const char* socketPath, int input, int output, int32_t* exitCode);
@@ -0,0 +1,642 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "../hpp/aot.hpp"
+#include "../hpp/operations.hpp"
+#include "../hpp/colors.hpp"
+#include "../hpp/container.hpp"
+
+//./aot [binary] [output.c], then cc -O2 output.c -lm -o program
+//the program writes out/fout to its first argument or to stdout, in and fin read stdin like main
+
+typedef struct binary{
+    int64_t*    code;
+    size_t      numCommands;
+    int64_t*    data;
+    size_t      numData;
+    size_t      dataAddress;
+} binary_t;
+
+static int ReadBinary(const char* name, binary_t* binary);
+
+int main(int argc, const char* argv[]){
+    const char* binaryName = (argc >= 2) ? argv[1] : "./bin/output_bin.asm";
+    const char* outputName = (argc >= 3) ? argv[2] : "./bin/output.c";
+
+    binary_t binary = {};
+
+    if (ReadBinary(binaryName, &binary)){
+        printf(RED "aot: can not load \"%s\"\n" RESET, binaryName);
+
+        free(binary.code);
+        free(binary.data);
+        return 1;
+    }
+
+    aot_t aot    = {};
+    int   status = AotCtor(&aot, binary.code, binary.numCommands);
+
+    aot.data        = binary.data;
+    aot.numData     = binary.numData;
+    aot.dataAddress = binary.dataAddress;
+
+    if (status) printf(RED "aot: \"%s\" has code aot can not translate\n" RESET, binaryName);
+
+    FILE* outputFile = (!status) ? fopen(outputName, "w") : nullptr;
+
+    if (!status && !outputFile){
+        printf(RED "aot: can not open \"%s\"\n" RESET, outputName);
+        status = -1;
+    }
+
+    if (!status){
+        status = EmitC(&aot, outputFile, binaryName);
+        fclose(outputFile);
+    }
+
+    if (!status){
+        printf(BGRN "aot: \"%s\" -> \"%s\"\n" RESET, binaryName, outputName);
+        PrintAotReport(&aot.report, stdout);
+    }
+
+    AotDtor(&aot);
+    free(binary.code);
+    free(binary.data);
+
+    return (status) ? 1 : 0;
+}
+
+/*=================================================================*/
+
+//data and zero sections have to fit in RAM, the generated RAM is static, so it starts zeroed anyway
+
+static int CopySection(container_t* container, sectionType type, int64_t** words, size_t* numWords){
+    size_t      size    = 0;
+    const void* section = ContainerSection(container, type, &size);
+    if (!section) return -1;
+
+    *numWords = size / sizeof(int64_t);
+    *words    = (int64_t*)calloc(sizeof(int64_t), *numWords + 1);
+    if (!*words) return -1;
+
+    memcpy(*words, section, size);
+
+    return 0;
+}
+
+static int ReadContainer(FILE* file, binary_t* binary){
+    container_t container = {};
+    if (ContainerMap(&container, fileno(file))) return -1;
+
+    const section_t* data = ContainerFind(&container, SECTION_DATA);
+    const section_t* zero = ContainerFind(&container, SECTION_ZERO);
+    int              status = CopySection(&container, SECTION_CODE, &binary->code, &binary->numCommands);
+
+    if (!status && zero && (zero->address < 0 || zero->address > SIZE_RAM || zero->size > (uint64_t)(SIZE_RAM - zero->address))) status = -1;
+
+    if (!status && data){
+        status = CopySection(&container, SECTION_DATA, &binary->data, &binary->numData);
+
+        if (data->address < 0 || data->address > SIZE_RAM || binary->numData > (size_t)(SIZE_RAM - data->address)) status = -1;
+        binary->dataAddress = (size_t)data->address;
+    }
+
+    ContainerClose(&container);
+
+    return status;
+}
+
+static int ReadBinary(const char* name, binary_t* binary){
+    FILE* file = fopen(name, "rb");
+    if (!file) return -1;
+
+    header_t header = {};
+    int      status = 0;
+
+    if (fread(&header, sizeof(header_t), 1, file) != 1) status = -1;
+    else if (header.signature == CONTAINER_SIGNATURE){
+        status = ReadContainer(file, binary);
+        fclose(file);
+
+        return status;
+    }
+    else if (header.signature != SIGNATURE || header.version != VERSION) status = -1;
+
+    if (!status){
+        binary->numCommands = header.numCommands;
+        binary->code        = (int64_t*)calloc(sizeof(int64_t), binary->numCommands + 1);
+
+        if (!binary->code || fread(binary->code, sizeof(int64_t), binary->numCommands, file) != binary->numCommands) status = -1;
+    }
+
+    fclose(file);
+
+    return status;
+}
+
+/*=================================================================*/
+
+static inline bool IsPushPop(int64_t op){
+    return op == PUSH || op == POP;
+}
+
+static int CheckRegister(int64_t reg){
+    return (reg < 0 || reg > REGISTER_NUM) ? -1 : 0;
+}
+
+int AotCtor(aot_t* aot, const int64_t* code, size_t numCommands){
+    if (!aot || !code) return -1;
+
+    *aot = {};
+    aot->code        = code;
+    aot->numCommands = numCommands;
+    aot->isStart     = (bool*)calloc(sizeof(bool), numCommands + 1);
+    aot->isLabel     = (bool*)calloc(sizeof(bool), numCommands + 1);
+    if (!aot->isStart || !aot->isLabel) return -1;
+
+    for (size_t pc = 0; pc < numCommands; ){
+        int64_t command = code[pc];
+        int64_t op      = command & OPERATOR_MASK;
+        size_t  length  = InstructionLength(command);
+
+        if (pc + length > numCommands) return -1;
+        if (IsThreadOp(op))            return -1;                           //one C main() is one thread
+
+        aot->isStart[pc] = true;
+        aot->report.numInstrs++;
+
+        if (IsPushPop(op) && (command & registerMask) && CheckRegister(code[pc + 1])) return -1;
+
+        const instruction_t* instruction = FindInstructionByCode(command);
+
+        if (instruction && instruction->args >= ARGS_BLOCK2){
+            for (size_t i = 1; i < length; i++){
+                if ((command & (BLOCK_REG_ARG << (i - 1))) && CheckRegister(code[pc + i])) return -1;
+            }
+        }
+
+        if (op == CALL){
+            aot->usesCalls = true;
+            aot->report.numCallSites++;
+        }
+
+        if (op == RET) aot->report.numRets++;
+        if (op == HLT) aot->usesHalt = true;
+
+        pc += length;
+    }
+
+    aot->isStart[numCommands] = true;                                   //running off the end is a label too
+
+    for (size_t pc = 0; pc < numCommands; pc += InstructionLength(code[pc])){
+        const instruction_t* instruction = FindInstructionByCode(code[pc]);
+        if (!instruction || instruction->args != ARGS_LABEL) continue;
+
+        int64_t target = code[pc + 1];
+        if (target < 0 || (size_t)target > numCommands || !aot->isStart[target]) return -1;
+
+        aot->isLabel[target] = true;
+        if ((code[pc] & OPERATOR_MASK) == CALL && aot->report.numRets) aot->isLabel[pc + 2] = true;
+    }
+
+    for (size_t pc = 0; pc < numCommands; pc++) if (aot->isLabel[pc]) aot->report.numLabels++;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int AotDtor(aot_t* aot){
+    if (!aot) return -1;
+
+    free(aot->isStart);
+    free(aot->isLabel);
+    *aot = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+//a word as a C expression, INT64_MIN has no literal
+
+static void EmitWord(FILE* file, int64_t word){
+    if (word == INT64_MIN) fprintf(file, "INT64_MIN");
+    else                   fprintf(file, "INT64_C(%" PRId64 ")", word);
+}
+
+static void EmitLabel(FILE* file, const aot_t* aot, int64_t target){
+    if ((size_t)target == aot->numCommands) fprintf(file, "off_end");
+    else                                    fprintf(file, "L%" PRId64, target);
+}
+
+/*=================================================================*/
+
+static const char PRELUDE[] =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <stdint.h>\n"
+    "#include <string.h>\n"
+    "#include <math.h>\n"
+    "\n"
+    "static int64_t RAM[SIZE_RAM];\n"
+    "\n"
+    "static void Fail(const char* what, long pc){\n"
+    "    fprintf(stderr, \"spu: %s at pc %ld\\n\", what, pc);\n"
+    "    exit(1);\n"
+    "}\n"
+    "\n"
+    "static inline double  W2D(int64_t word){ double value; memcpy(&value, &word, sizeof(value)); return value; }\n"
+    "static inline int64_t D2W(double value){ int64_t word; memcpy(&word, &value, sizeof(word)); return word; }\n"
+    "static inline int64_t D2I(double value){                                     /* DoubleToInt() */\n"
+    "    if (isnan(value))                   return 0;\n"
+    "    if (value >= (double)INT64_MAX)     return INT64_MAX;\n"
+    "    if (value <= (double)INT64_MIN)     return INT64_MIN;\n"
+    "    return (int64_t)value;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t Add(int64_t a, int64_t b){ return (int64_t)((uint64_t)a + (uint64_t)b); }\n"
+    "static inline int64_t Sub(int64_t a, int64_t b){ return (int64_t)((uint64_t)a - (uint64_t)b); }\n"
+    "static inline int64_t Mul(int64_t a, int64_t b){ return (int64_t)((uint64_t)a * (uint64_t)b); }\n"
+    "\n"
+    "static inline int64_t Addr(int64_t addr, long pc){\n"
+    "    if (addr < 0 || addr >= SIZE_RAM) Fail(\"RAM address out of range\", pc);\n"
+    "    return addr;\n"
+    "}\n"
+    "\n"
+    "static inline void Block(int64_t addr, int64_t count, long pc){\n"
+    "    if (addr < 0 || count < 0 || addr > SIZE_RAM - count) Fail(\"RAM block out of range\", pc);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t Compare(const int64_t* first, const int64_t* second, int64_t count){\n"
+    "    for (int64_t i = 0; i < count; i++) if (first[i] != second[i]) return (first[i] < second[i]) ? -1 : 1;\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t Reduce(const int64_t* src, int64_t count, int op){         /* 0 - sum, 1 - min, 2 - max */\n"
+    "    if (!count) return 0;\n"
+    "    int64_t result = (op) ? src[0] : 0;\n"
+    "    for (int64_t i = (op) ? 1 : 0; i < count; i++){\n"
+    "        if      (op == 0)               result = Add(result, src[i]);\n"
+    "        else if (op == 1 && src[i] < result) result = src[i];\n"
+    "        else if (op == 2 && src[i] > result) result = src[i];\n"
+    "    }\n"
+    "    return result;\n"
+    "}\n"
+    "\n"
+    "static inline void Draw(void){\n"
+    "    printf(\"\\npicture:\\n\\n\");\n"
+    "    for (int x = 0; x < DRAW_RES_Y; x++){\n"
+    "        for (int y = 0; y < DRAW_RES_X; y++) fputs((RAM[x * DRAW_RES_Y + y] == 0) ? \"__\" : \"00\", stdout);\n"
+    "        printf(\"\\n\");\n"
+    "    }\n"
+    "    printf(\"\\n\");\n"
+    "}\n"
+    "\n"
+    "static inline void Dump(const int64_t* reg, size_t sp, long pc){                   /* no processor to dump */\n"
+    "    printf(\"dump at pc %ld, stack depth %zu\\n\", pc, sp);\n"
+    "    for (int i = 0; i < NUM_REGS; i++) printf(\"r<%d>:\\t%lld\\n\", i, (long long)reg[i]);\n"
+    "}\n"
+    "\n";
+
+static void EmitPrelude(const aot_t* aot, FILE* file, const char* binaryName){
+    fprintf(file, "/* %s, %lu words, generated by aot: cc -O2 <this file> -lm */\n\n", binaryName, aot->numCommands);
+
+    fprintf(file, "#define SIZE_RAM    %d\n",  SIZE_RAM);
+    fprintf(file, "#define DRAW_RES_X  %d\n",  (int)DRAW_RES_X);
+    fprintf(file, "#define DRAW_RES_Y  %d\n",  (int)DRAW_RES_Y);
+    fprintf(file, "#define NUM_REGS    %d\n",  REGISTER_NUM + 1);
+    fprintf(file, "#define MAX_STACK   %lu\n", AOT_MAX_STACK);
+    fprintf(file, "#define MAX_CALLS   %lu\n", AOT_MAX_CALLS);
+    fprintf(file, "\n");
+
+    fputs(PRELUDE, file);
+
+    fprintf(file, "#define PUSH(value, pc)  do{ if (sp == MAX_STACK) Fail(\"stack overflow\", pc); stack[sp++] = (value); }while(0)\n");
+    fprintf(file, "#define POP(dst, pc)     do{ if (!sp) Fail(\"stack underflow\", pc); (dst) = stack[--sp]; }while(0)\n");
+    fprintf(file, "\n");
+}
+
+//the data section as a static array, one memcpy at the start of main() instead of the code that would build it
+
+static void EmitData(const aot_t* aot, FILE* file){
+    if (!aot->numData) return;
+
+    fprintf(file, "static const int64_t DATA[%lu] = {", aot->numData);
+
+    for (size_t i = 0; i < aot->numData; i++){
+        if (!(i % 8)) fprintf(file, "\n   ");
+        fprintf(file, " ");
+        EmitWord(file, aot->data[i]);
+        fprintf(file, ",");
+    }
+
+    fprintf(file, "\n};\n\n");
+}
+
+/*=================================================================*/
+//push/pop operand as Run() decodes it: imm writes registers[0], memory is RAM[reg + imm]
+
+static void EmitAddress(const aot_t* aot, FILE* file, size_t pc){
+    int64_t command = aot->code[pc];
+    size_t  at      = pc + 1;
+
+    bool    hasReg  = command & registerMask;
+    bool    hasImm  = command & immediateMask;
+    int64_t reg     = (hasReg) ? aot->code[at++] : 0;
+    int64_t imm     = (hasImm) ? aot->code[at]   : 0;
+
+    if (!hasReg && imm >= 0 && imm < SIZE_RAM){
+        fprintf(file, "RAM[%" PRId64 "]", imm);
+        return;
+    }
+
+    if (!hasReg){
+        fprintf(file, "RAM[Addr(");
+        EmitWord(file, imm);
+        fprintf(file, ", %lu)]", pc);
+        return;
+    }
+
+    fprintf(file, "RAM[Addr(reg[%" PRId64 "]", reg);
+    if (hasImm){
+        fprintf(file, " + ");
+        EmitWord(file, imm);
+    }
+    fprintf(file, ", %lu)]", pc);
+}
+
+static void EmitPushPop(const aot_t* aot, FILE* file, size_t pc){
+    int64_t command = aot->code[pc];
+
+    bool    isPush  = (command & OPERATOR_MASK) == PUSH;
+    bool    hasReg  = command & registerMask;
+    bool    hasImm  = command & immediateMask;
+    bool    hasMem  = command & memoryMask;
+    int64_t reg     = (hasReg) ? aot->code[pc + 1] : 0;
+    int64_t imm     = (hasImm) ? aot->code[pc + 1 + hasReg] : 0;
+
+    if (hasImm){                                                        //the scratch register, dead unless dump reads it
+        fprintf(file, "reg[0] = ");
+        if (hasReg) fprintf(file, "Add(reg[%" PRId64 "], ", reg);
+        EmitWord(file, imm);
+        fprintf(file, (hasReg) ? "); " : "; ");
+    }
+
+    if (isPush) fprintf(file, "PUSH(");
+    else        fprintf(file, "POP(");
+
+    if      (hasMem)            EmitAddress(aot, file, pc);
+    else if (hasReg && !hasImm) fprintf(file, "reg[%" PRId64 "]", reg);
+    else                        fprintf(file, "reg[0]");                //imm and reg + imm go through the scratch register
+
+    fprintf(file, ", %lu);", pc);
+}
+
+/*=================================================================*/
+
+static void EmitBinary(FILE* file, size_t pc, const char* expression){
+    fprintf(file, "POP(first, %lu); POP(second, %lu); PUSH(%s, %lu);", pc, pc, expression, pc);
+}
+
+static void EmitUnary(FILE* file, size_t pc, const char* expression){
+    fprintf(file, "POP(first, %lu); PUSH(%s, %lu);", pc, expression, pc);
+}
+
+static void EmitJump(const aot_t* aot, FILE* file, size_t pc, const char* condition){
+    fprintf(file, "POP(first, %lu); POP(second, %lu); if (first %s second) goto ", pc, pc, condition);
+    EmitLabel(file, aot, aot->code[pc + 1]);
+    fprintf(file, ";");
+}
+
+static void EmitBlockArgs(const aot_t* aot, FILE* file, size_t pc, size_t numArgs){
+    int64_t command = aot->code[pc];
+
+    fprintf(file, "{ int64_t");
+
+    for (size_t i = 0; i < numArgs; i++){
+        fprintf(file, "%s a%lu = ", (i) ? "," : "", i);
+
+        if (command & (BLOCK_REG_ARG << i)) fprintf(file, "reg[%" PRId64 "]", aot->code[pc + 1 + i]);
+        else                                EmitWord(file, aot->code[pc + 1 + i]);
+    }
+
+    fprintf(file, "; ");
+}
+
+static void EmitBlock(const aot_t* aot, FILE* file, size_t pc, int64_t op){
+    switch (op){
+        case FILL:
+            EmitBlockArgs(aot, file, pc, 3);
+            fprintf(file, "Block(a0, a2, %lu); for (int64_t i = 0; i < a2; i++) RAM[a0 + i] = a1; }", pc);
+            break;
+
+        case COPY:
+            EmitBlockArgs(aot, file, pc, 3);
+            fprintf(file, "Block(a0, a2, %lu); Block(a1, a2, %lu); memmove(RAM + a0, RAM + a1, (size_t)a2 * sizeof(int64_t)); }", pc, pc);
+            break;
+
+        case CMP:
+            EmitBlockArgs(aot, file, pc, 3);
+            fprintf(file, "Block(a0, a2, %lu); Block(a1, a2, %lu); PUSH(Compare(RAM + a0, RAM + a1, a2), %lu); }", pc, pc, pc);
+            break;
+
+        case VADD:
+        case VSUB:
+        case VMUL:
+            EmitBlockArgs(aot, file, pc, 4);
+            fprintf(file, "Block(a0, a3, %lu); Block(a1, a3, %lu); Block(a2, a3, %lu); "
+                          "for (int64_t i = 0; i < a3; i++) RAM[a0 + i] = %s(RAM[a1 + i], RAM[a2 + i]); }",
+                          pc, pc, pc, (op == VADD) ? "Add" : (op == VSUB) ? "Sub" : "Mul");
+            break;
+
+        case VSCALE:
+            EmitBlockArgs(aot, file, pc, 4);
+            fprintf(file, "Block(a0, a3, %lu); Block(a1, a3, %lu); for (int64_t i = 0; i < a3; i++) RAM[a0 + i] = Mul(RAM[a1 + i], a2); }", pc, pc);
+            break;
+
+        case VDOT:
+            EmitBlockArgs(aot, file, pc, 3);
+            fprintf(file, "Block(a0, a2, %lu); Block(a1, a2, %lu); uint64_t sum = 0; "
+                          "for (int64_t i = 0; i < a2; i++) sum += (uint64_t)RAM[a0 + i] * (uint64_t)RAM[a1 + i]; PUSH((int64_t)sum, %lu); }", pc, pc, pc);
+            break;
+
+        case VSUM:
+        case VMIN:
+        case VMAX:
+        default:
+            EmitBlockArgs(aot, file, pc, 2);
+            fprintf(file, "Block(a0, a1, %lu); PUSH(Reduce(RAM + a0, a1, %d), %lu); }", pc, (op == VSUM) ? 0 : (op == VMIN) ? 1 : 2, pc);
+            break;
+    }
+}
+
+/*=================================================================*/
+
+static void EmitInstruction(const aot_t* aot, FILE* file, size_t pc){
+    int64_t command = aot->code[pc];
+    int64_t op      = command & OPERATOR_MASK;
+
+    switch (op){
+        case PUSH:
+        case POP:   EmitPushPop(aot, file, pc);                                         break;
+
+        case ADD:   EmitBinary(file, pc, "Add(first, second)");                         break;
+        case SUB:   EmitBinary(file, pc, "Sub(first, second)");                         break;
+        case MUL:   EmitBinary(file, pc, "Mul(first, second)");                         break;
+
+        case DIV:
+        case MOD:
+            fprintf(file, "POP(first, %lu); POP(second, %lu); if (!second) Fail(\"division by zero\", %lu); PUSH(first %c second, %lu);",
+                          pc, pc, pc, (op == DIV) ? '/' : '%', pc);
+            break;
+
+        case SQRT:  EmitUnary(file, pc, "(first >= 0) ? (int64_t)sqrt((double)first) : 0");  break;
+        case SIN:   EmitUnary(file, pc, "(int64_t)sin((double)first)");                break;
+        case COS:   EmitUnary(file, pc, "(int64_t)cos((double)first)");                break;
+
+        case LS_EQ: EmitBinary(file, pc, "first <= second");                            break;
+        case MR_EQ: EmitBinary(file, pc, "first >= second");                            break;
+        case EQL:   EmitBinary(file, pc, "first == second");                            break;
+        case LS:    EmitBinary(file, pc, "first <  second");                            break;
+        case MR:    EmitBinary(file, pc, "first >  second");                            break;
+
+        case OUT:   fprintf(file, "POP(first, %lu); fprintf(out, \"%%lld\\n\", (long long)first);", pc);         break;
+        case FOUT:  fprintf(file, "POP(first, %lu); fprintf(out, \"%%.*lg\\n\", %d, W2D(first));", pc, FLOAT_OUT_PRECISION);  break;
+
+        case IN:
+            fprintf(file, "printf(\"\\033[0;36menter num:\\n\\033[0m\"); input = 0; if (scanf(\"%%lld\", &input) != 1) input = 0; PUSH((int64_t)input, %lu);", pc);
+            break;
+
+        case FIN:
+            fprintf(file, "printf(\"\\033[0;36menter num:\\n\\033[0m\"); finput = 0; if (scanf(\"%%lf\", &finput) != 1) finput = 0; PUSH(D2W(finput), %lu);", pc);
+            break;
+
+        case DUMP:  fprintf(file, "Dump(reg, sp, %lu);", pc);                             break;
+        case DRAW:  fprintf(file, "Draw();");                                            break;
+        case SNAP:                                                                         break;
+        case HLT:   fprintf(file, "goto halt;");                                         break;
+
+        case JMP:
+            fprintf(file, "goto ");
+            EmitLabel(file, aot, aot->code[pc + 1]);
+            fprintf(file, ";");
+            break;
+
+        case JA:    EmitJump(aot, file, pc, ">");                                       break;
+        case JAE:   EmitJump(aot, file, pc, ">=");                                      break;
+        case JE:    EmitJump(aot, file, pc, "==");                                      break;
+        case JNE:   EmitJump(aot, file, pc, "!=");                                      break;
+
+        case CALL:
+            fprintf(file, "if (csp == MAX_CALLS) Fail(\"call stack overflow\", %lu); calls[csp++] = %lu; goto ", pc, pc);
+            EmitLabel(file, aot, aot->code[pc + 1]);
+            fprintf(file, ";");
+            break;
+
+        case RET:   fprintf(file, "retPc = %lu; goto do_ret;", pc);                    break;
+
+        case FILL:  case COPY:  case CMP:
+        case VADD:  case VSUB:  case VMUL:  case VSCALE:
+        case VDOT:  case VSUM:  case VMIN:  case VMAX:
+            EmitBlock(aot, file, pc, op);
+            break;
+
+        case FADD:  EmitBinary(file, pc, "D2W(W2D(first) + W2D(second))");              break;
+        case FSUB:  EmitBinary(file, pc, "D2W(W2D(first) - W2D(second))");              break;
+        case FMUL:  EmitBinary(file, pc, "D2W(W2D(first) * W2D(second))");              break;
+        case FDIV:  EmitBinary(file, pc, "D2W(W2D(first) / W2D(second))");              break;
+        case FSQRT: EmitUnary(file, pc, "D2W(sqrt(W2D(first)))");                        break;
+        case FSIN:  EmitUnary(file, pc, "D2W(sin(W2D(first)))");                         break;
+        case FCOS:  EmitUnary(file, pc, "D2W(cos(W2D(first)))");                         break;
+        case ITOF:  EmitUnary(file, pc, "D2W((double)first)");                           break;
+        case FTOI:  EmitUnary(file, pc, "D2I(W2D(first))");                             break;
+
+        default:    fprintf(file, "printf(\"\\033[0;31m\\nERROR:pc=%lu\\n\\033[0m\");", pc); break;
+    }
+}
+
+/*=================================================================*/
+
+int EmitC(aot_t* aot, FILE* file, const char* binaryName){
+    if (!aot || !file) return -1;
+
+    EmitPrelude(aot, file, binaryName);
+    EmitData(aot, file);
+
+    fprintf(file, "int main(int argc, char* argv[]){\n");
+    fprintf(file, "    FILE*     out            = stdout;\n");
+    fprintf(file, "    int64_t   reg[NUM_REGS]  = {0};\n");
+    fprintf(file, "    int64_t   stack[MAX_STACK];\n");
+    fprintf(file, "    size_t    sp             = 0;\n");
+    fprintf(file, "    int64_t   first = 0, second = 0;\n");
+    fprintf(file, "    long long input  = 0;\n");
+    fprintf(file, "    double    finput = 0;\n");
+
+    if (aot->usesCalls){
+        fprintf(file, "    long      calls[MAX_CALLS];\n");
+        fprintf(file, "    size_t    csp            = 0;\n");
+    }
+
+    if (aot->report.numRets) fprintf(file, "    long      retPc          = 0;\n");
+
+    fprintf(file, "\n");
+    fprintf(file, "    (void)first; (void)second; (void)input; (void)finput; (void)reg;\n");
+    fprintf(file, "    if (argc > 1 && !(out = fopen(argv[1], \"w\"))){\n");
+    fprintf(file, "        perror(argv[1]);\n");
+    fprintf(file, "        return 1;\n");
+    fprintf(file, "    }\n\n");
+
+    if (aot->numData) fprintf(file, "    memcpy(RAM + %lu, DATA, sizeof(DATA));\n\n", aot->dataAddress);
+
+    for (size_t pc = 0; pc < aot->numCommands; pc += InstructionLength(aot->code[pc])){
+        const instruction_t* instruction = FindInstructionByCode(aot->code[pc]);
+
+        if (aot->isLabel[pc]) fprintf(file, "L%lu:\n", pc);
+
+        fprintf(file, "    /* %4lu %-10s */ ", pc, (instruction) ? instruction->mnemonic : "???");
+        EmitInstruction(aot, file, pc);
+        fprintf(file, "\n");
+    }
+
+    if (aot->isLabel[aot->numCommands]) fprintf(file, "\noff_end:\n");
+    fprintf(file, "    Fail(\"ran past the end of the code\", %lu);\n", aot->numCommands);
+
+    if (aot->report.numRets){
+        fprintf(file, "\ndo_ret:\n");
+
+        if (aot->usesCalls){
+            fprintf(file, "    if (!csp) Fail(\"ret without a call\", retPc);\n");
+            fprintf(file, "    switch (calls[--csp]){\n");
+
+            for (size_t pc = 0; pc < aot->numCommands; pc += InstructionLength(aot->code[pc])){
+                if ((aot->code[pc] & OPERATOR_MASK) != CALL) continue;
+
+                fprintf(file, "        case %lu: goto ", pc);
+                EmitLabel(file, aot, (int64_t)(pc + 2));
+                fprintf(file, ";\n");
+            }
+
+            fprintf(file, "        default: break;\n");
+            fprintf(file, "    }\n");
+        }
+
+        fprintf(file, "    Fail(\"ret without a call\", retPc);\n");
+    }
+
+    if (aot->usesHalt) fprintf(file, "\nhalt:\n");
+    fprintf(file, "    if (out != stdout) fclose(out);\n");
+    fprintf(file, "    return 0;\n");
+    fprintf(file, "}\n");
+
+    return (ferror(file)) ? -1 : 0;
+}
+
+/*=================================================================*/
+
+void PrintAotReport(const aotReport_t* report, FILE* file){
+    if (!report || !file) return;
+
+    fprintf(file, "aot: %lu instructions, %lu labels, %lu call sites, %lu rets\n",
+                  report->numInstrs, report->numLabels, report->numCallSites, report->numRets);
+}
@@ -3,34 +3,84 @@
 #include <string.h>
 #include <ctype.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "../hpp/colors.hpp"
 #include "../hpp/compiler.hpp"
 #include "../hpp/operations.hpp"
+#include "../hpp/lexer.hpp"
+#include "../hpp/optimizer.hpp"
+#include "../hpp/container.hpp"
+#include "../hpp/lines.hpp"
 
 #define MEOW fprintf(stderr, "\e[0;31m" "\nmeow\n" "\e[0m");
 
-const int64_t SIGNATURE = 0x574F454D;
-const int64_t VERSION = 5;
+const int64_t VERSION = 8;                              //of the cache and object files
+
+const size_t MIN_CODE_SIZE   = 512;
+const size_t MIN_READ_SIZE   = 1 << 16;
+const size_t MAX_NUMLEN      = 64;
+const size_t MIN_LABELS = 16;
+const size_t MIN_FIXUP  = 16;
+const size_t MIN_DATA   = 64;
+const size_t MIN_MARKS  = 64;
+const size_t NAME_BLOCK_SIZE = 4096;
+const size_t LISTING_BUFFER_SIZE = 4096;
+const size_t MIN_CHUNK_SIZE  = 1 << 20;                 //smaller inputs are not worth a thread
+const size_t MAX_THREADS     = 64;
+const size_t MIN_REGION_SIZE = 4096;                    //cached regions start at a label after this many bytes
+const size_t MIN_CHUNKS      = 16;
+const int64_t RELOCATION     = -1;
+const int64_t MAX_DATA_ADDRESS = 1 << 24;              //words, the loaders check against their own RAM
+
+const int64_t CACHE_SIGNATURE  = 0x48434143574F454D;
+const int64_t OBJECT_SIGNATURE = 0x4A424F574F454D;
+
+static void     Compile     (fileNames_t*   fileNames, compileOptions_t* options);
+static void     Link        (fileNames_t*   fileNames, const char** objectNames, size_t numObjects, compileOptions_t* options);
+static int64_t  FindLabel   (commands_t*    codeStruct, string_t name);
+static int64_t  AddLabel    (commands_t*    codeStruct, string_t name);
+static errors   AddFixup    (commands_t*    codeStruct, int64_t codeAdr, int64_t labelNum);
+static errors   ReadInput   (commands_t*    codeStruct);
+static void*    LoadUnit    (chunk_t*       chunk);
 
-const size_t MAX_CMDLEN = 128;
-const size_t MAX_ARGLEN = 32;
-const size_t MAX_LINES  = 512;
-const size_t MAX_LABELS = 16;
-const size_t MAX_FIXUP  = 16;
+int main(int argc, const char* argv[]){
+    fileNames_t      fileNames = {};
+    compileOptions_t options   = {};
+
+    int numArgs = 1;                                                                    //flags go anywhere
+    for (int i = 1; i < argc; i++){
+        if      (!strcmp(argv[i], "-O"))    options.optimize = true;
+        else if (!strcmp(argv[i], "-R"))    options.optimize = options.optReport = true;
+        else if (!strcmp(argv[i], "-P") && i + 1 < argc){
+            options.optimize    = true;
+            options.profileName = argv[++i];
+        }
+        else                                argv[numArgs++] = argv[i];
+    }
+    argc = numArgs;
 
-static void     Compile     (fileNames_t*   fileNames);
-static errors   FillLabels  (commands_t*    codeStruct);
-static errors   FillFixups  (commands_t*    codeStruct);
-static int      FindLabel   (commands_t*    codeStruct, char* arg);
-static errors   SplitCode   (commands_t*    codeStruct);
+    if (argc >= 3 && !strcmp(argv[1], "-l")){                                           //-l listing a.o b.o ...
+        fileNames.outputFileName = argv[2];
+        Link(&fileNames, argv + 3, (size_t)(argc - 3), &options);
 
-int main(int argc, const char* argv[]){
-    fileNames_t fileNames= {};
+        return 0;
+    }
+
+    if (argc >= 4 && !strcmp(argv[1], "-c")){                                           //-c source object
+        fileNames.objectFileName = argv[3];
+        argv++;
+        argc--;
+    }
+
+    fileNames.inputFileName  = (argc >= 3) ? argv[1]  : "./bin/user_input.txt";
+    fileNames.outputFileName = (argc >= 3) ? argv[2]  : "./bin/user_output.asm";
 
-    fileNames.inputFileName  = (argc == 3) ? argv[1]  : "./bin/user_input.txt";
-    fileNames.outputFileName = (argc == 3) ? argv[2]  : "./bin/user_output.asm";
+    options.numThreads = (argc >= 4) ? strtoul(argv[3], nullptr, 10) : 0;
+    options.cacheName  = (argc >= 5) ? argv[4] : nullptr;
 
-    Compile(&fileNames);
+    Compile(&fileNames, &options);
 
     return 0;
 }
@@ -60,6 +110,8 @@ static errors PrintFilesData(commands_t* codeStruct){
 
 /*=======================================================================*/
 
+static errors UnitCtor(commands_t* codeStruct);
+
 static errors CommandsCtor(commands_t* codeStruct, const char* name){
     if (!codeStruct) return ERR_NULLPTR;
 
@@ -68,13 +120,21 @@ static errors CommandsCtor(commands_t* codeStruct, const char* name){
     const char* defaultFileNameOut      = "./bin/user_output.asm";
     const char* defaultFileNameOutBin   = "./bin/output_bin.asm";
 
-    FILE* inputFile  = fopen(codeStruct->fileNames->inputFileName, "r");
-    if (inputFile == nullptr)   inputFile = fopen(defaultFileNameIn, "r");
+    FILE* inputFile     = nullptr;                          //the linker has no source
+    FILE* outputFile    = nullptr;
+    FILE* outputBinFile = nullptr;                          //-c leaves the binary alone
+
+    if (codeStruct->fileNames->inputFileName){
+        inputFile = fopen(codeStruct->fileNames->inputFileName, "r");
+        if (inputFile == nullptr)   inputFile = fopen(defaultFileNameIn, "r");
+    }
 
-    FILE* outputFile = fopen(codeStruct->fileNames->outputFileName, "w");
-    if (outputFile == nullptr)  outputFile = fopen(defaultFileNameOut, "w");
+    if (!codeStruct->fileNames->objectFileName){
+        outputFile = fopen(codeStruct->fileNames->outputFileName, "w");
+        if (outputFile == nullptr)  outputFile = fopen(defaultFileNameOut, "w");
 
-    FILE* outputBinFile = fopen(defaultFileNameOutBin, "wb");
+        outputBinFile = fopen(defaultFileNameOutBin, "wb");
+    }
 
     FILE* logFile = fopen(codeStruct->fileNames->logFileName, "w");
     if (logFile == nullptr) logFile = stdout;
@@ -87,54 +147,131 @@ static errors CommandsCtor(commands_t* codeStruct, const char* name){
     codeStruct->logFile         = logFile;
     //files
 
-    //HEADER:
-    codeStruct->header.signature    = SIGNATURE;
-    codeStruct->header.version      = VERSION;
-
+    codeStruct->name = name;
 
-    struct stat st;                                                   //change!
-    stat(defaultFileNameIn, &st);
-    size_t inputFileSize = st.st_size;
+    if (codeStruct->fileNames->inputFileName && (!inputFile || ReadInput(codeStruct))){
+        printf(BRED "\nERROR: can not read %s\n\n" RESET, codeStruct->fileNames->inputFileName);
+        return ERR;
+    }
 
-    codeStruct->fileBuffer      = calloc(1, inputFileSize);
-    codeStruct->sizeFileBuffer  = inputFileSize;
-    codeStruct->splittedInput   = (string_t*)calloc(sizeof(string_t), MAX_LINES + 1);
-    codeStruct->numSplitted    = 0;
+    return UnitCtor(codeStruct);
+}
 
-    fread(codeStruct->fileBuffer, 1, codeStruct->sizeFileBuffer, inputFile);
-    SplitCode(codeStruct);
+/*=======================================================================*/
 
-    codeStruct->name = name;
-    codeStruct->codePointer     = calloc(SIZE_ARG, MAX_NUM_COMMANDS);     //exception nlptr = calloc
-    codeStruct->sizeAllocated   = MAX_NUM_COMMANDS * SIZE_ARG;
+static errors UnitCtor(commands_t* codeStruct){
+    codeStruct->pc              = 0;
+    codeStruct->codePointer     = calloc(SIZE_ARG, MIN_CODE_SIZE);
+    codeStruct->sizeAllocated   = MIN_CODE_SIZE * SIZE_ARG;
 
     codeStruct->numElemsFixup   = 0;
-    codeStruct->fixupPointer    = (fixup_t*)calloc(sizeof(fixup_t), MAX_FIXUP);
-    FillFixups(codeStruct);
+    codeStruct->fixupPointer    = (fixup_t*)calloc(sizeof(fixup_t), MIN_FIXUP);
+    codeStruct->sizeFixup       = MIN_FIXUP;
 
     codeStruct->numElemsLabels  = 0;
-    codeStruct->labelsPointer   = (label_t*)calloc(sizeof(label_t), MAX_LABELS);
-    FillLabels(codeStruct);
+    codeStruct->labelsPointer   = (label_t*)calloc(sizeof(label_t), MIN_LABELS);
+    codeStruct->sizeLabels      = MIN_LABELS;
+
+    codeStruct->labelsHash      = (size_t*)calloc(sizeof(size_t), MIN_LABELS * 2);
+    codeStruct->sizeLabelsHash  = MIN_LABELS * 2;
+
+    if (!codeStruct->codePointer || !codeStruct->fixupPointer || !codeStruct->labelsPointer || !codeStruct->labelsHash){
+        return ERR_NULLPTR;
+    }
 
     return OK;
 }
 
 /*=======================================================================*/
 
-static errors CommandsDtor(commands_t* codeStruct){                                         //free pointers
-    if (!codeStruct->codePointer) return ERR_NULLPTR;
+static errors ReadInput(commands_t* codeStruct){
+    int fd = fileno(codeStruct->inputFile);
+
+    struct stat st = {};
+    if (fstat(fd, &st)) return ERR;
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0){
+        void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapped != MAP_FAILED){
+            madvise(mapped, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+            codeStruct->fileBuffer      = (const char*)mapped;
+            codeStruct->sizeFileBuffer  = (size_t)st.st_size;
+            codeStruct->isMapped        = true;
+
+            return OK;
+        }
+    }
+
+    //pipes and other unmappable inputs are read in chunks
+    size_t size   = 0;
+    size_t alloc  = MIN_READ_SIZE;
+    char*  buffer = (char*)calloc(1, alloc);
+    if (!buffer) return ERR_NULLPTR;
+
+    size_t numRead = 0;
+    while ((numRead = fread(buffer + size, 1, alloc - size, codeStruct->inputFile)) > 0){
+        size += numRead;
+
+        if (size == alloc){
+            char* newBuffer = (char*)realloc(buffer, alloc * 2);
+            if (!newBuffer){
+                free(buffer);
+                return ERR_NULLPTR;
+            }
 
+            buffer = newBuffer;
+            alloc *= 2;
+        }
+    }
+
+    codeStruct->fileBuffer      = buffer;
+    codeStruct->sizeFileBuffer  = size;
+    codeStruct->isMapped        = false;
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static void UnitDtor(commands_t* codeStruct){
     free(codeStruct->codePointer);
     free(codeStruct->labelsPointer);
+    free(codeStruct->labelsHash);
     free(codeStruct->fixupPointer);
-    free(codeStruct->splittedInput);
+    free(codeStruct->dataPointer);
+    free(codeStruct->linesPointer);
+    free(codeStruct->lineFiles);
+
+    for (size_t i = 0; i < codeStruct->numNameBlocks; i++) free(codeStruct->nameBlocks[i]);
+    free(codeStruct->nameBlocks);
+
+    codeStruct->codePointer   = nullptr;
+    codeStruct->dataPointer   = nullptr;
+    codeStruct->linesPointer  = nullptr;
+    codeStruct->lineFiles     = nullptr;
+    codeStruct->nameBlocks    = nullptr;
+    codeStruct->numNameBlocks = 0;
+}
+
+/*=======================================================================*/
+
+static errors CommandsDtor(commands_t* codeStruct){                                         //free pointers
+    if (!codeStruct->codePointer) return ERR_NULLPTR;
+
+    UnitDtor(codeStruct);
 
-    if (!codeStruct->logFile && codeStruct->logFile != stdout) fclose(codeStruct->logFile);
-    if (!codeStruct->inputFile)                                fclose(codeStruct->inputFile);
-    if (!codeStruct->outputFile)                               fclose(codeStruct->outputFile);
+    if (codeStruct->isMapped) munmap((void*)codeStruct->fileBuffer, codeStruct->sizeFileBuffer);
+    else                      free((void*)codeStruct->fileBuffer);
 
     fprintf(codeStruct->logFile, CYN "%s destoyed\n"  RESET, codeStruct->name);
 
+    if (codeStruct->logFile && codeStruct->logFile != stdout)   fclose(codeStruct->logFile);
+    if (codeStruct->inputFile)                                  fclose(codeStruct->inputFile);
+    if (codeStruct->outputFile)                                 fclose(codeStruct->outputFile);
+    if (codeStruct->outputBinFile)                              fclose(codeStruct->outputBinFile);
+
     return OK;
 }
 
@@ -158,7 +295,7 @@ static errors CommandsDump(commands_t* codeStruct){
     if (logFile == stdout) printf(CYN);
     fprintf(logFile, "Struct pointer:                       \t%p\n",  codeStruct);
     fprintf(logFile, "Code pointer:                         \t%p\n",  codeStruct->codePointer);
-    fprintf(logFile, "Number of commands:                   \t%lu\n", MAX_NUM_COMMANDS);
+    fprintf(logFile, "Number of commands:                   \t%lu\n", codeStruct->pc);
     fprintf(logFile, "Size of command:                      \t%lu\n", SIZE_ARG);
     fprintf(logFile, "Allocated memory for commands(bytes): \t%lu\n", codeStruct->sizeAllocated);
     if (logFile == stdout) printf(RESET);
@@ -176,11 +313,12 @@ static errors CommandsDump(commands_t* codeStruct){
     if (logFile == stdout) printf(BLU);
     fprintf(logFile, "Label data.\n");
     fprintf(logFile, "Label pointer:\t\t%p\n",  codeStruct->labelsPointer);
-    fprintf(logFile, "Size of labels:\t\t%lu\n",  MAX_LABELS);
+    fprintf(logFile, "Size of labels:\t\t%lu\n",  codeStruct->sizeLabels);
+    fprintf(logFile, "Number of labels:\t%lu\n",  codeStruct->numElemsLabels);
 
     label_t* labelsPtr = codeStruct->labelsPointer;
-    for (int i = 0; i < MAX_LABELS; i++){
-        fprintf(logFile, "[label:%d], name:<%s>, addr:%lld\n", i, (labelsPtr + i)->name, (labelsPtr + i)->addr);
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        fprintf(logFile, "[label:%lu], name:<%s>, addr:%lld\n", i, (labelsPtr + i)->name, (labelsPtr + i)->addr);
     }
     if (logFile == stdout) printf(RESET);
 
@@ -192,27 +330,17 @@ static errors CommandsDump(commands_t* codeStruct){
     if (logFile == stdout) printf(CYN);
     fprintf(logFile, "Fixup data.\n");
     fprintf(logFile, "Fixup pointer:\t\t%p\n",          codeStruct->fixupPointer);
-    fprintf(logFile, "Size of fixups:\t\t%lu\n",          MAX_FIXUP);
+    fprintf(logFile, "Size of fixups:\t\t%lu\n",          codeStruct->sizeFixup);
     fprintf(logFile, "Number of fixups:\t%lu\n",        codeStruct->numElemsFixup);
 
     fixup_t* fixupsPtr = codeStruct->fixupPointer;
-    for (int i = 0; i < MAX_FIXUP; i++){
-        fprintf(logFile, "[fixup:%d], label name:<%lld>, code addr:%lld\n",
-                                 i, (fixupsPtr + i)->labelNum, (fixupsPtr + i)->codeAdr);
+    for (size_t i = 0; i < codeStruct->numElemsFixup; i++){
+        fprintf(logFile, "[fixup:%lu], label name:<%s>, code addr:%lld\n",
+                                 i, (codeStruct->labelsPointer + (fixupsPtr + i)->labelNum)->name, (fixupsPtr + i)->codeAdr);
     }
     if (logFile == stdout) printf(RESET);
 
 
-    fprintf(logFile, "\n");
-
-    //SPLITTED:
-    if (logFile == stdout) printf(BLU);
-    fprintf(logFile, "Splitted code:\n");
-    for (int i = 0; i < codeStruct->numSplitted; i++){
-        printf("i:%d \t- \t%p \t size:%lu\n", i + 1, (codeStruct->splittedInput)[i].addr, (codeStruct->splittedInput)[i].size);
-    }
-    if (logFile == stdout) printf(RESET);
-
     fprintf(logFile, "\n");
 
     //COMMANDS:
@@ -222,7 +350,7 @@ static errors CommandsDump(commands_t* codeStruct){
     fprintf(logFile, "Commands:\n");
     if (logFile == stdout) printf(RESET);
 
-    for (size_t pc = 0; pc < MAX_NUM_COMMANDS; pc++){
+    for (size_t pc = 0; pc < codeStruct->pc; pc++){
             fprintf(codeStruct->logFile, "pc<%lu>\t:\t%lld\n", pc, *(cmdPtr + pc));
     }
     fprintf(logFile, "=================================================\n");
@@ -238,8 +366,8 @@ static errors PrintSignature(commands_t* codeStruct){
     FILE* outputFile = codeStruct->outputFile;
 
     fprintf(outputFile, "LISTING:\n");
-    fprintf(outputFile, "signature: %llx\n", SIGNATURE);
-    fprintf(outputFile, "version: v.%lld\n", VERSION);
+    fprintf(outputFile, "signature: %llx\n", CONTAINER_SIGNATURE);
+    fprintf(outputFile, "version: v.%lld\n", CONTAINER_VERSION);
     fprintf(outputFile, "num commands:%lu\n", codeStruct->pc);
 
     return OK;
@@ -247,568 +375,1637 @@ static errors PrintSignature(commands_t* codeStruct){
 
 /*=======================================================================*/
 
+static size_t FormatWord(char* text, int64_t word){
+    char     digits[MAX_NUMLEN] = "";
+    size_t   numDigits = 0;
+    uint64_t number    = (word < 0) ? 0 - (uint64_t)word : (uint64_t)word;
+
+    do{
+        digits[numDigits++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number);
+
+    size_t len = 0;
+    if (word < 0) text[len++] = '-';
+
+    while (numDigits) text[len++] = digits[--numDigits];
+    text[len++] = '\n';
+
+    return len;
+}
+
+/*=======================================================================*/
+
+static size_t Align8(size_t size){
+    return (size + 7) & ~(size_t)7;
+}
+
+/*=======================================================================*/
+
 static errors OutputCodeListing(commands_t* codeStruct){
     if (!codeStruct || !codeStruct->codePointer) return ERR_NULLPTR;
                                                                            //add file verifycator
     int64_t* cmdPtr = (int64_t*)(codeStruct->codePointer);                 // change type
 
-    for (size_t pc = 0; pc < MAX_NUM_COMMANDS; pc++){
-        fprintf(codeStruct->outputFile, "%lld\n", *(cmdPtr + pc));
+    char   text[LISTING_BUFFER_SIZE] = "";                                 //fprintf per word dominates warm rebuilds
+    size_t len = 0;
+
+    for (size_t pc = 0; pc < codeStruct->pc; pc++){
+        if (len + MAX_NUMLEN > LISTING_BUFFER_SIZE){
+            fwrite(text, 1, len, codeStruct->outputFile);
+            len = 0;
+        }
+
+        len += FormatWord(text + len, *(cmdPtr + pc));
     }
 
+    fwrite(text, 1, len, codeStruct->outputFile);
+
     return OK;
 }
 
 /*=======================================================================*/
 
-static errors OutputCodeBin(commands_t* codeStruct){
-    if (!codeStruct || !codeStruct->codePointer) return ERR_NULLPTR;
-                                      //add file verifycator
-    codeStruct->header.numCommands = codeStruct->pc;
+//the words data runs set, or zero runs clear, from the lowest to past the highest
 
-    fwrite(&codeStruct->header      , sizeof(header_t), 1                             , codeStruct->outputBinFile);
-    fwrite(codeStruct->codePointer  , sizeof(int64_t) , codeStruct->header.numCommands, codeStruct->outputBinFile);
+static void DataBounds(commands_t* codeStruct, bool zero, int64_t* low, int64_t* high){
+    *low  = MAX_DATA_ADDRESS;
+    *high = 0;
 
-    return OK;
+    for (size_t i = 0; i < codeStruct->numData; ){
+        const int64_t* run   = codeStruct->dataPointer + i;
+        int64_t        count = run[1];
+
+        i += 2 + (size_t)((count > 0) ? count : 0);
+        if ((count < 0) != zero) continue;
+
+        int64_t end = run[0] + ((count < 0) ? -count : count);
+
+        if (run[0] < *low)  *low  = run[0];
+        if (end > *high)    *high = end;
+    }
+
+    if (*low > *high) *low = *high = 0;
 }
 
-/*=======================================================================*/
-                                                                                //capital letters
-int FindRegisterName(char* arg){
+//later runs go over earlier ones, a zero run clears what it covers here too, the loader clears
+//the zero section before it copies the data section over it
+
+static int64_t* BuildData(commands_t* codeStruct, int64_t low, int64_t high){
+    int64_t* data = (int64_t*)calloc(SIZE_ARG, (size_t)(high - low) + 1);
+    if (!data) return nullptr;
+
+    for (size_t i = 0; i < codeStruct->numData; ){
+        const int64_t* run   = codeStruct->dataPointer + i;
+        int64_t        count = run[1];
+
+        if (count > 0){
+            memcpy(data + run[0] - low, run + 2, (size_t)count * SIZE_ARG);
+            i += 2 + (size_t)count;
+            continue;
+        }
+
+        int64_t start = (run[0] > low)          ? run[0]          : low;
+        int64_t end   = (run[0] - count < high) ? run[0] - count  : high;
 
-    return arg[0] - 'a' + 1;
+        if (start < end) memset(data + start - low, 0, (size_t)(end - start) * SIZE_ARG);
+        i += 2;
+    }
 
+    return data;
 }
 
-/*=======================================================================*/
+//containerSymbol_t records, names padded to 8 bytes
 
-int CheckMark(commands_t* codeStruct, char* arg, checkMarkParams param){   //rename
+static char* BuildSymbols(commands_t* codeStruct, size_t* size){
+    *size = 0;
 
-    char* ptr = strchr(arg, ':');
-    int hasMark = (ptr)? 1:0;
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        const label_t* label = codeStruct->labelsPointer + i;
+        if (label->addr >= 0) *size += sizeof(containerSymbol_t) + Align8(label->nameSize);
+    }
 
-    if (param == FROM_CODE){
-        if (hasMark){
-            if (ptr) *ptr = '\0';
-            int labelNum = FindLabel(codeStruct, arg);
+    char*  symbols = (char*)calloc(*size + 1, 1);
+    size_t offset  = 0;
+    if (!symbols) return nullptr;
 
-            if (labelNum == -1){
-                strcpy((codeStruct->labelsPointer + codeStruct->numElemsLabels)->name, arg);
-                       (codeStruct->labelsPointer + codeStruct->numElemsLabels)->addr  = codeStruct->pc;
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        const label_t* label = codeStruct->labelsPointer + i;
+        if (label->addr < 0) continue;
 
-                codeStruct->numElemsLabels++;
+        containerSymbol_t symbol = {label->addr, label->nameSize};
 
-                return hasMark;
-            }
+        memcpy(symbols + offset, &symbol, sizeof(symbol));
+        memcpy(symbols + offset + sizeof(symbol), label->name, label->nameSize);
+        offset += sizeof(symbol) + Align8(label->nameSize);
+    }
 
-            else{
-                (codeStruct->labelsPointer + labelNum)->addr  = codeStruct->pc;
+    return symbols;
+}
 
-                return hasMark;
-            }
-        }
+//line marks are sorted by pc once the code is linked
+
+static char* BuildLines(commands_t* codeStruct, size_t* size){
+    lineRow_t* rows    = (lineRow_t*)calloc(sizeof(lineRow_t), codeStruct->numMarks + 1);
+    char*      section = nullptr;
+    if (!rows) return nullptr;
+
+    for (size_t i = 0; i < codeStruct->numMarks; i++){
+        const lineMark_t* mark = codeStruct->linesPointer + i;
+
+        rows[i] = {mark->pc, (uint64_t)mark->line, mark->file};
     }
 
-    else if (param == FROM_FUNC){
-        if (hasMark){
-            if (ptr) *ptr = '\0';
-            int labelNum = FindLabel(codeStruct, arg);
+    if (EncodeLines(rows, codeStruct->numMarks, codeStruct->lineFiles, codeStruct->numLineFiles, &section, size)) section = nullptr;
 
-            if (labelNum == -1){
-                strcpy((codeStruct->labelsPointer + codeStruct->numElemsLabels)->name, arg);
-                (codeStruct->labelsPointer + codeStruct->numElemsLabels)->addr  = -1;
+    free(rows);
 
+    return section;
+}
 
-                //FIXUP:
-                fixup_t* fxp_ptr = codeStruct->fixupPointer;
+static errors OutputCodeBin(commands_t* codeStruct){
+    if (!codeStruct || !codeStruct->codePointer) return ERR_NULLPTR;
 
-                (fxp_ptr + codeStruct->numElemsFixup)->labelNum = codeStruct->numElemsLabels;
-                (fxp_ptr + codeStruct->numElemsFixup)->codeAdr  = codeStruct->pc + 1;
-                codeStruct->numElemsLabels++;
-                codeStruct->numElemsFixup++;
-                return -1;
-            }
+    int64_t dataLow = 0, dataHigh = 0, zeroLow = 0, zeroHigh = 0;
+    DataBounds(codeStruct, false, &dataLow, &dataHigh);
+    DataBounds(codeStruct, true,  &zeroLow, &zeroHigh);
 
-            else{
-                uint64_t returnValue = (codeStruct->labelsPointer + labelNum)->addr;
+    size_t   sizeSymbols = 0;
+    size_t   sizeLines   = 0;
+    int64_t* data        = BuildData   (codeStruct, dataLow, dataHigh);
+    char*    symbols     = BuildSymbols(codeStruct, &sizeSymbols);
+    char*    lines       = BuildLines  (codeStruct, &sizeLines);
+    errors   result      = ERR_NULLPTR;
 
-                if (returnValue == -1){
-                    fixup_t* fxp_ptr = codeStruct->fixupPointer;
+    if (data && symbols && lines){
+        sectionData_t sections[MAX_SECTIONS] = {};
+        size_t        numSections = 0;
 
-                    (fxp_ptr + codeStruct->numElemsFixup)->labelNum = codeStruct->numElemsLabels - 1;
-                    (fxp_ptr + codeStruct->numElemsFixup)->codeAdr  = codeStruct->pc + 1;
-                    codeStruct->numElemsFixup++;
-                }
+        sections[numSections++] = {SECTION_CODE, codeStruct->codePointer, codeStruct->pc * SIZE_ARG, 0};
 
-                return returnValue;
-            }
-        }
+        if (dataHigh > dataLow) sections[numSections++] = {SECTION_DATA, data, (size_t)(dataHigh - dataLow) * SIZE_ARG, dataLow};
+        if (zeroHigh > zeroLow) sections[numSections++] = {SECTION_ZERO, nullptr, (size_t)(zeroHigh - zeroLow), zeroLow};
 
-        else{
-            return ERR;
-        }
-    }
+        sections[numSections++] = {SECTION_SYMBOLS, symbols, sizeSymbols, 0};
+        sections[numSections++] = {SECTION_LINES,   lines,   sizeLines,   0};
 
-    else{
-        return hasMark;
+        result = (ContainerWrite(codeStruct->outputBinFile, sections, numSections)) ? ERR : OK;
     }
 
-    return ERR;
+    free(data);
+    free(symbols);
+    free(lines);
+
+    return result;
 }
 
 /*=======================================================================*/
+                                                                                //capital letters
+static int64_t FindRegisterName(char letter){
 
-static int FindLabel(commands_t* codeStruct, char* arg){
-
-    for (int i = 0; i < codeStruct->numElemsLabels; i++){
-        if (!strcmp((codeStruct->labelsPointer + i)->name, arg)){
-            return i;
-        }
-    }
+    return LowerChar(letter) - 'a' + 1;
 
-    return -1;
 }
 
 /*=======================================================================*/
 
-static errors FillLabels(commands_t* codeStruct){
+int64_t CheckMark(commands_t* codeStruct, string_t name, checkMarkParams param){   //rename
+
+    int64_t labelNum = FindLabel(codeStruct, name);
 
-    for (int i = 0; i < MAX_LABELS; i++){
-        (codeStruct->labelsPointer + i)->addr = -666;
-        strcpy((codeStruct->labelsPointer + i)->name, "meow");
+    if (labelNum == -1) labelNum = AddLabel(codeStruct, name);
+    if (labelNum == -1) return ERR;
+
+    if (param == FROM_CODE){
+        (codeStruct->labelsPointer + labelNum)->addr = codeStruct->pc;
+
+        return 1;
     }
 
-    return OK;
+    int64_t returnValue = (codeStruct->labelsPointer + labelNum)->addr;
+
+    if (returnValue == -1){
+        if (AddFixup(codeStruct, codeStruct->pc + 1, labelNum)) return ERR;
+    }
+
+    else if (codeStruct->relocatable){                                                  //local address, moves with the chunk
+        if (AddFixup(codeStruct, codeStruct->pc + 1, RELOCATION)) return ERR;
+    }
+
+    return returnValue;
 }
 
 /*=======================================================================*/
 
-static errors FillFixups(commands_t* codeStruct){
+static uint64_t HashName(string_t name){
+    uint64_t hash = 0xcbf29ce484222325;                                 //FNV-1a
 
-    for (int i = 0; i < MAX_FIXUP; i++){
-        (codeStruct->fixupPointer + i)->  codeAdr = -666;
-        (codeStruct->fixupPointer + i)->labelNum  = -666;
+    for (size_t i = 0; i < name.size; i++){
+        hash ^= (unsigned char)name.addr[i];
+        hash *= 0x100000001b3;
     }
 
-    return OK;
+    return hash;
 }
 
 /*=======================================================================*/
 
-static errors FixCode(commands_t* codeStruct){
+static int64_t FindLabel(commands_t* codeStruct, string_t name){
+    if (!codeStruct->sizeLabelsHash) return -1;
 
-    for (int i = 0; i < codeStruct->numElemsFixup; i++){
-        int64_t  codeAddr    = (codeStruct->fixupPointer + i)->codeAdr;
-        int64_t  labelNum    = (codeStruct->fixupPointer + i)->labelNum;
+    uint64_t hash = HashName(name);
+    size_t   mask = codeStruct->sizeLabelsHash - 1;
 
-        int64_t codeArgChangeTo   = (codeStruct->labelsPointer + labelNum)->addr;
+    for (size_t slot = hash & mask; codeStruct->labelsHash[slot]; slot = (slot + 1) & mask){
+        label_t* label = codeStruct->labelsPointer + codeStruct->labelsHash[slot] - 1;
 
-        *((int64_t*)codeStruct->codePointer + codeAddr) = codeArgChangeTo;                              //int64_t!!
+        if (label->hash == hash && label->nameSize == name.size && !memcmp(label->name, name.addr, name.size)){
+            return (int64_t)(codeStruct->labelsHash[slot] - 1);
+        }
     }
 
-    return OK;
+    return -1;
 }
 
 /*=======================================================================*/
 
-static char* GetWord(commands_t* codeStruct, int numLine, int wordSize, char* word){
-    string_t line       = codeStruct->splittedInput[numLine];
-    char* startAddr     = nullptr;
+static const char* InternName(commands_t* codeStruct, string_t name){
+    size_t len = name.size + 1;
 
-    if (!numLine)   startAddr = line.addr;
-    else            startAddr = line.addr + 1;
+    if (!codeStruct->numNameBlocks || codeStruct->nameBlockUsed + len > NAME_BLOCK_SIZE){
+        char** newBlocks = (char**)realloc(codeStruct->nameBlocks, sizeof(char*) * (codeStruct->numNameBlocks + 1));
+        if (!newBlocks) return nullptr;
+        codeStruct->nameBlocks = newBlocks;
 
-    char* returnValue = startAddr;
+        char* block = (char*)calloc(1, (len > NAME_BLOCK_SIZE) ? len : NAME_BLOCK_SIZE);
+        if (!block) return nullptr;
 
-    for (int i = 0; i < line.size - 1; i++){
-        if (startAddr[i] == '\n' || startAddr[i] == ' ' || startAddr[i] == '\t'){
-            word[i] = '\0';
+        codeStruct->nameBlocks[codeStruct->numNameBlocks++] = block;
+        codeStruct->nameBlockUsed = 0;
+    }
 
-            returnValue = startAddr + i + 1;
-            break;
-        }
+    char* interned = codeStruct->nameBlocks[codeStruct->numNameBlocks - 1] + codeStruct->nameBlockUsed;
+    memcpy(interned, name.addr, name.size);
+    interned[name.size] = '\0';
+    codeStruct->nameBlockUsed += len;
 
-        word[i] = startAddr[i];
-    }
+    return interned;
+}
 
-    bool hasMark = (strchr(word, ':') == nullptr)? 0:1;
-    if (!hasMark){
-        for (int j = 0; word[j] != '\0' && word[j] != '\n' && word[j] != ' '; j++){
-            word[j] = tolower(startAddr[j]);
-        }
+/*=======================================================================*/
+
+static errors RehashLabels(commands_t* codeStruct, size_t newSize){
+    size_t* newHash = (size_t*)calloc(sizeof(size_t), newSize);
+    if (!newHash) return ERR;
 
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        size_t slot = (codeStruct->labelsPointer + i)->hash & (newSize - 1);
+        while (newHash[slot]) slot = (slot + 1) & (newSize - 1);
+
+        newHash[slot] = i + 1;
     }
 
-    return returnValue;
+    free(codeStruct->labelsHash);
+    codeStruct->labelsHash     = newHash;
+    codeStruct->sizeLabelsHash = newSize;
+
+    return OK;
 }
 
 /*=======================================================================*/
 
-static char* GetArg(char* input, char* arg){
+static int64_t AddLabel(commands_t* codeStruct, string_t name){
 
-    for (int i = 0; i < MAX_ARGLEN; i++){
-        if (input[i] == '\n' || input[i] == ' '){
-            arg[i] = '\0';
+    if (codeStruct->numElemsLabels == codeStruct->sizeLabels){
+        size_t newSize = codeStruct->sizeLabels * 2;
 
-            return arg + i + 1;
-        }
+        label_t* newLabels = (label_t*)realloc(codeStruct->labelsPointer, sizeof(label_t) * newSize);
+        if (!newLabels) return -1;
+
+        codeStruct->labelsPointer = newLabels;
+        codeStruct->sizeLabels    = newSize;
+    }
 
-        arg[i] = input[i];
+    if ((codeStruct->numElemsLabels + 1) * 2 > codeStruct->sizeLabelsHash){             //load factor <= 1/2
+        if (RehashLabels(codeStruct, codeStruct->sizeLabelsHash * 2)) return -1;
     }
 
+    label_t* label = codeStruct->labelsPointer + codeStruct->numElemsLabels;
+
+    label->name     = InternName(codeStruct, name);
+    label->nameSize = name.size;
+    label->hash     = HashName(name);
+    label->addr     = -1;
+    if (!label->name) return -1;
+
+    size_t mask = codeStruct->sizeLabelsHash - 1;
+    size_t slot = label->hash & mask;
+    while (codeStruct->labelsHash[slot]) slot = (slot + 1) & mask;
+
+    codeStruct->labelsHash[slot] = ++codeStruct->numElemsLabels;
 
-    return arg;
+    return (int64_t)(codeStruct->numElemsLabels - 1);
 }
 
 /*=======================================================================*/
 
-static errors SplitCode(commands_t* codeStruct){
-    codeStruct->splittedInput->addr = (char*)codeStruct->fileBuffer;
+static errors AddFixup(commands_t* codeStruct, int64_t codeAdr, int64_t labelNum){
 
-    for (int i = 0; i < codeStruct->sizeFileBuffer; i++){
-        char arg = ((char*)codeStruct->fileBuffer)[i];
+    if (codeStruct->numElemsFixup == codeStruct->sizeFixup){
+        size_t newSize = codeStruct->sizeFixup * 2;
 
-        if (arg == '\n'){
-            (codeStruct->splittedInput)[codeStruct->numSplitted + 1].addr   = (char*)(codeStruct->fileBuffer) + i;
-            char* lastAdr = (char*)(codeStruct->fileBuffer) + i;
-            char* prevAdr = (codeStruct->splittedInput)[codeStruct->numSplitted].addr;
+        fixup_t* newFixups = (fixup_t*)realloc(codeStruct->fixupPointer, sizeof(fixup_t) * newSize);
+        if (!newFixups) return ERR;
 
-            (codeStruct->splittedInput)[codeStruct->numSplitted].size = lastAdr - prevAdr;
-            codeStruct->numSplitted++;
-        }
+        codeStruct->fixupPointer = newFixups;
+        codeStruct->sizeFixup    = newSize;
     }
 
+    (codeStruct->fixupPointer + codeStruct->numElemsFixup)->codeAdr  = codeAdr;
+    (codeStruct->fixupPointer + codeStruct->numElemsFixup)->labelNum = labelNum;
+    codeStruct->numElemsFixup++;
+
     return OK;
 }
+
 /*=======================================================================*/
 
-static void CompilePushArg(commands_t* codeStruct, bool* RunCommands, char* secondCmdPtr){
-    int64_t numArg = 0;
-    int64_t numReg = 0;
+//copies the chunk into the merged code and patches it, chunks are independent here
 
-    char secondArg[32]  = "";
-    GetArg(secondCmdPtr, secondArg);
+static errors FixCode(chunk_t* chunk){
+    commands_t* unit = &chunk->unit;
+    int64_t*    code = chunk->code + chunk->base;
 
-    char* ptrMemory     = strchr(secondArg,'[');
-    char* ptrRegisters  = strchr(secondArg,'x');
-    char* ptrSum        = strchr(secondArg,'+');
-    bool mem    = (ptrMemory)       ?1:0;
-    bool reg    = (ptrRegisters)    ?1:0;
-    bool sum    = (ptrSum)          ?1:0;
-    char switchValue    = reg * 2 + sum;
+    memcpy(code, unit->codePointer, unit->pc * SIZE_ARG);
 
-    switch (switchValue){
-        case 0:{
-            numArg = atol(secondArg);
-            if (mem) numArg = atol(ptrMemory + 1);
+    for (size_t i = 0; i < unit->numElemsFixup; i++){
+        int64_t  codeAddr    = (unit->fixupPointer + i)->codeAdr;
+        int64_t  labelNum    = (unit->fixupPointer + i)->labelNum;
 
+        if (labelNum == RELOCATION) code[codeAddr] += (int64_t)chunk->base;
+        else                        code[codeAddr]  = chunk->labelValues[labelNum];    //int64_t!!
+    }
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc)            = 0b00100001;
-            if (mem) *((uint64_t*)codeStruct->codePointer + codeStruct->pc)   = 0b10100001;
+    return OK;
+}
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1) = numArg;
-            codeStruct->pc += 2;
-            break;
-        }
 
-        case 2:{
-            numReg = FindRegisterName(ptrRegisters - 1);
+/*=======================================================================*/
 
+static errors EmitWord(commands_t* codeStruct, int64_t word){
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc)            = 0b01000001;
-            if (mem) *((uint64_t*)codeStruct->codePointer + codeStruct->pc)   = 0b11000001;
+    if ((codeStruct->pc + 1) * SIZE_ARG > codeStruct->sizeAllocated){
+        void* newCode = realloc(codeStruct->codePointer, codeStruct->sizeAllocated * 2);
+        if (!newCode) return ERR_NULLPTR;
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numReg;
-            codeStruct->pc += 2;
-            break;
-        }
+        codeStruct->codePointer    = newCode;
+        codeStruct->sizeAllocated *= 2;
+    }
 
-        case 3:{
-            numArg = atol(ptrSum + 1);
-            numReg = FindRegisterName(ptrRegisters - 1);
+    *((int64_t*)codeStruct->codePointer + codeStruct->pc) = word;
+    codeStruct->pc++;
 
+    return OK;
+}
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc)            = 0b01100001;
-            if (mem) *((uint64_t*)codeStruct->codePointer + codeStruct->pc)   = 0b11100001;
+/*=======================================================================*/
 
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numReg;
-            *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 2)= numArg;
-            codeStruct->pc += 3;
-            break;
-        }
+static string_t TokenView(const token_t* token){
+    string_t view = {token->size, token->addr};
 
-        default:{
-            RunCommands = 0;
-            printf(BRED "\nERROR\n\n" RESET);
-            break;
-        }
-    }
+    return view;
 }
 
 /*=======================================================================*/
 
-static void CompileJumpArg(commands_t* codeStruct, char* secondCmdPtr, int commandNum){
-    int64_t numArg = 0;
-    char secondArg[MAX_ARGLEN]  = "";
-    GetArg(secondCmdPtr, secondArg);
+static bool IsToken(const token_t* tokens, size_t numTokens, size_t pos, tokenType type){
+    return pos < numTokens && tokens[pos].type == type;
+}
 
-    char* ptr = strchr(secondArg, ':');
+/*=======================================================================*/
+
+static errors ParseFloat(string_t text, int64_t* value){
+    char number[MAX_NUMLEN] = "";
+    if (text.size >= MAX_NUMLEN) return ERR;
+    memcpy(number, text.addr, text.size);
 
-    if (ptr) numArg = CheckMark(codeStruct, secondArg, FROM_FUNC);
-    else     numArg = atol(secondArg);
+    char* end = nullptr;
+    double floatValue = strtod(number, &end);
+    if (end == number || *end) return ERR;
 
-    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)        = commandNum;
-    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)    = numArg;
-    codeStruct->pc += 2;
+    *value = DoubleToWord(floatValue);
+    return OK;
 }
 
-/*=======================================================================*/
+//an integer if every char is a digit, else a double such as 2.5 or 1e5
+static errors ParseNumber(string_t text, int64_t* value){
+    if (!text.size) return ERR;
 
-static void CompileCallArg(commands_t* codeStruct, char* secondCmdPtr){
-    int64_t numArg = 0;
-    char secondArg[32]  = "";
-    GetArg(secondCmdPtr, secondArg);
+    size_t   i        = (text.addr[0] == '-' || text.addr[0] == '+') ? 1 : 0;
+    bool     negative = (text.addr[0] == '-');
+    uint64_t number   = 0;
+
+    if (i == text.size) return ERR;
+
+    for (; i < text.size; i++){
+        if (!isdigit((unsigned char)text.addr[i])) return ParseFloat(text, value);
+
+        number = number * 10 + (uint64_t)(text.addr[i] - '0');
+    }
 
-    numArg = CheckMark(codeStruct, secondArg, FROM_FUNC);
+    *value = (int64_t)((negative) ? 0 - number : number);
 
-    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)        = CALL;
-    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)    = numArg;
-    codeStruct->pc += 2;
+    return OK;
 }
 
 /*=======================================================================*/
 
-static void CompilePopArg(commands_t* codeStruct, bool* RunCommands, char* second_cmdPtr){
+static errors ParseOperandPart(string_t part, operand_t* operand){
 
+    if (part.size == 2 && isalpha((unsigned char)part.addr[0]) && LowerChar(part.addr[1]) == 'x'){
+        if (operand->reg) return ERR;
 
-    int64_t numArg = 0;
-            int64_t numReg = 0;
+        operand->reg    = true;
+        operand->numReg = FindRegisterName(part.addr[0]);
+
+        return OK;
+    }
 
-            char secondArg[MAX_ARGLEN]  = "";
-            GetArg(second_cmdPtr, secondArg);
+    if (operand->imm) return ERR;
+    operand->imm = true;
 
-            char* ptrMemory     = strchr(secondArg,'[');
-            char* ptrRegisters  = strchr(secondArg,'x');
-            char* ptrSum        = strchr(secondArg,'+');
-            bool mem    = (ptrMemory)       ?1:0;
-            bool reg    = (ptrRegisters)    ?1:0;
-            bool sum    = (ptrSum)          ?1:0;
-            char switchValue = mem * 4 + reg * 2 + sum;
+    return ParseNumber(part, &operand->numArg);
+}
 
-            switch(switchValue){
-                case 2:{
-                    numReg = FindRegisterName(ptrRegisters - 1);
+/*=======================================================================*/
 
+static errors ParseOperand(const token_t* tokens, size_t numTokens, size_t* pos, operand_t* operand){
+    *operand = {};
 
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)    = 0b01001001;
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numReg;
-                    codeStruct->pc += 2;
-                    break;
-                }
+    if (IsToken(tokens, numTokens, *pos, TOKEN_LBRACKET)){
+        operand->mem = true;
+        (*pos)++;
+    }
 
-                case 4:{
-                    numArg = atol(ptrMemory + 1);
+    if (!IsToken(tokens, numTokens, *pos, TOKEN_WORD))              return ERR;
+    if (ParseOperandPart(TokenView(tokens + *pos), operand))        return ERR;
+    (*pos)++;
 
+    if (IsToken(tokens, numTokens, *pos, TOKEN_PLUS)){
+        (*pos)++;
 
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)    = 0b10101001;
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numArg;
-                    codeStruct->pc += 2;
-                    break;
-                }
+        if (!IsToken(tokens, numTokens, *pos, TOKEN_WORD))          return ERR;
+        if (ParseOperandPart(TokenView(tokens + *pos), operand))    return ERR;
+        (*pos)++;
+    }
 
-                case 6:{
-                    numReg = FindRegisterName(ptrRegisters - 1);
+    if (operand->mem){
+        if (!IsToken(tokens, numTokens, *pos, TOKEN_RBRACKET))      return ERR;
+        (*pos)++;
+    }
 
+    return OK;
+}
 
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)    = 0b11001001;
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numReg;
-                    codeStruct->pc += 2;
-                    break;
-                }
+/*=======================================================================*/
 
-                case 7:{
-                    numArg = atol(ptrSum + 1);
-                    numReg = FindRegisterName(ptrRegisters - 1);
+static errors EmitOperand(commands_t* codeStruct, int64_t command, operand_t* operand){
 
+    if (operand->imm) command |= immediateMask;
+    if (operand->reg) command |= registerMask;
+    if (operand->mem) command |= memoryMask;
 
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc)    = 0b11101001;
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 1)= numReg;
-                    *((uint64_t*)codeStruct->codePointer + codeStruct->pc + 2)= numArg;
-                    codeStruct->pc += 3;
-                    break;
-                }
+    if (EmitWord(codeStruct, command))                                  return ERR;
+    if (operand->reg && EmitWord(codeStruct, operand->numReg))          return ERR;
+    if (operand->imm && EmitWord(codeStruct, operand->numArg))          return ERR;
 
-                default:{
-                    RunCommands = 0;
-                    printf(BRED "\nERROR\n\n" RESET);
-                    break;
-                }
-            }
+    return OK;
 }
-/*=======================================================================*/
 
-static void Compile(fileNames_t* fileNames){
-    commands_t codeStruct = {};
-    codeStruct.fileNames = fileNames;
+/*=======================================================================*/
 
-    CommandsCtor(&codeStruct, "mycode");
+static errors CompilePushArg(commands_t* codeStruct, const token_t* tokens, size_t numTokens){
+    operand_t operand = {};
+    size_t pos = 1;
 
-    FILE* inputFile  = codeStruct.inputFile;
-    FILE* outputFile = codeStruct.outputFile;
+    if (ParseOperand(tokens, numTokens, &pos, &operand)) return ERR;
 
-    bool RunCommands    = 1;
-    int numLine         = 0;
+    return EmitOperand(codeStruct, PUSH, &operand);
+}
 
-    while (RunCommands){
-        char cmd[MAX_CMDLEN] = {};
-        if (numLine >= codeStruct.numSplitted) break;
+/*=======================================================================*/
 
-        char* secondCmdPtr = GetWord(&codeStruct, numLine, MAX_CMDLEN, cmd);
+static errors CompilePopArg(commands_t* codeStruct, const token_t* tokens, size_t numTokens){
+    operand_t operand = {};
+    size_t pos = 1;
 
-        if (!strcmp(cmd, "push")){
-            CompilePushArg(&codeStruct, &RunCommands, secondCmdPtr);
-        }
+    if (ParseOperand(tokens, numTokens, &pos, &operand)) return ERR;
+    if (!operand.mem && operand.imm)                     return ERR;             //pop 5, pop ax+5
 
-        else if (!strcmp(cmd, "pop")){
-            CompilePopArg(&codeStruct, &RunCommands, secondCmdPtr);
-        }
+    return EmitOperand(codeStruct, POP, &operand);
+}
 
-        else if (!strcmp(cmd, "add")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = ADD;
-            codeStruct.pc++;
-        }
+/*=======================================================================*/
 
-        else if (!strcmp(cmd, "sub")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = SUB;
-            codeStruct.pc++;
-        }
+static errors CompileJumpArg(commands_t* codeStruct, const token_t* tokens, size_t numTokens, int64_t commandNum){
+    int64_t numArg = 0;
 
-        else if (!strcmp(cmd, "mul")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = MUL;
-            codeStruct.pc++;
-        }
+    if (!IsToken(tokens, numTokens, 1, TOKEN_WORD)) return ERR;
 
-        else if (!strcmp(cmd, "div")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = DIV;
-            codeStruct.pc++;
-        }
+    if (IsToken(tokens, numTokens, 2, TOKEN_COLON)){
+        numArg = CheckMark(codeStruct, TokenView(tokens + 1), FROM_FUNC);
+        if (numArg == ERR) return ERR;
+    }
 
-        else if (!strcmp(cmd, "sqrt")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = SQRT;
-            codeStruct.pc++;
-        }
+    else if (ParseNumber(TokenView(tokens + 1), &numArg)) return ERR;
 
-        else if (!strcmp(cmd, "sin")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = SIN;
-            codeStruct.pc++;
-        }
+    if (EmitWord(codeStruct, commandNum)) return ERR;
 
-        else if (!strcmp(cmd, "cos")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = COS;
-            codeStruct.pc++;
-        }
+    return EmitWord(codeStruct, numArg);
+}
 
-        else if (!strcmp(cmd, "out")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = OUT;
-            codeStruct.pc++;
-        }
+/*=======================================================================*/
 
-        else if (!strcmp(cmd, "in")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = IN;
-            codeStruct.pc++;
-        }
+static errors CompileBlockArgs(commands_t* codeStruct, const token_t* tokens, size_t numTokens,
+                               int64_t commandNum, size_t numArgs){
+    int64_t args[MAX_BLOCK_ARGS] = {};
+    size_t pos = 1;
 
-        else if (!strcmp(cmd, "dump")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = DUMP;
-            codeStruct.pc++;
-        }
+    for (size_t i = 0; i < numArgs; i++){
+        operand_t operand = {};
 
-        else if (!strcmp(cmd, "draw")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = DRAW;
-            codeStruct.pc++;
-        }
+        if (i && IsToken(tokens, numTokens, pos, TOKEN_COMMA)) pos++;
 
-        else if (!strcmp(cmd, "jmp")){
-            CompileJumpArg(&codeStruct, secondCmdPtr, JMP);
-        }
+        if (ParseOperand(tokens, numTokens, &pos, &operand)) return ERR;
+        if (operand.reg == operand.imm)                     return ERR;             //no [ax+5] here
 
-        else if (!strcmp(cmd, "ja")){
-            CompileJumpArg(&codeStruct, secondCmdPtr, JA);
+        if (operand.reg){
+            args[i]     = operand.numReg;
+            commandNum |= BLOCK_REG_ARG << i;
         }
 
-        else if (!strcmp(cmd, "jae")){
-            CompileJumpArg(&codeStruct, secondCmdPtr, JAE);
-        }
+        else args[i] = operand.numArg;
+    }
 
-        else if (!strcmp(cmd, "je")){
-            CompileJumpArg(&codeStruct, secondCmdPtr, JE);
-        }
+    if (EmitWord(codeStruct, commandNum)) return ERR;
 
-        else if (!strcmp(cmd, "jne")){
-            CompileJumpArg(&codeStruct, secondCmdPtr, JNE);
-        }
+    for (size_t i = 0; i < numArgs; i++){
+        if (EmitWord(codeStruct, args[i])) return ERR;
+    }
 
-        else if (!strcmp(cmd, "hlt")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = HLT;
-            codeStruct.pc++;
-        }
+    return OK;
+}
 
-        else if (!strcmp(cmd, "call")){
-            CompileCallArg(&codeStruct, secondCmdPtr);
-        }
+/*=======================================================================*/
 
-        else if (!strcmp(cmd, "ret")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = RET;
-            codeStruct.pc++;
-        }
+static errors EmitData(commands_t* codeStruct, int64_t word){
 
-        else if (!strcmp(cmd, "mod")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = MOD;
-            codeStruct.pc++;
-        }
+    if (codeStruct->numData + 1 > codeStruct->sizeData){
+        size_t   newSize = (codeStruct->sizeData) ? codeStruct->sizeData * 2 : MIN_DATA;
+        int64_t* newData = (int64_t*)realloc(codeStruct->dataPointer, newSize * SIZE_ARG);
+        if (!newData) return ERR_NULLPTR;
 
-        else if (!strcmp(cmd, "less")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = LS;
-            codeStruct.pc++;
-        }
+        codeStruct->dataPointer = newData;
+        codeStruct->sizeData    = newSize;
+    }
 
-        else if (!strcmp(cmd, "less_equal")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = LS_EQ;
-            codeStruct.pc++;
-        }
+    codeStruct->dataPointer[codeStruct->numData++] = word;
 
-        else if (!strcmp(cmd, "equal")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = EQL;
-            codeStruct.pc++;
-        }
+    return OK;
+}
 
-        else if (!strcmp(cmd, "more")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = MR;
-            codeStruct.pc++;
-        }
+/*=======================================================================*/
 
-        else if (!strcmp(cmd, "more_equal")){
-            *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = MR_EQ;
-            codeStruct.pc++;
-        }
+static errors AddLineMark(commands_t* codeStruct, int64_t pc, int64_t line, uint64_t file){
 
-        else{
-            if (!CheckMark(&codeStruct, cmd, FROM_CODE)){
-                *((uint64_t*)codeStruct.codePointer + codeStruct.pc) = ERR; //!!!
-            }
-        }
+    if (codeStruct->numMarks + 1 > codeStruct->sizeLines){
+        size_t      newSize  = (codeStruct->sizeLines) ? codeStruct->sizeLines * 2 : MIN_MARKS;
+        lineMark_t* newMarks = (lineMark_t*)realloc(codeStruct->linesPointer, newSize * sizeof(lineMark_t));
+        if (!newMarks) return ERR_NULLPTR;
 
-        numLine++;
+        codeStruct->linesPointer = newMarks;
+        codeStruct->sizeLines    = newSize;
     }
 
-    FixCode(&codeStruct);
-    CommandsDump(&codeStruct);
+    codeStruct->linesPointer[codeStruct->numMarks++] = {pc, line, file};
 
-    OutputCodeBin(&codeStruct);
+    return OK;
+}
 
-    PrintSignature(&codeStruct);
-    OutputCodeListing(&codeStruct);
+/*=======================================================================*/
+//.data ADDR, word, word ... and .zero ADDR, N - RAM the program starts with, instead of the pushes and pops
+//that would fill it; each line is a run of its own, so chunks and cached units keep them as they are
 
-    CommandsDtor(&codeStruct);
+static bool IsDirective(const token_t* token, const char* name){
+    return token->size == strlen(name) && !memcmp(token->addr, name, token->size);
 }
 
+static errors CompileData(commands_t* codeStruct, const token_t* tokens, size_t numTokens, bool zero){
+    int64_t address = 0;
+
+    if (!IsToken(tokens, numTokens, 1, TOKEN_WORD) || ParseNumber(TokenView(tokens + 1), &address))    return ERR;
+    if (address < 0 || address >= MAX_DATA_ADDRESS)                                                    return ERR;
+
+    if (zero){
+        int64_t count = 0;
+
+        if (!IsToken(tokens, numTokens, 2, TOKEN_COMMA) || !IsToken(tokens, numTokens, 3, TOKEN_WORD))  return ERR;
+        if (ParseNumber(TokenView(tokens + 3), &count) || count <= 0 || count > MAX_DATA_ADDRESS - address) return ERR;
+
+        return (EmitData(codeStruct, address) || EmitData(codeStruct, -count)) ? ERR : OK;
+    }
+
+    size_t  runStart = codeStruct->numData;
+    int64_t count    = 0;
+
+    if (EmitData(codeStruct, address) || EmitData(codeStruct, 0)) return ERR;
+
+    for (size_t pos = 2; IsToken(tokens, numTokens, pos, TOKEN_COMMA); pos += 2){
+        int64_t value = 0;
+
+        if (!IsToken(tokens, numTokens, pos + 1, TOKEN_WORD) || ParseNumber(TokenView(tokens + pos + 1), &value)) return ERR;
+        if (EmitData(codeStruct, value)) return ERR;
+
+        count++;
+    }
+
+    if (!count || count > MAX_DATA_ADDRESS - address) return ERR;
+
+    codeStruct->dataPointer[runStart + 1] = count;
+
+    return OK;
+}
+
+/*=======================================================================*/
+//tokens of one line without the newline, anything after the args is a comment
+
+static errors CompileLine(commands_t* codeStruct, const token_t* tokens, size_t numTokens){
+    if (!numTokens)                     return OK;
+    if (tokens[0].type != TOKEN_WORD)   return ERR;
+
+    if (IsToken(tokens, numTokens, 1, TOKEN_COLON)){
+        return (CheckMark(codeStruct, TokenView(tokens), FROM_CODE) == ERR) ? ERR : OK;
+    }
+
+    if (IsDirective(tokens, ".data")) return CompileData(codeStruct, tokens, numTokens, false);
+    if (IsDirective(tokens, ".zero")) return CompileData(codeStruct, tokens, numTokens, true);
+
+    const instruction_t* instruction = FindInstruction(tokens[0].addr, tokens[0].size);
+    if (!instruction) return ERR;
+
+    switch (instruction->args){
+        case ARGS_PUSH:     return CompilePushArg   (codeStruct, tokens, numTokens);
+        case ARGS_POP:      return CompilePopArg    (codeStruct, tokens, numTokens);
+        case ARGS_LABEL:    return CompileJumpArg   (codeStruct, tokens, numTokens, instruction->code);
+        case ARGS_BLOCK2:   return CompileBlockArgs (codeStruct, tokens, numTokens, instruction->code, 2);
+        case ARGS_BLOCK3:   return CompileBlockArgs (codeStruct, tokens, numTokens, instruction->code, 3);
+        case ARGS_BLOCK4:   return CompileBlockArgs (codeStruct, tokens, numTokens, instruction->code, 4);
+
+        case ARGS_NONE:
+        default:            return EmitWord(codeStruct, instruction->code);
+    }
+}
+
+/*=======================================================================*/
+
+static errors CompileTokens(commands_t* codeStruct, const token_t* tokens, size_t numTokens){
+    size_t lineStart = 0;
+
+    for (size_t i = 0; i < numTokens; i++){
+        if (tokens[i].type != TOKEN_NEWLINE) continue;
+
+        codeStruct->numLine++;
+
+        size_t pc = codeStruct->pc;
+
+        if (CompileLine(codeStruct, tokens + lineStart, i - lineStart)){
+            const char* lineAddr = (i > lineStart) ? tokens[lineStart].addr : tokens[i].addr;
+
+            codeStruct->errorLine     = lineAddr;
+            codeStruct->errorLineSize = (size_t)(tokens[i].addr - lineAddr);
+            return ERR;
+        }
+
+        if (codeStruct->pc > pc && AddLineMark(codeStruct, (int64_t)pc, (int64_t)codeStruct->numLine, 0)) return ERR;
+
+        lineStart = i + 1;
+    }
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static void* CompileChunk(void* arg){
+    chunk_t* chunk = (chunk_t*)arg;
+    lexer_t  lexer = {};
+
+    if (chunk->cached) return LoadUnit(chunk);
+
+    chunk->result = (LexerCtor(&lexer, chunk->begin, chunk->size)) ? ERR : OK;
+
+    while (!chunk->result){
+        if (LexTokens(&lexer)){
+            chunk->result = ERR;
+            break;
+        }
+
+        if (!lexer.numTokens) break;
+
+        chunk->result = CompileTokens(&chunk->unit, lexer.tokens, lexer.numTokens);
+    }
+
+    LexerDtor(&lexer);
+
+    return nullptr;
+}
+
+/*=======================================================================*/
+
+static void* FixChunk(void* arg){
+    FixCode((chunk_t*)arg);
+
+    return nullptr;
+}
+
+/*=======================================================================*/
+
+static void* PoolWorker(void* arg){
+    chunkPool_t* pool = (chunkPool_t*)arg;
+
+    while (true){
+        size_t i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (i >= pool->numChunks) break;
+
+        pool->worker(pool->chunks + i);
+    }
+
+    return nullptr;
+}
+
+/*=======================================================================*/
+
+static void RunChunks(chunk_t* chunks, size_t numChunks, size_t numThreads, void* (*worker)(void*)){
+    chunkPool_t pool = {chunks, numChunks, 0, worker};
+    pthread_t   threads[MAX_THREADS] = {};
+    bool        started[MAX_THREADS] = {};
+
+    if (numThreads > numChunks) numThreads = numChunks;
+
+    for (size_t i = 1; i < numThreads; i++){
+        started[i] = !pthread_create(threads + i, nullptr, PoolWorker, &pool);
+    }
+
+    PoolWorker(&pool);
+
+    for (size_t i = 1; i < numThreads; i++){
+        if (started[i]) pthread_join(threads[i], nullptr);
+    }
+}
+
+/*=======================================================================*/
+
+static chunk_t* AddChunk(chunk_t** chunks, size_t* numChunks, size_t* sizeChunks, const char* begin, size_t size){
+
+    if (*numChunks == *sizeChunks){
+        chunk_t* newChunks = (chunk_t*)realloc(*chunks, sizeof(chunk_t) * *sizeChunks * 2);
+        if (!newChunks) return nullptr;
+
+        memset(newChunks + *sizeChunks, 0, sizeof(chunk_t) * *sizeChunks);
+        *chunks      = newChunks;
+        *sizeChunks *= 2;
+    }
+
+    chunk_t* chunk = *chunks + (*numChunks)++;
+    chunk->begin = begin;
+    chunk->size  = size;
+
+    return chunk;
+}
+
+/*=======================================================================*/
+//chunk borders are always right after a newline
+
+static size_t SplitChunks(commands_t* codeStruct, chunk_t** chunks, size_t* sizeChunks, size_t numThreads){
+    size_t numChunks = codeStruct->sizeFileBuffer / MIN_CHUNK_SIZE;
+    if (numChunks > numThreads) numChunks = numThreads;
+    if (!numChunks)             numChunks = 1;
+
+    const char* buffer = codeStruct->fileBuffer;
+    size_t      size   = codeStruct->sizeFileBuffer;
+    size_t      start  = 0;
+    size_t      count  = 0;
+
+    for (size_t i = 0; i < numChunks && start < size; i++){
+        size_t end = size;
+
+        if (i + 1 < numChunks){
+            end = size / numChunks * (i + 1);
+            if (end < start) end = start;
+
+            const char* newline = (const char*)memchr(buffer + end, '\n', size - end);
+            end = (newline) ? (size_t)(newline - buffer) + 1 : size;
+        }
+
+        if (!AddChunk(chunks, &count, sizeChunks, buffer + start, end - start)) return 0;
+
+        start = end;
+    }
+
+    if (!count && !AddChunk(chunks, &count, sizeChunks, buffer, 0)) return 0;
+
+    return count;
+}
+
+/*=======================================================================*/
+
+static bool IsLabelLine(const char* line, const char* end){
+    while (line < end && (*line == ' ' || *line == '\t' || *line == '\r')) line++;
+
+    const char* word = line;
+    while (line < end && !strchr(" \t\r\n:[]+,", *line)) line++;
+
+    return line > word && line < end && *line == ':';
+}
+
+/*=======================================================================*/
+//regions end right before a label definition, so an edit only changes the regions around it
+
+static size_t SplitRegions(commands_t* codeStruct, chunk_t** chunks, size_t* sizeChunks){
+    const char* buffer = codeStruct->fileBuffer;
+    const char* end    = buffer + codeStruct->sizeFileBuffer;
+    const char* start  = buffer;
+    size_t      count  = 0;
+
+    while (start < end){
+        const char* line = (end - start > (ptrdiff_t)MIN_REGION_SIZE) ? start + MIN_REGION_SIZE - 1 : end;
+
+        while (line < end){
+            const char* newline = (const char*)memchr(line, '\n', (size_t)(end - line));
+
+            line = (newline) ? newline + 1 : end;
+            if (IsLabelLine(line, end)) break;
+        }
+
+        if (!AddChunk(chunks, &count, sizeChunks, start, (size_t)(line - start))) return 0;
+
+        start = line;
+    }
+
+    if (!count && !AddChunk(chunks, &count, sizeChunks, buffer, 0)) return 0;
+
+    return count;
+}
+
+/*=======================================================================*/
+//word at a time, FNV-1a over every byte is the slowest part of a warm rebuild
+
+static uint64_t HashSource(const char* source, size_t size){
+    uint64_t hash = 0xcbf29ce484222325 ^ size;
+    size_t   i    = 0;
+
+    for (; i + 8 <= size; i += 8){
+        uint64_t word = 0;
+        memcpy(&word, source + i, 8);
+
+        hash = (hash ^ word) * 0x100000001b3;
+        hash ^= hash >> 29;
+    }
+
+    for (; i < size; i++) hash = (hash ^ (unsigned char)source[i]) * 0x100000001b3;
+
+    return hash ^ (hash >> 32);
+}
+
+
+/*=======================================================================*/
+
+static void* LoadUnit(chunk_t* chunk){
+    commands_t*         unit   = &chunk->unit;
+    const unitEntry_t* entry  = (const unitEntry_t*)chunk->cached;
+    const char*         data   = chunk->cached + sizeof(unitEntry_t);
+
+    const int64_t*      code   = (const int64_t*)data;
+    const int64_t*      runs   = code + entry->numCommands;
+    const lineMark_t*   marks  = (const lineMark_t*)(runs + entry->numData);
+    const unitLabel_t* labels = (const unitLabel_t*)(marks + entry->numMarks);
+    const fixup_t*      fixups = (const fixup_t*)(labels + entry->numLabels);
+    const char*         names  = (const char*)(fixups + entry->numFixups);
+
+    chunk->result = ERR;
+
+    if (entry->numCommands * SIZE_ARG > unit->sizeAllocated){
+        void* newCode = realloc(unit->codePointer, entry->numCommands * SIZE_ARG);
+        if (!newCode) return nullptr;
+
+        unit->codePointer   = newCode;
+        unit->sizeAllocated = entry->numCommands * SIZE_ARG;
+    }
+
+    memcpy(unit->codePointer, code, entry->numCommands * SIZE_ARG);
+    unit->pc = entry->numCommands;
+
+    for (size_t i = 0; i < entry->numData; i++){
+        if (EmitData(unit, runs[i])) return nullptr;
+    }
+
+    for (size_t i = 0; i < entry->numMarks; i++){
+        if (AddLineMark(unit, marks[i].pc, marks[i].line, 0)) return nullptr;
+    }
+
+    for (size_t i = 0; i < entry->numLabels; i++){
+        string_t name     = {labels[i].nameSize, names};
+        int64_t  labelNum = AddLabel(unit, name);
+        if (labelNum == -1) return nullptr;
+
+        (unit->labelsPointer + labelNum)->addr = labels[i].addr;
+        names += labels[i].nameSize;
+    }
+
+    for (size_t i = 0; i < entry->numFixups; i++){
+        if (AddFixup(unit, fixups[i].codeAdr, fixups[i].labelNum)) return nullptr;
+    }
+
+    unit->numLine = entry->numLine;
+    chunk->result = OK;
+
+    return nullptr;
+}
+
+/*=======================================================================*/
+
+static errors WriteUnit(FILE* file, chunk_t* chunk){
+    commands_t*  unit     = &chunk->unit;
+    unitEntry_t entry    = {};
+    size_t       sizeNames = 0;
+
+    for (size_t i = 0; i < unit->numElemsLabels; i++) sizeNames += (unit->labelsPointer + i)->nameSize;
+
+    entry.hash          = chunk->hash;
+    entry.sourceSize    = chunk->size;
+    entry.numCommands   = unit->pc;
+    entry.numLine       = unit->numLine;
+    entry.numLabels     = unit->numElemsLabels;
+    entry.numFixups     = unit->numElemsFixup;
+    entry.numData       = unit->numData;
+    entry.numMarks      = unit->numMarks;
+    entry.sizeEntry     = sizeof(unitEntry_t) + (unit->pc + unit->numData) * SIZE_ARG + entry.numMarks * sizeof(lineMark_t) +
+                          entry.numLabels * sizeof(unitLabel_t) + entry.numFixups * sizeof(fixup_t) + Align8(sizeNames);
+
+    fwrite(&entry, sizeof(unitEntry_t), 1, file);
+    fwrite(unit->codePointer, SIZE_ARG, unit->pc, file);
+    fwrite(unit->dataPointer, SIZE_ARG, unit->numData, file);
+    fwrite(unit->linesPointer, sizeof(lineMark_t), unit->numMarks, file);
+
+    for (size_t i = 0; i < unit->numElemsLabels; i++){
+        unitLabel_t label = {(unit->labelsPointer + i)->addr, (unit->labelsPointer + i)->nameSize};
+        fwrite(&label, sizeof(unitLabel_t), 1, file);
+    }
+
+    fwrite(unit->fixupPointer, sizeof(fixup_t), unit->numElemsFixup, file);
+
+    for (size_t i = 0; i < unit->numElemsLabels; i++){
+        fwrite((unit->labelsPointer + i)->name, 1, (unit->labelsPointer + i)->nameSize, file);
+    }
+
+    const char padding[8] = {};
+    fwrite(padding, 1, Align8(sizeNames) - sizeNames, file);
+
+    return (ferror(file)) ? ERR : OK;
+}
+
+/*=======================================================================*/
+
+//every run is an address and a count inside MAX_DATA_ADDRESS with its words, the last one ends the data
+
+static bool CheckRuns(const int64_t* runs, size_t numData){
+    for (size_t i = 0; i < numData; ){
+        if (numData - i < 2) return false;
+
+        int64_t address = runs[i];
+        int64_t count   = runs[i + 1];
+        int64_t size    = (count < 0) ? -count : count;
+
+        if (address < 0 || address >= MAX_DATA_ADDRESS || !count || size > MAX_DATA_ADDRESS - address) return false;
+
+        i += 2;
+        if (count < 0) continue;
+
+        if ((size_t)count > numData - i) return false;
+        i += (size_t)count;
+    }
+
+    return true;
+}
+
+static bool CheckEntry(const unitEntry_t* entry, size_t sizeLeft){
+    if (sizeLeft < sizeof(unitEntry_t) || entry->sizeEntry > sizeLeft || entry->sizeEntry % 8) return false;
+
+    size_t sizeFixed = sizeof(unitEntry_t) + (entry->numCommands + entry->numData) * SIZE_ARG + entry->numMarks * sizeof(lineMark_t) +
+                       entry->numLabels * sizeof(unitLabel_t) + entry->numFixups * sizeof(fixup_t);
+    if (sizeFixed > entry->sizeEntry) return false;
+
+    const int64_t*      runs   = (const int64_t*)((const char*)entry + sizeof(unitEntry_t)) + entry->numCommands;
+    const lineMark_t*   marks  = (const lineMark_t*)(runs + entry->numData);
+    const unitLabel_t* labels = (const unitLabel_t*)(marks + entry->numMarks);
+    if (!CheckRuns(runs, entry->numData)) return false;
+
+    for (size_t i = 0; i < entry->numMarks; i++){
+        if (marks[i].pc < 0 || (uint64_t)marks[i].pc >= entry->numCommands || marks[i].line <= 0) return false;
+    }
+
+    const fixup_t*      fixups = (const fixup_t*)(labels + entry->numLabels);
+    size_t sizeNames = 0;
+
+    for (size_t i = 0; i < entry->numLabels; i++) sizeNames += labels[i].nameSize;
+    if (sizeFixed + sizeNames > entry->sizeEntry) return false;
+
+    for (size_t i = 0; i < entry->numFixups; i++){
+        if (fixups[i].codeAdr < 0 || (uint64_t)fixups[i].codeAdr >= entry->numCommands)          return false;
+        if (fixups[i].labelNum < RELOCATION || fixups[i].labelNum >= (int64_t)entry->numLabels)  return false;
+    }
+
+    return true;
+}
+
+/*=======================================================================*/
+
+static errors ReadFile(const char* name, char** buffer, size_t* size){
+    FILE* file = fopen(name, "rb");
+    if (!file) return ERR;
+
+    struct stat st = {};
+    errors result  = ERR;
+
+    if (!fstat(fileno(file), &st) && st.st_size > 0){
+        *size   = (size_t)st.st_size;
+        *buffer = (char*)calloc(1, *size);
+
+        if (*buffer && fread(*buffer, 1, *size, file) == *size) result = OK;
+    }
+
+    fclose(file);
+
+    return result;
+}
+
+/*=======================================================================*/
+//a missing or broken cache is not an error, everything is assembled again
+
+static errors LoadCache(cache_t* cache){
+    if (ReadFile(cache->name, &cache->buffer, &cache->size) || cache->size < sizeof(unitsHeader_t)) return OK;
+
+    const unitsHeader_t* header = (const unitsHeader_t*)cache->buffer;
+    if (header->signature != CACHE_SIGNATURE || header->version != VERSION) return OK;
+
+    cache->sizeTable = MIN_LABELS;
+    while (cache->sizeTable < header->numEntries * 2) cache->sizeTable *= 2;
+
+    cache->table = (const char**)calloc(sizeof(const char*), cache->sizeTable);
+    if (!cache->table) return ERR_NULLPTR;
+
+    size_t offset = sizeof(unitsHeader_t);
+
+    for (size_t i = 0; i < header->numEntries; i++){
+        const unitEntry_t* entry = (const unitEntry_t*)(cache->buffer + offset);
+        if (!CheckEntry(entry, cache->size - offset)) break;
+
+        size_t slot = entry->hash & (cache->sizeTable - 1);
+        while (cache->table[slot]) slot = (slot + 1) & (cache->sizeTable - 1);
+
+        cache->table[slot] = (const char*)entry;
+        cache->numEntries++;
+        offset += entry->sizeEntry;
+    }
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static const char* FindCacheEntry(cache_t* cache, chunk_t* chunk){
+    if (!cache->sizeTable) return nullptr;
+
+    size_t mask = cache->sizeTable - 1;
+
+    for (size_t slot = chunk->hash & mask; cache->table[slot]; slot = (slot + 1) & mask){
+        const unitEntry_t* entry = (const unitEntry_t*)cache->table[slot];
+
+        if (entry->hash == chunk->hash && entry->sourceSize == chunk->size) return cache->table[slot];
+    }
+
+    return nullptr;
+}
+
+/*=======================================================================*/
+//new regions are appended, the file is rewritten once stale entries outnumber the live ones
+
+static errors UpdateCache(cache_t* cache, chunk_t* chunks, size_t numChunks){
+    size_t numMisses = 0;
+
+    for (size_t i = 0; i < numChunks; i++) if (!chunks[i].cached) numMisses++;
+
+    if (!numMisses) return OK;
+
+    bool  rewrite = !cache->numEntries || cache->numEntries + numMisses > numChunks * 2 + MIN_CHUNKS;
+    FILE* file    = fopen(cache->name, (rewrite) ? "wb" : "r+b");
+    if (!file) return ERR;
+
+    unitsHeader_t header = {CACHE_SIGNATURE, VERSION, 0};
+    header.numEntries = (rewrite) ? numChunks : cache->numEntries + numMisses;
+
+    fwrite(&header, sizeof(unitsHeader_t), 1, file);
+
+    if (!rewrite){
+        size_t offset = sizeof(unitsHeader_t);
+        for (size_t i = 0; i < cache->numEntries; i++) offset += ((const unitEntry_t*)(cache->buffer + offset))->sizeEntry;
+
+        fseek(file, (long)offset, SEEK_SET);
+    }
+
+    errors result = OK;
+
+    for (size_t i = 0; i < numChunks && !result; i++){
+        if (rewrite || !chunks[i].cached) result = WriteUnit(file, chunks + i);
+    }
+
+    if (fclose(file)) result = ERR;
+
+    return result;
+}
+
+/*=======================================================================*/
+//a reference before its local definition takes the latest earlier definition, or the last one overall
+
+static errors MergeLabels(commands_t* codeStruct, chunk_t* chunks, size_t numChunks){
+    for (size_t k = 0; k < numChunks; k++){
+        commands_t* unit = &chunks[k].unit;
+
+        chunks[k].labelValues = (int64_t*)calloc(sizeof(int64_t), unit->numElemsLabels + 1);
+        if (!chunks[k].labelValues) return ERR_NULLPTR;
+
+        for (size_t i = 0; i < unit->numElemsLabels; i++){
+            label_t* label  = unit->labelsPointer + i;
+            string_t name   = {label->nameSize, label->name};
+            int64_t  global = FindLabel(codeStruct, name);
+
+            if (global == -1) global = AddLabel(codeStruct, name);
+            if (global == -1) return ERR;
+
+            chunks[k].labelValues[i] = (codeStruct->labelsPointer + global)->addr;         //-1 - not defined yet
+        }
+
+        for (size_t i = 0; i < unit->numElemsLabels; i++){
+            label_t* label = unit->labelsPointer + i;
+            if (label->addr == -1) continue;
+
+            string_t name = {label->nameSize, label->name};
+            (codeStruct->labelsPointer + FindLabel(codeStruct, name))->addr = label->addr + (int64_t)chunks[k].base;
+        }
+    }
+
+    for (size_t k = 0; k < numChunks; k++){
+        commands_t* unit = &chunks[k].unit;
+
+        for (size_t i = 0; i < unit->numElemsLabels; i++){
+            if (chunks[k].labelValues[i] != -1) continue;
+
+            string_t name = {(unit->labelsPointer + i)->nameSize, (unit->labelsPointer + i)->name};
+            chunks[k].labelValues[i] = (codeStruct->labelsPointer + FindLabel(codeStruct, name))->addr;
+        }
+    }
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static size_t CountThreads(size_t numThreads){
+    if (!numThreads)              numThreads = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    if (!numThreads)              numThreads = 1;
+
+    return numThreads;
+}
+
+/*=======================================================================*/
+
+static errors AssembleChunks(commands_t* codeStruct, chunk_t* chunks, size_t numChunks, size_t numThreads, cache_t* cache){
+    bool relocatable = cache->name || codeStruct->fileNames->objectFileName;                //code may land anywhere
+
+    for (size_t i = 0; i < numChunks; i++){
+        chunks[i].unit.relocatable = (i > 0 || relocatable);
+        chunks[i].unit.name        = codeStruct->name;
+        chunks[i].unit.fileNames   = codeStruct->fileNames;
+        chunks[i].unit.logFile     = stdout;
+
+        if (cache->name){
+            chunks[i].hash   = HashSource(chunks[i].begin, chunks[i].size);
+            chunks[i].cached = FindCacheEntry(cache, chunks + i);
+        }
+
+        if (UnitCtor(&chunks[i].unit)) return ERR_NULLPTR;
+    }
+
+    RunChunks(chunks, numChunks, numThreads, CompileChunk);
+
+    size_t numLine = 0;
+
+    for (size_t i = 0; i < numChunks; i++){
+        commands_t* unit = &chunks[i].unit;
+
+        chunks[i].firstLine = numLine;
+        numLine += unit->numLine;
+
+        if (chunks[i].result){
+            if (unit->errorLine) printf(BRED "\nERROR: line %lu: %.*s\n\n" RESET, chunks[i].firstLine + unit->numLine,
+                                                                              (int)unit->errorLineSize, unit->errorLine);
+            CommandsDump(unit);
+            return ERR;
+        }
+    }
+
+    codeStruct->numLine = numLine;
+
+    return OK;
+}
+
+/*=======================================================================*/
+//line marks move with their chunk's code and lines, the file is the source or the object the chunk came from
+
+static errors MergeLines(commands_t* codeStruct, chunk_t* chunks, size_t numChunks){
+    for (size_t k = 0; k < numChunks; k++){
+        commands_t* unit = &chunks[k].unit;
+        const char* name = (chunks[k].fileName) ? chunks[k].fileName : codeStruct->fileNames->inputFileName;
+        uint64_t    file = 0;
+
+        while (file < codeStruct->numLineFiles && codeStruct->lineFiles[file] != name) file++;
+
+        if (file == codeStruct->numLineFiles){
+            const char** newFiles = (const char**)realloc(codeStruct->lineFiles, (file + 1) * sizeof(char*));
+            if (!newFiles) return ERR_NULLPTR;
+
+            codeStruct->lineFiles = newFiles;
+            codeStruct->lineFiles[codeStruct->numLineFiles++] = name;
+        }
+
+        for (size_t i = 0; i < unit->numMarks; i++){
+            const lineMark_t* mark = unit->linesPointer + i;
+
+            if (AddLineMark(codeStruct, mark->pc + (int64_t)chunks[k].base, mark->line + (int64_t)chunks[k].firstLine, file)){
+                return ERR_NULLPTR;
+            }
+        }
+    }
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static errors LinkChunks(commands_t* codeStruct, chunk_t* chunks, size_t numChunks, size_t numThreads){
+    size_t numCommands = 0;
+
+    for (size_t i = 0; i < numChunks; i++){
+        chunks[i].base = numCommands;
+        numCommands   += chunks[i].unit.pc;
+    }
+
+    if (numCommands * SIZE_ARG > codeStruct->sizeAllocated){
+        void* newCode = realloc(codeStruct->codePointer, numCommands * SIZE_ARG);
+        if (!newCode) return ERR_NULLPTR;
+
+        codeStruct->codePointer   = newCode;
+        codeStruct->sizeAllocated = numCommands * SIZE_ARG;
+    }
+
+    if (MergeLabels(codeStruct, chunks, numChunks)) return ERR;
+
+    for (size_t i = 0; i < numChunks; i++) chunks[i].code = (int64_t*)codeStruct->codePointer;
+
+    RunChunks(chunks, numChunks, numThreads, FixChunk);
+
+    for (size_t k = 0; k < numChunks; k++){                                                //runs keep source order
+        commands_t* unit = &chunks[k].unit;
+
+        for (size_t i = 0; i < unit->numData; i++){
+            if (EmitData(codeStruct, unit->dataPointer[i])) return ERR_NULLPTR;
+        }
+    }
+
+    if (MergeLines(codeStruct, chunks, numChunks)) return ERR_NULLPTR;
+
+    codeStruct->pc = numCommands;
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static void FreeChunks(chunk_t* chunks, size_t numChunks){
+    for (size_t i = 0; i < numChunks; i++){
+        UnitDtor(&chunks[i].unit);
+        free(chunks[i].labelValues);
+    }
+
+    free(chunks);
+}
+
+/*=======================================================================*/
+
+static errors WriteObject(commands_t* codeStruct, chunk_t* chunks, size_t numChunks){
+    FILE* file = fopen(codeStruct->fileNames->objectFileName, "wb");
+    if (!file) return ERR;
+
+    unitsHeader_t header = {OBJECT_SIGNATURE, VERSION, numChunks};
+    fwrite(&header, sizeof(unitsHeader_t), 1, file);
+
+    errors result = OK;
+
+    for (size_t i = 0; i < numChunks && !result; i++) result = WriteUnit(file, chunks + i);
+
+    if (fclose(file)) result = ERR;
+
+    return result;
+}
+
+/*=======================================================================*/
+
+static int CompareMarks(const void* first, const void* second){
+    const lineMark_t* a = (const lineMark_t*)first;
+    const lineMark_t* b = (const lineMark_t*)second;
+
+    if (a->pc != b->pc) return (a->pc > b->pc) - (a->pc < b->pc);
+
+    return (a->line > b->line) - (a->line < b->line);
+}
+
+/*=======================================================================*/
+//runs on the linked code, jump operands are turned back into instruction references
+//and resolved again once instructions have moved, labels follow their code
+
+static errors OptimizeLinked(commands_t* codeStruct, compileOptions_t* options){
+    optimizer_t opt     = {};
+    int64_t*    addrMap = (int64_t*)calloc(sizeof(int64_t), codeStruct->pc + 1);
+    int64_t*    newCode = nullptr;
+    size_t      newSize = 0;
+
+    bool        built   = addrMap && !OptimizerCtor(&opt, (int64_t*)codeStruct->codePointer, codeStruct->pc);
+
+    if (built && options->profileName && LoadProfile(&opt, options->profileName)){
+        printf(YEL "\nprofile \"%s\" ignored: missing or taken on other code, profile a build without -O\n\n" RESET,
+                   options->profileName);
+    }
+
+    if (!built || OptimizeCode(&opt) || EmitOptimized(&opt, &newCode, &newSize, addrMap)){
+
+        printf(YEL "\noptimizer skipped: jumps to unknown addresses or undecodable code\n\n" RESET);
+
+        OptimizerDtor(&opt);
+        free(addrMap);
+        return ERR;
+    }
+
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        label_t* label = codeStruct->labelsPointer + i;
+
+        if (label->addr >= 0 && (size_t)label->addr <= codeStruct->pc) label->addr = addrMap[label->addr];
+    }
+
+    size_t numMarks = 0;                                                                //laid out blocks move lines
+                                                                                        //out of order
+    for (size_t i = 0; i < codeStruct->numMarks; i++){
+        lineMark_t mark = codeStruct->linesPointer[i];
+        mark.pc = addrMap[mark.pc];
+
+        if (mark.pc >= 0) codeStruct->linesPointer[numMarks++] = mark;
+    }
+
+    codeStruct->numMarks = numMarks;
+    qsort(codeStruct->linesPointer, numMarks, sizeof(lineMark_t), CompareMarks);
+
+    free(codeStruct->codePointer);
+    codeStruct->codePointer   = newCode;
+    codeStruct->pc            = newSize;
+    codeStruct->sizeAllocated = (newSize + 1) * SIZE_ARG;
+
+    if (options->optReport) PrintOptReport(&opt.report, stdout);
+
+    OptimizerDtor(&opt);
+    free(addrMap);
+
+    return OK;
+}
+
+/*=======================================================================*/
+
+static void Compile(fileNames_t* fileNames, compileOptions_t* options){
+    commands_t codeStruct = {};
+    codeStruct.fileNames = fileNames;
+
+    if (CommandsCtor(&codeStruct, "mycode")){
+        CommandsDtor(&codeStruct);
+        return;
+    }
+
+    size_t      numThreads = CountThreads(options->numThreads);
+    const char* cacheName  = options->cacheName;
+
+    cache_t  cache      = {};
+    size_t   sizeChunks = MIN_CHUNKS;
+    chunk_t* chunks     = (chunk_t*)calloc(sizeof(chunk_t), sizeChunks);
+    size_t   numChunks  = 0;
+    bool     RunCommands = (chunks != nullptr);
+
+    cache.name = cacheName;
+    if (RunCommands && cacheName && LoadCache(&cache)) RunCommands = 0;
+
+    if (RunCommands){
+        numChunks = (cacheName) ? SplitRegions(&codeStruct, &chunks, &sizeChunks)
+                                : SplitChunks (&codeStruct, &chunks, &sizeChunks, numThreads);
+
+        if (!numChunks) RunCommands = 0;
+    }
+
+    if (RunCommands && AssembleChunks(&codeStruct, chunks, numChunks, numThreads, &cache)) RunCommands = 0;
+
+    if (RunCommands && cacheName && UpdateCache(&cache, chunks, numChunks)){
+        printf(BRED "\nERROR: can not write cache %s\n\n" RESET, cacheName);
+    }
+
+    if (RunCommands && fileNames->objectFileName){
+        if (WriteObject(&codeStruct, chunks, numChunks)){
+            printf(BRED "\nERROR: can not write %s\n\n" RESET, fileNames->objectFileName);
+        }
+
+        RunCommands = 0;
+    }
+
+    if (RunCommands && LinkChunks(&codeStruct, chunks, numChunks, numThreads)) RunCommands = 0;
+    if (RunCommands && options->optimize) OptimizeLinked(&codeStruct, options);
+
+    FreeChunks(chunks, numChunks);
+    free(cache.buffer);
+    free(cache.table);
+
+    if (!RunCommands){
+        CommandsDtor(&codeStruct);
+        return;
+    }
+
+    OutputCodeBin(&codeStruct);
+
+    PrintSignature(&codeStruct);
+    OutputCodeListing(&codeStruct);
+
+    CommandsDtor(&codeStruct);
+}
+
+/*=======================================================================*/
+
+static errors LoadObject(const char* name, char** buffer, chunk_t** chunks, size_t* numChunks, size_t* sizeChunks){
+    size_t size = 0;
+
+    if (ReadFile(name, buffer, &size)) return ERR;
+
+    const unitsHeader_t* header = (const unitsHeader_t*)*buffer;
+    if (size < sizeof(unitsHeader_t) || header->signature != OBJECT_SIGNATURE || header->version != VERSION) return ERR;
+
+    size_t offset = sizeof(unitsHeader_t);
+
+    for (size_t i = 0; i < header->numEntries; i++){
+        const unitEntry_t* entry = (const unitEntry_t*)(*buffer + offset);
+        if (!CheckEntry(entry, size - offset)) return ERR;
+
+        chunk_t* chunk = AddChunk(chunks, numChunks, sizeChunks, nullptr, 0);
+        if (!chunk) return ERR_NULLPTR;
+
+        chunk->cached   = (const char*)entry;
+        chunk->fileName = name;
+        offset += entry->sizeEntry;
+    }
+
+    return OK;
+}
+
+/*=======================================================================*/
+//unlike labels inside one source, a label exported by two objects is an error
+
+static errors CheckSymbols(chunk_t* chunks, size_t numChunks){
+    commands_t symbols = {};
+    errors     result  = (UnitCtor(&symbols)) ? ERR_NULLPTR : OK;
+
+    for (size_t k = 0; k < numChunks && !result; k++){
+        commands_t* unit = &chunks[k].unit;
+
+        for (size_t i = 0; i < unit->numElemsLabels && !result; i++){
+            label_t* label = unit->labelsPointer + i;
+            if (label->addr == -1) continue;
+
+            string_t name     = {label->nameSize, label->name};
+            int64_t  labelNum = FindLabel(&symbols, name);
+
+            if (labelNum == -1){
+                labelNum = AddLabel(&symbols, name);
+                if (labelNum == -1) result = ERR_NULLPTR;
+                else (symbols.labelsPointer + labelNum)->addr = (int64_t)k;
+
+                continue;
+            }
+
+            const char* firstFile = chunks[(symbols.labelsPointer + labelNum)->addr].fileName;
+
+            if (firstFile != chunks[k].fileName){
+                printf(BRED "\nERROR: label %s: defined in %s and %s\n\n" RESET, label->name, firstFile, chunks[k].fileName);
+                result = ERR;
+            }
+        }
+    }
+
+    UnitDtor(&symbols);
+
+    return result;
+}
+
+/*=======================================================================*/
+
+static errors CheckUndefined(commands_t* codeStruct){
+    errors result = OK;
+
+    for (size_t i = 0; i < codeStruct->numElemsLabels; i++){
+        if ((codeStruct->labelsPointer + i)->addr != -1) continue;
+
+        printf(BRED "\nERROR: undefined label %s\n\n" RESET, (codeStruct->labelsPointer + i)->name);
+        result = ERR;
+    }
+
+    return result;
+}
+
+/*=======================================================================*/
+
+static void Link(fileNames_t* fileNames, const char** objectNames, size_t numObjects, compileOptions_t* options){
+    commands_t codeStruct = {};
+    codeStruct.fileNames = fileNames;
+
+    if (CommandsCtor(&codeStruct, "linked")){
+        CommandsDtor(&codeStruct);
+        return;
+    }
+
+    size_t numThreads = CountThreads(options->numThreads);
+
+    char**   buffers    = (char**)calloc(sizeof(char*), numObjects + 1);
+    size_t   sizeChunks = MIN_CHUNKS;
+    chunk_t* chunks     = (chunk_t*)calloc(sizeof(chunk_t), sizeChunks);
+    size_t   numChunks  = 0;
+    bool     RunCommands = (chunks && buffers);
+
+    for (size_t i = 0; RunCommands && i < numObjects; i++){
+        if (LoadObject(objectNames[i], buffers + i, &chunks, &numChunks, &sizeChunks)){
+            printf(BRED "\nERROR: can not read object %s\n\n" RESET, objectNames[i]);
+            RunCommands = 0;
+        }
+    }
+
+    for (size_t i = 0; RunCommands && i < numChunks; i++){
+        chunks[i].unit.relocatable = true;
+        if (UnitCtor(&chunks[i].unit)) RunCommands = 0;
+    }
+
+    if (RunCommands){
+        RunChunks(chunks, numChunks, numThreads, CompileChunk);                        //every chunk is loaded, none parsed
+
+        size_t numLine = 0;
+
+        for (size_t i = 0; i < numChunks; i++){
+            if (chunks[i].result) RunCommands = 0;
+
+            if (i && chunks[i].fileName != chunks[i - 1].fileName) numLine = 0;        //lines count per object
+            chunks[i].firstLine = numLine;
+            numLine += chunks[i].unit.numLine;
+        }
+    }
+
+    if (RunCommands && CheckSymbols(chunks, numChunks))                      RunCommands = 0;
+    if (RunCommands && LinkChunks(&codeStruct, chunks, numChunks, numThreads)) RunCommands = 0;
+    if (RunCommands && CheckUndefined(&codeStruct))                          RunCommands = 0;
+    if (RunCommands && options->optimize) OptimizeLinked(&codeStruct, options);
+
+    FreeChunks(chunks, numChunks);
+
+    for (size_t i = 0; buffers && i < numObjects; i++) free(buffers[i]);
+    free(buffers);
+
+    if (!RunCommands){
+        CommandsDtor(&codeStruct);
+        return;
+    }
+
+    OutputCodeBin(&codeStruct);
+
+    PrintSignature(&codeStruct);
+    OutputCodeListing(&codeStruct);
+
+    CommandsDtor(&codeStruct);
+}
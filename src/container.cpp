@@ -0,0 +1,312 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "../hpp/container.hpp"
+
+const size_t MAX_VERIFY_THREADS = 64;
+
+typedef struct verifyBlock{
+    size_t      section;
+    size_t      index;
+} verifyBlock_t;
+
+typedef struct verifyPool{
+    container_t*    container;
+    verifyBlock_t*  blocks;
+    size_t          numBlocks;
+    size_t          next;                                   //taken atomically
+    uint64_t        sums[MAX_SECTIONS];                     //added to atomically
+} verifyPool_t;
+
+/*=================================================================*/
+//a checksum is the sum of its blocks' hashes, so blocks can be hashed in any order and on any thread
+
+static uint64_t BlockHash(const char* block, size_t size, size_t index){
+    uint64_t hash = (index + 1) * 0x9E3779B97F4A7C15;
+
+    for (size_t i = 0; i + 8 <= size; i += 8){
+        uint64_t word = 0;
+        memcpy(&word, block + i, 8);
+
+        hash  = (hash ^ word) * 0xFF51AFD7ED558CCD;
+        hash ^= hash >> 32;
+    }
+
+    return hash;
+}
+
+static inline size_t NumBlocks(size_t size){
+    return (size + CONTAINER_BLOCK - 1) / CONTAINER_BLOCK;
+}
+
+static inline size_t BlockSize(size_t size, size_t index){
+    size_t start = index * CONTAINER_BLOCK;
+
+    return (size - start < CONTAINER_BLOCK) ? size - start : CONTAINER_BLOCK;
+}
+
+uint64_t SectionChecksum(const void* data, size_t size){
+    uint64_t sum = size;
+
+    for (size_t i = 0; i < NumBlocks(size); i++){
+        sum += BlockHash((const char*)data + i * CONTAINER_BLOCK, BlockSize(size, i), i);
+    }
+
+    return sum;
+}
+
+/*=================================================================*/
+
+bool IsContainer(const void* image, size_t size){
+    if (!image || size < sizeof(containerHeader_t)) return false;
+
+    int64_t signature = 0;
+    memcpy(&signature, image, sizeof(signature));
+
+    return signature == CONTAINER_SIGNATURE;
+}
+
+//the header, then every section inside the file, page aligned, a multiple of 8 and of a type seen once
+static int CheckTable(container_t* container){
+    containerHeader_t header = {};
+    memcpy(&header, container->file, sizeof(header));
+
+    if (header.signature != CONTAINER_SIGNATURE || header.version != CONTAINER_VERSION) return -1;
+    if (header.numSections > MAX_SECTIONS || header.fileSize > container->size)          return -1;
+    if (sizeof(header) + header.numSections * sizeof(section_t) > CONTAINER_ALIGN)      return -1;
+    if (container->size < CONTAINER_ALIGN && header.numSections)                        return -1;
+
+    container->sections    = (const section_t*)(container->file + sizeof(header));
+    container->numSections = header.numSections;
+
+    bool seen[MAX_SECTIONS] = {};
+
+    for (size_t i = 0; i < container->numSections; i++){
+        const section_t* section = container->sections + i;
+
+        if (section->type < SECTION_CODE || section->type > SECTION_LINES || seen[section->type]) return -1;
+        seen[section->type] = true;
+
+        if (section->type == SECTION_ZERO){
+            if (section->offset) return -1;
+            continue;
+        }
+
+        if (section->size % 8 || section->offset % CONTAINER_ALIGN)                  return -1;
+        if (section->size && (section->offset < CONTAINER_ALIGN || section->offset > header.fileSize ||
+                              section->size > header.fileSize - section->offset))     return -1;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int ContainerMap(container_t* container, int fd){
+    if (!container) return -1;
+
+    *container = {};
+
+    struct stat st = {};
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(containerHeader_t)) return -1;
+
+    void* file = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (file == MAP_FAILED) return -1;
+
+    container->file   = (const char*)file;
+    container->size   = (size_t)st.st_size;
+    container->mapped = true;
+
+    if (CheckTable(container)){
+        ContainerClose(container);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int ContainerFromMemory(container_t* container, const void* image, size_t size){
+    if (!container) return -1;
+
+    *container = {};
+    if (!IsContainer(image, size)) return -1;
+
+    container->file = (const char*)image;
+    container->size = size;
+
+    if (CheckTable(container)){
+        *container = {};
+        return -1;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int ContainerClose(container_t* container){
+    if (!container) return -1;
+
+    if (container->mapped) munmap((void*)container->file, container->size);
+    *container = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+const section_t* ContainerFind(const container_t* container, sectionType type){
+    if (!container) return nullptr;
+
+    for (size_t i = 0; i < container->numSections; i++){
+        if (container->sections[i].type == (uint64_t)type) return container->sections + i;
+    }
+
+    return nullptr;
+}
+
+/*=================================================================*/
+
+const void* ContainerSection(container_t* container, sectionType type, size_t* size){
+    const section_t* section = ContainerFind(container, type);
+    if (!section || type == SECTION_ZERO) return nullptr;
+
+    size_t      i     = (size_t)(section - container->sections);
+    const char* bytes = (section->size) ? container->file + section->offset : container->file;
+
+    if (!__atomic_load_n(container->verified + i, __ATOMIC_ACQUIRE)){
+        if (SectionChecksum(bytes, section->size) != section->checksum) return nullptr;
+
+        __atomic_store_n(container->verified + i, true, __ATOMIC_RELEASE);
+    }
+
+    if (size) *size = section->size;
+
+    return bytes;
+}
+
+/*=================================================================*/
+
+static void* VerifyWorker(void* arg){
+    verifyPool_t* pool = (verifyPool_t*)arg;
+
+    while (true){
+        size_t i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (i >= pool->numBlocks) break;
+
+        const verifyBlock_t* block   = pool->blocks + i;
+        const section_t*     section = pool->container->sections + block->section;
+        const char*          start   = pool->container->file + section->offset + block->index * CONTAINER_BLOCK;
+
+        uint64_t hash = BlockHash(start, BlockSize(section->size, block->index), block->index);
+        __atomic_fetch_add(pool->sums + block->section, hash, __ATOMIC_RELAXED);
+    }
+
+    return nullptr;
+}
+
+int ContainerVerify(container_t* container, size_t numThreads){
+    if (!container) return -1;
+
+    verifyPool_t pool = {};
+    pool.container = container;
+
+    for (size_t i = 0; i < container->numSections; i++){
+        if (container->sections[i].type != SECTION_ZERO) pool.numBlocks += NumBlocks(container->sections[i].size);
+    }
+
+    pool.blocks = (verifyBlock_t*)calloc(sizeof(verifyBlock_t), pool.numBlocks + 1);
+    if (!pool.blocks) return -1;
+
+    size_t numBlocks = 0;
+
+    for (size_t i = 0; i < container->numSections; i++){
+        const section_t* section = container->sections + i;
+        if (section->type == SECTION_ZERO || container->verified[i]) continue;
+
+        pool.sums[i] = section->size;
+        for (size_t k = 0; k < NumBlocks(section->size); k++) pool.blocks[numBlocks++] = {i, k};
+    }
+
+    pool.numBlocks = numBlocks;
+
+    if (!numThreads)                      numThreads = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads > MAX_VERIFY_THREADS)  numThreads = MAX_VERIFY_THREADS;
+    if (numThreads > numBlocks)           numThreads = numBlocks;
+
+    pthread_t threads[MAX_VERIFY_THREADS] = {};
+    bool      started[MAX_VERIFY_THREADS] = {};
+
+    for (size_t i = 1; i < numThreads; i++) started[i] = !pthread_create(threads + i, nullptr, VerifyWorker, &pool);
+
+    VerifyWorker(&pool);
+
+    for (size_t i = 1; i < numThreads; i++) if (started[i]) pthread_join(threads[i], nullptr);
+
+    int status = 0;
+
+    for (size_t i = 0; i < container->numSections; i++){
+        const section_t* section = container->sections + i;
+        if (section->type == SECTION_ZERO || container->verified[i]) continue;
+
+        if (pool.sums[i] == section->checksum) container->verified[i] = true;
+        else                                   status = -1;
+    }
+
+    free(pool.blocks);
+
+    return status;
+}
+
+/*=================================================================*/
+
+static void Pad(FILE* file, size_t size){
+    static const char zeros[CONTAINER_ALIGN] = {};
+
+    fwrite(zeros, 1, size, file);
+}
+
+int ContainerWrite(FILE* file, const sectionData_t* sections, size_t numSections){
+    if (!file || numSections > MAX_SECTIONS) return -1;
+
+    containerHeader_t header = {CONTAINER_SIGNATURE, CONTAINER_VERSION, numSections, 0};
+    section_t         table[MAX_SECTIONS] = {};
+    size_t            offset = CONTAINER_ALIGN;
+
+    for (size_t i = 0; i < numSections; i++){
+        const sectionData_t* data = sections + i;
+
+        table[i].type    = data->type;
+        table[i].size    = data->size;
+        table[i].address = data->address;
+
+        if (data->type == SECTION_ZERO) continue;
+        if (data->size % 8)             return -1;
+
+        table[i].checksum = SectionChecksum(data->data, data->size);
+        if (!data->size) continue;
+
+        table[i].offset = offset;
+        offset += (data->size + CONTAINER_ALIGN - 1) / CONTAINER_ALIGN * CONTAINER_ALIGN;
+    }
+
+    header.fileSize = offset;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(table, sizeof(section_t), numSections, file);
+    Pad(file, CONTAINER_ALIGN - sizeof(header) - numSections * sizeof(section_t));
+
+    for (size_t i = 0; i < numSections; i++){
+        if (!table[i].offset) continue;
+
+        fwrite(sections[i].data, 1, sections[i].size, file);
+        Pad(file, (CONTAINER_ALIGN - sections[i].size % CONTAINER_ALIGN) % CONTAINER_ALIGN);
+    }
+
+    return (ferror(file)) ? -1 : 0;
+}
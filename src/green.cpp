@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/green.hpp"
+
+const int64_t GREEN_SLOT_MASK = 0xFFFFFFFF;
+
+/*=================================================================*/
+
+int GreenCtor(green_t* green, size_t* pc, void** registers, Stack_t** stk, Stack_t** returnStack){
+    if (!green || !pc || !registers || !stk || !returnStack) return -1;
+
+    *green = {};
+    green->pc          = pc;
+    green->registers   = registers;
+    green->stk         = stk;
+    green->returnStack = returnStack;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int GreenDtor(green_t* green){
+    if (!green) return -1;
+
+    if (green->numThreads){
+        greenThread_t* first = green->threads[0];
+
+        *green->registers   = first->registers;
+        *green->stk         = first->stk;
+        *green->returnStack = first->returnStack;
+    }
+
+    for (size_t slot = 1; slot < green->numThreads; slot++){
+        greenThread_t* thread = green->threads[slot];
+
+        if (thread->live){
+            StackDtor(thread->stk);
+            StackDtor(thread->returnStack);
+        }
+
+        free(thread->stk);
+        free(thread->returnStack);
+        free(thread);
+    }
+
+    if (green->numThreads) free(green->threads[0]);
+
+    free(green->threads);
+    free(green->runQueue);
+    free(green->freeSlots);
+
+    green->threads    = nullptr;
+    green->runQueue   = nullptr;
+    green->freeSlots  = nullptr;
+    green->numThreads = 0;
+
+    return 0;
+}
+
+/*=================================================================*/
+//slots, the run queue and the free list grow together, the ring is unrolled into the new one
+
+static int Grow(green_t* green){
+    size_t newSize = (green->sizeThreads) ? green->sizeThreads * 2 : GREEN_MIN_SLOTS;
+
+    greenThread_t** threads   = (greenThread_t**)realloc(green->threads, sizeof(greenThread_t*) * newSize);
+    if (!threads) return -1;
+    green->threads = threads;
+
+    uint32_t* runQueue  = (uint32_t*)calloc(sizeof(uint32_t), newSize);
+    uint32_t* freeSlots = (uint32_t*)realloc(green->freeSlots, sizeof(uint32_t) * newSize);
+    if (!runQueue || !freeSlots){
+        free(runQueue);
+        if (freeSlots) green->freeSlots = freeSlots;
+        return -1;
+    }
+
+    for (size_t i = 0; i < green->numRunnable; i++){
+        runQueue[i] = green->runQueue[(green->runHead + i) % green->sizeThreads];
+    }
+
+    free(green->runQueue);
+    green->runQueue    = runQueue;
+    green->runHead     = 0;
+    green->freeSlots   = freeSlots;
+    green->sizeThreads = newSize;
+
+    return 0;
+}
+
+static inline void Enqueue(green_t* green, uint32_t slot){
+    green->runQueue[(green->runHead + green->numRunnable++) % green->sizeThreads] = slot;
+}
+
+static inline uint32_t Dequeue(green_t* green){
+    uint32_t slot = green->runQueue[green->runHead];
+
+    green->runHead = (green->runHead + 1) % green->sizeThreads;
+    green->numRunnable--;
+
+    return slot;
+}
+
+/*=================================================================*/
+//the whole context switch
+
+static inline void SwitchTo(green_t* green, uint32_t slot){
+    green->threads[green->current]->pc = *green->pc;
+
+    greenThread_t* next = green->threads[slot];
+
+    *green->pc          = next->pc;
+    *green->registers   = next->registers;
+    *green->stk         = next->stk;
+    *green->returnStack = next->returnStack;
+
+    green->current = slot;
+    green->stats.switches++;
+}
+
+/*=================================================================*/
+//slot 0 takes over what the processor already runs on
+
+static greenResult Adopt(green_t* green){
+    if (Grow(green)) return GREEN_NO_MEMORY;
+
+    greenThread_t* first = (greenThread_t*)calloc(sizeof(greenThread_t), 1);
+    if (!first) return GREEN_NO_MEMORY;
+
+    first->registers   = (int64_t*)*green->registers;
+    first->stk         = *green->stk;
+    first->returnStack = *green->returnStack;
+    first->live        = true;
+    first->waiters     = GREEN_NONE;
+
+    green->threads[0] = first;
+    green->numThreads = 1;
+    green->numLive    = 1;
+    green->current    = 0;
+
+    return GREEN_OK;
+}
+
+static greenThread_t* NewThread(green_t* green, uint32_t* slot){
+    if (green->numFree){
+        *slot = green->freeSlots[--green->numFree];
+        return green->threads[*slot];
+    }
+
+    if (green->numThreads == green->sizeThreads && Grow(green)) return nullptr;
+
+    greenThread_t* thread = (greenThread_t*)calloc(sizeof(greenThread_t), 1);
+    if (!thread) return nullptr;
+
+    thread->stk         = (Stack_t*)calloc(sizeof(Stack_t), 1);
+    thread->returnStack = (Stack_t*)calloc(sizeof(Stack_t), 1);
+    thread->registers   = thread->ownRegisters;
+
+    if (!thread->stk || !thread->returnStack){
+        free(thread->stk);
+        free(thread->returnStack);
+        free(thread);
+        return nullptr;
+    }
+
+    *slot = (uint32_t)green->numThreads;
+    green->threads[green->numThreads++] = thread;
+
+    return thread;
+}
+
+/*=================================================================*/
+
+greenResult GreenSpawn(green_t* green, size_t target, int64_t* id){
+    if (!green || !id) return GREEN_NO_MEMORY;
+    if (!green->numThreads && Adopt(green)) return GREEN_NO_MEMORY;
+
+    uint32_t       slot   = 0;
+    greenThread_t* thread = NewThread(green, &slot);
+    if (!thread) return GREEN_NO_MEMORY;
+
+    StackCtor(thread->stk);
+    StackCtor(thread->returnStack);
+    memcpy(thread->ownRegisters, *green->registers, sizeof(thread->ownRegisters));
+
+    thread->pc         = target;
+    thread->live       = true;
+    thread->waiters    = GREEN_NONE;
+    thread->nextWaiter = GREEN_NONE;
+
+    Enqueue(green, slot);
+
+    green->numLive++;
+    green->stats.spawned++;
+    if (green->numLive > green->stats.maxLive) green->stats.maxLive = green->numLive;
+
+    *id = ((int64_t)thread->generation << 32) | slot;
+
+    return GREEN_OK;
+}
+
+/*=================================================================*/
+
+greenResult GreenYield(green_t* green){
+    if (!green || !green->numRunnable) return GREEN_OK;
+
+    Enqueue(green, green->current);
+    SwitchTo(green, Dequeue(green));
+
+    return GREEN_OK;
+}
+
+/*=================================================================*/
+//a finished thread or one from an older generation of the slot is joined at once
+
+greenResult GreenJoin(green_t* green, int64_t id){
+    if (!green || id < 0) return GREEN_BAD_ID;
+
+    size_t   slot       = (size_t)(id & GREEN_SLOT_MASK);
+    uint32_t generation = (uint32_t)(id >> 32);
+
+    if (!green->numThreads) return (id == 0) ? GREEN_DEADLOCK : GREEN_BAD_ID;
+    if (slot >= green->numThreads) return GREEN_BAD_ID;
+
+    greenThread_t* target = green->threads[slot];
+    if (!target->live || target->generation != generation) return GREEN_OK;
+
+    if (slot == green->current || !green->numRunnable) return GREEN_DEADLOCK;
+
+    greenThread_t* current = green->threads[green->current];
+    current->nextWaiter = target->waiters;
+    target->waiters     = green->current;
+
+    green->stats.joinsWaited++;
+    SwitchTo(green, Dequeue(green));
+
+    return GREEN_OK;
+}
+
+/*=================================================================*/
+
+greenResult GreenExit(green_t* green){
+    if (!green || !green->numThreads) return GREEN_DONE;
+
+    uint32_t       slot   = green->current;
+    greenThread_t* thread = green->threads[slot];
+
+    for (uint32_t waiter = thread->waiters; waiter != GREEN_NONE; waiter = green->threads[waiter]->nextWaiter){
+        Enqueue(green, waiter);
+    }
+
+    thread->live    = false;
+    thread->waiters = GREEN_NONE;
+    green->numLive--;
+
+    if (slot){                                                              //slot 0's stacks are the processor's
+        StackDtor(thread->stk);
+        StackDtor(thread->returnStack);
+
+        thread->generation++;
+        green->freeSlots[green->numFree++] = slot;
+    }
+
+    if (!green->numRunnable) return GREEN_DONE;
+
+    SwitchTo(green, Dequeue(green));
+
+    return GREEN_OK;
+}
+
+/*=================================================================*/
+
+void PrintGreenStats(const green_t* green, FILE* file){
+    if (!green || !green->stats.spawned) return;
+
+    fprintf(file, "green: %lu threads spawned, %lu at most alive, %lu switches, %lu joins waited\n",
+                  green->stats.spawned, green->stats.maxLive, green->stats.switches, green->stats.joinsWaited);
+}
@@ -0,0 +1,665 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "../hpp/jit.hpp"
+#include "../hpp/operations.hpp"
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define JIT_X86_64
+#endif
+
+/*=================================================================*/
+
+static inline bool IsBackJumpOp(int64_t op){
+    return op == JMP || op == JA || op == JAE || op == JE || op == JNE;
+}
+
+static inline bool IsTraceableOp(int64_t op){
+    switch (op){
+        case PUSH:  case POP:
+        case ADD:   case SUB:   case MUL:   case DIV:   case MOD:
+        case LS_EQ: case MR_EQ: case EQL:   case LS:    case MR:
+        case OUT:
+        case JMP:   case JA:    case JAE:   case JE:    case JNE:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/*=================================================================*/
+
+static void FreeTrace(trace_t* trace){
+    if (!trace) return;
+
+#ifdef JIT_X86_64
+    if (trace->native) munmap(trace->native, trace->nativeSize);
+#endif
+
+    free(trace->exits);
+    free(trace->values);
+    free(trace);
+}
+
+#ifdef JIT_X86_64
+
+/*=================================================================*/
+//just enough of x86-64: values live in rax/rcx, the trace frame is [r13], registers [rbx], RAM [r12], state r14
+
+enum x86Reg{
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSI = 6,
+    RDI = 7,
+    R12 = 12,
+    R13 = 13,
+    R14 = 14
+};
+
+typedef struct asmBuffer{
+    uint8_t*    bytes;
+    size_t      size;
+    size_t      capacity;
+    bool        failed;
+} asmBuffer_t;
+
+static void EmitBytes(asmBuffer_t* buf, const void* bytes, size_t n){
+    if (buf->failed) return;
+
+    if (buf->size + n > buf->capacity){
+        size_t   capacity = (buf->capacity) ? buf->capacity * 2 : 4096;
+        uint8_t* newBytes = (uint8_t*)realloc(buf->bytes, capacity);
+
+        if (!newBytes){
+            buf->failed = true;
+            return;
+        }
+
+        buf->bytes    = newBytes;
+        buf->capacity = capacity;
+    }
+
+    memcpy(buf->bytes + buf->size, bytes, n);
+    buf->size += n;
+}
+
+static inline void EmitByte(asmBuffer_t* buf, uint8_t byte){
+    EmitBytes(buf, &byte, 1);
+}
+
+static inline void EmitU32(asmBuffer_t* buf, uint32_t value){
+    EmitBytes(buf, &value, sizeof(value));
+}
+
+static inline void Patch32(asmBuffer_t* buf, size_t at, size_t target){      //rel32 ending at at + 4
+    if (buf->failed) return;
+
+    int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+    memcpy(buf->bytes + at, &rel, sizeof(rel));
+}
+
+/*=================================================================*/
+//op reg, qword [base + disp32]
+
+static void EmitMem(asmBuffer_t* buf, uint8_t opcode, uint8_t reg, uint8_t base, int32_t disp){
+    EmitByte(buf, (uint8_t)(0x48 | ((reg & 8) ? 4 : 0) | ((base & 8) ? 1 : 0)));
+    EmitByte(buf, opcode);
+    EmitByte(buf, (uint8_t)(0x80 | ((reg & 7) << 3) | (base & 7)));
+    if ((base & 7) == 4) EmitByte(buf, 0x24);                               //r12 needs a sib
+
+    EmitU32(buf, (uint32_t)disp);
+}
+
+static inline void EmitLoad(asmBuffer_t* buf, uint8_t reg, uint8_t base, int32_t disp){
+    EmitMem(buf, 0x8B, reg, base, disp);
+}
+
+static inline void EmitStore(asmBuffer_t* buf, uint8_t base, int32_t disp, uint8_t reg){
+    EmitMem(buf, 0x89, reg, base, disp);
+}
+
+static void EmitMovImm(asmBuffer_t* buf, uint8_t reg, int64_t imm){
+    if (imm >= INT32_MIN && imm <= INT32_MAX){                              //mov r64, simm32
+        const uint8_t bytes[] = {0x48, 0xC7, (uint8_t)(0xC0 | reg)};
+        EmitBytes(buf, bytes, sizeof(bytes));
+        EmitU32(buf, (uint32_t)imm);
+        return;
+    }
+
+    EmitByte(buf, 0x48);
+    EmitByte(buf, (uint8_t)(0xB8 | reg));
+    EmitBytes(buf, &imm, sizeof(imm));
+}
+
+static inline void EmitRegReg(asmBuffer_t* buf, uint8_t opcode, uint8_t dst, uint8_t src){     //op dst, src
+    const uint8_t bytes[] = {0x48, opcode, (uint8_t)(0xC0 | (src << 3) | dst)};
+    EmitBytes(buf, bytes, sizeof(bytes));
+}
+
+static void EmitCall(asmBuffer_t* buf, uintptr_t function){
+    EmitMovImm(buf, RAX, (int64_t)function);
+
+    const uint8_t callRax[] = {0xFF, 0xD0};
+    EmitBytes(buf, callRax, sizeof(callRax));
+}
+
+static size_t EmitJcc(asmBuffer_t* buf, uint8_t cc){                       //returns where rel32 goes
+    const uint8_t bytes[] = {0x0F, cc};
+    EmitBytes(buf, bytes, sizeof(bytes));
+    EmitU32(buf, 0);
+
+    return buf->size - 4;
+}
+
+/*=================================================================*/
+
+static void JitOut(FILE* outputFile, int64_t value){
+    fprintf(outputFile, "%lld\n", value);
+}
+
+/*=================================================================*/
+
+typedef struct traceCompiler{
+    asmBuffer_t     buf;
+
+    traceValue_t    stack[JIT_MAX_DEPTH];
+    size_t          depth;
+
+    traceExit_t*    exits;
+    size_t*         exitJumps;                              //rel32 of the guard that leaves through the exit
+    size_t          numExits;
+    size_t          loopFirst;                              //pcs the trace runs through, an exit to one is a failed guard
+    size_t          loopLast;
+
+    traceValue_t*   values;
+    size_t          numValues;
+} traceCompiler_t;
+
+static int PushRax(traceCompiler_t* tc){
+    if (tc->depth >= JIT_MAX_DEPTH) return -1;
+
+    EmitStore(&tc->buf, R13, (int32_t)(tc->depth * sizeof(int64_t)), RAX);
+    tc->stack[tc->depth++] = {false, 0};
+
+    return 0;
+}
+
+static int PushConst(traceCompiler_t* tc, int64_t value){
+    if (tc->depth >= JIT_MAX_DEPTH) return -1;
+
+    tc->stack[tc->depth++] = {true, value};
+
+    return 0;
+}
+
+static int PopTo(traceCompiler_t* tc, uint8_t reg, traceValue_t* value){
+    if (!tc->depth) return -1;                                              //below the stack the loop started with
+
+    *value = tc->stack[--tc->depth];
+
+    if (value->isConst) EmitMovImm(&tc->buf, reg, value->value);
+    else                EmitLoad  (&tc->buf, reg, R13, (int32_t)(tc->depth * sizeof(int64_t)));
+
+    return 0;
+}
+
+static int AddExit(traceCompiler_t* tc, size_t pc, size_t pos, uint8_t cc){
+    traceExit_t* exit = tc->exits + tc->numExits;
+
+    exit->pc         = pc;
+    exit->depth      = tc->depth;
+    exit->firstValue = tc->numValues;
+    exit->pos        = pos;
+    exit->inLoop     = (pc >= tc->loopFirst && pc <= tc->loopLast);
+
+    memcpy(tc->values + tc->numValues, tc->stack, sizeof(traceValue_t) * tc->depth);
+    tc->numValues += tc->depth;
+
+    tc->exitJumps[tc->numExits++] = EmitJcc(&tc->buf, cc);
+
+    return 0;
+}
+
+/*=================================================================*/
+//first - the top of the stack
+
+static bool FoldBinary(int64_t op, int64_t first, int64_t second, int64_t* result){
+    uint64_t x = (uint64_t)first, y = (uint64_t)second;
+
+    switch (op){
+        case ADD:   *result = (int64_t)(x + y);     return true;
+        case SUB:   *result = (int64_t)(x - y);     return true;
+        case MUL:   *result = (int64_t)(x * y);     return true;
+
+        case DIV:
+        case MOD:
+            if (second == 0 || (first == INT64_MIN && second == -1)) return false;
+
+            *result = (op == DIV) ? first / second : first % second;
+            return true;
+
+        case LS_EQ: *result = (first <= second);    return true;
+        case MR_EQ: *result = (first >= second);    return true;
+        case EQL:   *result = (first == second);    return true;
+        case LS:    *result = (first <  second);    return true;
+        case MR:    *result = (first >  second);    return true;
+
+        default:    return false;
+    }
+}
+
+static uint8_t SetccCode(int64_t op){
+    switch (op){
+        case LS_EQ: return 0x9E;                                            //setle
+        case MR_EQ: return 0x9D;                                            //setge
+        case EQL:   return 0x94;                                            //sete
+        case LS:    return 0x9C;                                            //setl
+        case MR:
+        default:    return 0x9F;                                            //setg
+    }
+}
+
+static int CompileBinary(traceCompiler_t* tc, int64_t op){
+    if (tc->depth < 2) return -1;
+
+    traceValue_t first  = tc->stack[tc->depth - 1];
+    traceValue_t second = tc->stack[tc->depth - 2];
+    int64_t      result = 0;
+
+    if (first.isConst && second.isConst && FoldBinary(op, first.value, second.value, &result)){
+        tc->depth -= 2;
+        return PushConst(tc, result);
+    }
+
+    PopTo(tc, RAX, &first);
+    PopTo(tc, RCX, &second);
+
+    asmBuffer_t* buf = &tc->buf;
+
+    switch (op){
+        case ADD:   EmitRegReg(buf, 0x01, RAX, RCX);                        break;
+        case SUB:   EmitRegReg(buf, 0x29, RAX, RCX);                        break;
+
+        case MUL:{
+            const uint8_t imul[] = {0x48, 0x0F, 0xAF, 0xC1};                //imul rax, rcx
+            EmitBytes(buf, imul, sizeof(imul));
+            break;
+        }
+
+        case DIV:
+        case MOD:{
+            const uint8_t idiv[] = {0x48, 0x99, 0x48, 0xF7, 0xF9};          //cqo; idiv rcx
+            EmitBytes(buf, idiv, sizeof(idiv));
+
+            if (op == MOD) EmitRegReg(buf, 0x89, RAX, RDX);
+            break;
+        }
+
+        default:{
+            EmitRegReg(buf, 0x39, RAX, RCX);                                //cmp rax, rcx
+
+            const uint8_t setcc[] = {0x0F, SetccCode(op), 0xC0, 0x0F, 0xB6, 0xC0};     //setcc al; movzx eax, al
+            EmitBytes(buf, setcc, sizeof(setcc));
+            break;
+        }
+    }
+
+    return PushRax(tc);
+}
+
+/*=================================================================*/
+//same effects as GetPopValue(): imm and reg + imm go through registers[0]
+
+static int CompilePushPop(traceCompiler_t* tc, const int64_t* code, size_t pc){
+    asmBuffer_t* buf     = &tc->buf;
+    int64_t      command = code[pc];
+    bool         hasReg  = command & registerMask;
+    bool         hasImm  = command & immediateMask;
+    bool         hasMem  = command & memoryMask;
+    bool         isPush  = (command & OPERATOR_MASK) == PUSH;
+    size_t       at      = pc + 1;
+    int64_t      reg     = 0;
+    int64_t      imm     = 0;
+    traceValue_t value   = {};
+
+    if (!hasReg && !hasImm) return -1;
+
+    if (hasReg){
+        reg = code[at++];
+        if (reg < 0 || reg > REGISTER_NUM) return -1;
+
+        EmitLoad(buf, RCX, RBX, (int32_t)((size_t)reg * sizeof(int64_t)));
+    }
+
+    if (hasImm){
+        imm = code[at++];
+
+        if (hasReg){
+            EmitMovImm(buf, RDX, imm);
+            EmitRegReg(buf, 0x01, RCX, RDX);                                //add rcx, rdx
+        }
+
+        else EmitMovImm(buf, RCX, imm);
+
+        EmitStore(buf, RBX, 0, RCX);
+    }
+
+    if (hasMem){                                                            //RAM[rcx]
+        const uint8_t loadRam[]  = {0x49, 0x8B, 0x04, 0xCC};                //mov rax, [r12 + rcx * 8]
+        const uint8_t storeRam[] = {0x49, 0x89, 0x04, 0xCC};                //mov [r12 + rcx * 8], rax
+
+        if (isPush){
+            EmitBytes(buf, loadRam, sizeof(loadRam));
+            return PushRax(tc);
+        }
+
+        if (PopTo(tc, RAX, &value)) return -1;
+        EmitBytes(buf, storeRam, sizeof(storeRam));
+
+        return 0;
+    }
+
+    if (isPush){
+        if (hasImm && !hasReg) return PushConst(tc, imm);
+
+        EmitRegReg(buf, 0x89, RAX, RCX);                                    //mov rax, rcx
+        return PushRax(tc);
+    }
+
+    if (PopTo(tc, RAX, &value)) return -1;
+    EmitStore(buf, RBX, (int32_t)((size_t)(hasImm ? 0 : reg) * sizeof(int64_t)), RAX);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static uint8_t JumpCode(int64_t op, bool inverse){
+    switch (op){                                                            //signed, first is the top
+        case JA:    return (inverse) ? 0x8E : 0x8F;                         //jle : jg
+        case JAE:   return (inverse) ? 0x8C : 0x8D;                         //jl  : jge
+        case JE:    return (inverse) ? 0x85 : 0x84;                         //jne : je
+        case JNE:
+        default:    return (inverse) ? 0x84 : 0x85;                         //je  : jne
+    }
+}
+
+static int CompileStep(traceCompiler_t* tc, const int64_t* code, const traceStep_t* step, size_t pos){
+    int64_t command = code[step->pc];
+    int64_t op      = command & OPERATOR_MASK;
+
+    switch (op){
+        case PUSH:
+        case POP:   return CompilePushPop(tc, code, step->pc);
+
+        case ADD:   case SUB:   case MUL:   case DIV:   case MOD:
+        case LS_EQ: case MR_EQ: case EQL:   case LS:    case MR:
+                    return CompileBinary(tc, op);
+
+        case OUT:{
+            traceValue_t value = {};
+            if (PopTo(tc, RSI, &value)) return -1;
+
+            EmitLoad(&tc->buf, RDI, R14, (int32_t)offsetof(jitState_t, outputFile));
+            EmitCall(&tc->buf, (uintptr_t)&JitOut);
+            return 0;
+        }
+
+        case JMP:   return 0;                                               //the trace goes on at the target
+
+        case JA:    case JAE:   case JE:    case JNE:{
+            traceValue_t first = {}, second = {};
+            if (PopTo(tc, RAX, &first) || PopTo(tc, RCX, &second)) return -1;
+
+            size_t target = (size_t)code[step->pc + 1];
+            size_t fall   = step->pc + 2;
+
+            if (target == fall) return 0;
+
+            EmitRegReg(&tc->buf, 0x39, RAX, RCX);
+
+            if (step->nextPc == target) AddExit(tc, fall,   pos + 1, JumpCode(op, true));     //taken on the trace, leave when it is not
+            else                        AddExit(tc, target, pos + 1, JumpCode(op, false));
+
+            return 0;
+        }
+
+        default:    return -1;
+    }
+}
+
+/*=================================================================*/
+
+static trace_t* CompileTrace(jit_t* jit){
+    size_t numSteps = jit->numSteps;
+
+    traceCompiler_t tc = {};
+    tc.exits     = (traceExit_t*) calloc(sizeof(traceExit_t),  numSteps + 1);
+    tc.exitJumps = (size_t*)      calloc(sizeof(size_t),       numSteps + 1);
+    tc.values    = (traceValue_t*)calloc(sizeof(traceValue_t), (numSteps + 1) * JIT_MAX_DEPTH);
+
+    trace_t* trace = (trace_t*)calloc(sizeof(trace_t), 1);
+    int      status = (tc.exits && tc.exitJumps && tc.values && trace) ? 0 : -1;
+
+    tc.loopFirst = jit->recordStart;
+    tc.loopLast  = jit->recordStart;
+
+    for (size_t i = 0; i < numSteps; i++){
+        if (jit->steps[i].pc < tc.loopFirst) tc.loopFirst = jit->steps[i].pc;
+        if (jit->steps[i].pc > tc.loopLast)  tc.loopLast  = jit->steps[i].pc;
+    }
+
+    const uint8_t prologue[] = {0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57,      //push rbx, r12..r15
+                                0x49, 0x89, 0xFE};                                          //mov r14, rdi
+    const uint8_t epilogue[] = {0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3};
+
+    EmitBytes(&tc.buf, prologue, sizeof(prologue));
+    EmitLoad (&tc.buf, RBX, R14, (int32_t)offsetof(jitState_t, registers));
+    EmitLoad (&tc.buf, R12, R14, (int32_t)offsetof(jitState_t, RAM));
+    EmitLoad (&tc.buf, R13, R14, (int32_t)offsetof(jitState_t, frame));
+
+    size_t loopTop = tc.buf.size;
+
+    for (size_t i = 0; !status && i < numSteps; i++){
+        status = CompileStep(&tc, jit->code, jit->steps + i, i);
+    }
+
+    if (tc.depth) status = -1;                                              //every iteration has to leave the stack as it was
+
+    const uint8_t incIterations[] = {0x49, 0xFF, 0x86};                     //inc qword [r14 + disp32]
+    EmitBytes(&tc.buf, incIterations, sizeof(incIterations));
+    EmitU32  (&tc.buf, (uint32_t)offsetof(jitState_t, iterations));
+
+    EmitByte (&tc.buf, 0xE9);                                               //jmp loopTop
+    EmitU32  (&tc.buf, 0);
+    Patch32  (&tc.buf, tc.buf.size - 4, loopTop);
+
+    size_t epilogueAt = tc.buf.size;
+    EmitBytes(&tc.buf, epilogue, sizeof(epilogue));
+
+    for (size_t k = 0; k < tc.numExits; k++){                               //mov eax, k; jmp epilogue
+        Patch32 (&tc.buf, tc.exitJumps[k], tc.buf.size);
+
+        EmitByte(&tc.buf, 0xB8);
+        EmitU32 (&tc.buf, (uint32_t)k);
+        EmitByte(&tc.buf, 0xE9);
+        EmitU32 (&tc.buf, 0);
+        Patch32 (&tc.buf, tc.buf.size - 4, epilogueAt);
+    }
+
+    if (tc.buf.failed || !tc.numExits) status = -1;                        //a loop nothing leaves stays in Run()
+
+    if (!status){
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t size     = (tc.buf.size + pageSize - 1) / pageSize * pageSize;
+        void*  native   = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (native == MAP_FAILED) status = -1;
+        else{
+            memcpy(native, tc.buf.bytes, tc.buf.size);
+
+            if (mprotect(native, size, PROT_READ | PROT_EXEC)){
+                munmap(native, size);
+                status = -1;
+            }
+
+            else{
+                trace->native     = native;
+                trace->nativeSize = size;
+            }
+        }
+    }
+
+    free(tc.buf.bytes);
+    free(tc.exitJumps);
+
+    if (status){
+        free(tc.exits);
+        free(tc.values);
+        free(trace);
+        return nullptr;
+    }
+
+    trace->length   = numSteps;
+    trace->exits    = tc.exits;
+    trace->numExits = tc.numExits;
+    trace->values   = tc.values;
+
+    return trace;
+}
+
+#else
+
+static trace_t* CompileTrace(jit_t*){
+    return nullptr;
+}
+
+#endif
+
+/*=================================================================*/
+
+int JitCtor(jit_t* jit, const int64_t* code, size_t numCommands){
+    if (!jit || !code) return -1;
+
+#ifdef JIT_X86_64
+    memset(jit, 0, sizeof(jit_t));
+    jit->code        = code;
+    jit->numCommands = numCommands;
+    jit->backJumps   = (uint64_t*)calloc(sizeof(uint64_t), numCommands + 1);
+    jit->aborts      = (uint32_t*)calloc(sizeof(uint32_t), numCommands + 1);
+    jit->traces      = (trace_t**)calloc(sizeof(trace_t*), numCommands + 1);
+
+    return (jit->backJumps && jit->aborts && jit->traces) ? 0 : -1;
+#else
+    (void)numCommands;
+    return -1;
+#endif
+}
+
+/*=================================================================*/
+
+int JitDtor(jit_t* jit){
+    if (!jit) return -1;
+
+    if (jit->traces){
+        for (size_t pc = 0; pc < jit->numCommands; pc++) FreeTrace(jit->traces[pc]);
+    }
+
+    free(jit->backJumps);
+    free(jit->aborts);
+    free(jit->traces);
+    memset(jit, 0, sizeof(jit_t));
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int JitRun(jit_t* jit, int64_t* registers, int64_t* RAM, Stack_t* stk, FILE* outputFile, size_t* pc){
+    if (jit->recording || *pc >= jit->numCommands || !jit->traces[*pc]) return -1;
+
+    trace_t*   trace = jit->traces[*pc];
+    jitState_t state = {registers, RAM, jit->frame, outputFile, 0};
+
+    int (*native)(jitState_t*) = nullptr;
+    memcpy(&native, &trace->native, sizeof(native));                       //no casts between code and data pointers
+
+    const traceExit_t* exit = trace->exits + native(&state);
+
+    for (size_t i = 0; i < exit->depth; i++){
+        const traceValue_t* value = trace->values + exit->firstValue + i;
+
+        StackPush(stk, (value->isConst) ? value->value : jit->frame[i]);
+    }
+
+    *pc = exit->pc;
+
+    jit->stats.traceEntries++;
+    if (exit->inLoop) jit->stats.guardExits++;
+    jit->stats.iterations   += state.iterations;
+    jit->stats.nativeInstrs += state.iterations * trace->length + exit->pos;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static void StopRecording(jit_t* jit, trace_t* trace){
+    jit->recording = false;
+
+    if (trace){
+        jit->traces[jit->recordStart] = trace;
+        jit->stats.tracesCompiled++;
+        return;
+    }
+
+    jit->aborts[jit->recordStart]++;
+    jit->stats.tracesAborted++;
+}
+
+void JitObserve(jit_t* jit, size_t pc, size_t nextPc){
+    jit->stats.interpreted++;
+
+    if (pc >= jit->numCommands) return;
+
+    int64_t op = jit->code[pc] & OPERATOR_MASK;
+
+    if (jit->recording){
+        if (!IsTraceableOp(op) || jit->numSteps >= JIT_MAX_TRACE){
+            StopRecording(jit, nullptr);
+            return;
+        }
+
+        jit->steps[jit->numSteps++] = {pc, nextPc};
+
+        if (nextPc == jit->recordStart) StopRecording(jit, CompileTrace(jit));
+        return;
+    }
+
+    if (!IsBackJumpOp(op) || nextPc > pc || nextPc >= jit->numCommands) return;
+    if (jit->traces[nextPc] || jit->aborts[nextPc] >= JIT_MAX_ABORTS) return;
+
+    if (++jit->backJumps[nextPc] < JIT_HOT_LOOP) return;
+
+    jit->backJumps[nextPc] = 0;
+    jit->recording   = true;
+    jit->recordStart = nextPc;
+    jit->numSteps    = 0;
+}
+
+/*=================================================================*/
+
+void PrintJitStats(const jitStats_t* stats, FILE* file){
+    uint64_t total = stats->nativeInstrs + stats->interpreted;
+
+    fprintf(file, "jit: %lu traces compiled, %lu aborted\n", stats->tracesCompiled, stats->tracesAborted);
+    fprintf(file, "    %lu trace entries, %lu loop iterations, %lu guard exits back to the interpreter\n",
+                  stats->traceEntries, stats->iterations, stats->guardExits);
+    fprintf(file, "    %lu stack instructions on traces, %lu interpreted, hit rate %.2f%%\n",
+                  stats->nativeInstrs, stats->interpreted, (total) ? 100.0 * (double)stats->nativeInstrs / (double)total : 0.0);
+}
@@ -0,0 +1,302 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/kernels.hpp"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+/*=================================================================*/
+
+void RamFill(int64_t* dst, int64_t value, size_t count){
+
+    if (value == 0){
+        memset(dst, 0, count * sizeof(int64_t));
+        return;
+    }
+
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i vec = _mm_set1_epi64x(value);
+
+    for (; i + 4 <= count; i += 4){
+        _mm_storeu_si128((__m128i*)(dst + i),     vec);
+        _mm_storeu_si128((__m128i*)(dst + i + 2), vec);
+    }
+#elif defined(__ARM_NEON)
+    int64x2_t vec = vdupq_n_s64(value);
+
+    for (; i + 4 <= count; i += 4){
+        vst1q_s64(dst + i,     vec);
+        vst1q_s64(dst + i + 2, vec);
+    }
+#endif
+
+    for (; i < count; i++){
+        dst[i] = value;
+    }
+}
+
+/*=================================================================*/
+
+void RamCopy(int64_t* dst, const int64_t* src, size_t count){
+
+    memmove(dst, src, count * sizeof(int64_t));                     //ranges may overlap
+}
+
+/*=================================================================*/
+
+int64_t RamCompare(const int64_t* first, const int64_t* second, size_t count){
+
+    if (!memcmp(first, second, count * sizeof(int64_t))) return 0;
+
+    for (size_t i = 0; i < count; i++){
+        if (first[i] != second[i]) return (first[i] < second[i]) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+//scalar kernels wrap on overflow like the AVX2 ones, hence the uint64_t math
+
+static void ScalarAdd(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    for (size_t i = 0; i < count; i++) dst[i] = (int64_t)((uint64_t)first[i] + (uint64_t)second[i]);
+}
+
+static void ScalarSub(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    for (size_t i = 0; i < count; i++) dst[i] = (int64_t)((uint64_t)first[i] - (uint64_t)second[i]);
+}
+
+static void ScalarMul(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    for (size_t i = 0; i < count; i++) dst[i] = (int64_t)((uint64_t)first[i] * (uint64_t)second[i]);
+}
+
+static void ScalarScale(int64_t* dst, const int64_t* src, int64_t factor, size_t count){
+    for (size_t i = 0; i < count; i++) dst[i] = (int64_t)((uint64_t)src[i] * (uint64_t)factor);
+}
+
+static int64_t ScalarDot(const int64_t* first, const int64_t* second, size_t count){
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) sum += (uint64_t)first[i] * (uint64_t)second[i];
+
+    return (int64_t)sum;
+}
+
+static int64_t ScalarSum(const int64_t* src, size_t count){
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) sum += (uint64_t)src[i];
+
+    return (int64_t)sum;
+}
+
+static int64_t ScalarMin(const int64_t* src, size_t count){
+    if (!count) return 0;
+
+    int64_t min = src[0];
+    for (size_t i = 1; i < count; i++) if (src[i] < min) min = src[i];
+
+    return min;
+}
+
+static int64_t ScalarMax(const int64_t* src, size_t count){
+    if (!count) return 0;
+
+    int64_t max = src[0];
+    for (size_t i = 1; i < count; i++) if (src[i] > max) max = src[i];
+
+    return max;
+}
+
+static const vectorKernels_t scalarKernels = {
+    "scalar",
+    ScalarAdd, ScalarSub, ScalarMul, ScalarScale,
+    ScalarDot, ScalarSum, ScalarMin, ScalarMax
+};
+
+const vectorKernels_t* KernelsScalar(){
+    return &scalarKernels;
+}
+
+/*=================================================================*/
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i Avx2MulLo(__m256i first, __m256i second){                //no vpmullq before AVX-512
+    __m256i lowLow   = _mm256_mul_epu32(first, second);
+    __m256i lowHigh  = _mm256_mul_epu32(first, _mm256_srli_epi64(second, 32));
+    __m256i highLow  = _mm256_mul_epu32(_mm256_srli_epi64(first, 32), second);
+    __m256i cross    = _mm256_slli_epi64(_mm256_add_epi64(lowHigh, highLow), 32);
+
+    return _mm256_add_epi64(lowLow, cross);
+}
+
+//the scalar loops are the reference: on overlap a word written is what later words read. Blocks of 4
+//only read something else when dst starts 1..3 words past a source, those ranges take the scalar loop
+static inline bool Trails(const int64_t* dst, const int64_t* src){
+    return dst > src && dst - src < 4;
+}
+
+AVX2 static inline int64_t Avx2HorizontalSum(__m256i vec){
+    int64_t lanes[4] = {};
+    _mm256_storeu_si256((__m256i*)lanes, vec);
+
+    return (int64_t)((uint64_t)lanes[0] + (uint64_t)lanes[1] + (uint64_t)lanes[2] + (uint64_t)lanes[3]);
+}
+
+AVX2 static void Avx2Add(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    if (Trails(dst, first) || Trails(dst, second)){
+        ScalarAdd(dst, first, second, count);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(first  + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(second + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi64(a, b));
+    }
+
+    ScalarAdd(dst + i, first + i, second + i, count - i);
+}
+
+AVX2 static void Avx2Sub(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    if (Trails(dst, first) || Trails(dst, second)){
+        ScalarSub(dst, first, second, count);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(first  + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(second + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_sub_epi64(a, b));
+    }
+
+    ScalarSub(dst + i, first + i, second + i, count - i);
+}
+
+AVX2 static void Avx2Mul(int64_t* dst, const int64_t* first, const int64_t* second, size_t count){
+    if (Trails(dst, first) || Trails(dst, second)){
+        ScalarMul(dst, first, second, count);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(first  + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(second + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), Avx2MulLo(a, b));
+    }
+
+    ScalarMul(dst + i, first + i, second + i, count - i);
+}
+
+AVX2 static void Avx2Scale(int64_t* dst, const int64_t* src, int64_t factor, size_t count){
+    if (Trails(dst, src)){
+        ScalarScale(dst, src, factor, count);
+        return;
+    }
+
+    __m256i k = _mm256_set1_epi64x(factor);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), Avx2MulLo(a, k));
+    }
+
+    ScalarScale(dst + i, src + i, factor, count - i);
+}
+
+AVX2 static int64_t Avx2Dot(const int64_t* first, const int64_t* second, size_t count){
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(first  + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(second + i));
+        acc = _mm256_add_epi64(acc, Avx2MulLo(a, b));
+    }
+
+    return (int64_t)((uint64_t)Avx2HorizontalSum(acc) + (uint64_t)ScalarDot(first + i, second + i, count - i));
+}
+
+AVX2 static int64_t Avx2Sum(const int64_t* src, size_t count){
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256((const __m256i*)(src + i)));
+    }
+
+    return (int64_t)((uint64_t)Avx2HorizontalSum(acc) + (uint64_t)ScalarSum(src + i, count - i));
+}
+
+AVX2 static int64_t Avx2Min(const int64_t* src, size_t count){
+    if (count < 4) return ScalarMin(src, count);
+
+    __m256i acc = _mm256_loadu_si256((const __m256i*)src);
+
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4){
+        __m256i vec = _mm256_loadu_si256((const __m256i*)(src + i));
+        acc = _mm256_blendv_epi8(acc, vec, _mm256_cmpgt_epi64(acc, vec));
+    }
+
+    int64_t lanes[4] = {};
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+
+    int64_t min = ScalarMin(lanes, 4);
+    for (; i < count; i++) if (src[i] < min) min = src[i];
+
+    return min;
+}
+
+AVX2 static int64_t Avx2Max(const int64_t* src, size_t count){
+    if (count < 4) return ScalarMax(src, count);
+
+    __m256i acc = _mm256_loadu_si256((const __m256i*)src);
+
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4){
+        __m256i vec = _mm256_loadu_si256((const __m256i*)(src + i));
+        acc = _mm256_blendv_epi8(acc, vec, _mm256_cmpgt_epi64(vec, acc));
+    }
+
+    int64_t lanes[4] = {};
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+
+    int64_t max = ScalarMax(lanes, 4);
+    for (; i < count; i++) if (src[i] > max) max = src[i];
+
+    return max;
+}
+
+#undef AVX2
+
+static const vectorKernels_t avx2Kernels = {
+    "avx2",
+    Avx2Add, Avx2Sub, Avx2Mul, Avx2Scale,
+    Avx2Dot, Avx2Sum, Avx2Min, Avx2Max
+};
+
+#endif
+
+/*=================================================================*/
+
+const vectorKernels_t* KernelsInit(){
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &avx2Kernels;
+#endif
+
+    return &scalarKernels;
+}
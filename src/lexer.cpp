@@ -0,0 +1,248 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/lexer.hpp"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+const size_t BLOCK_SIZE     = 64;
+const size_t MIN_TOKENS     = 1 << 14;
+
+/*=================================================================*/
+//one bit per byte of a 64-byte block
+
+typedef struct blockMasks{
+    uint64_t space;
+    uint64_t newline;
+    uint64_t punct;                                         // : [ ] + ,
+} blockMasks_t;
+
+#if defined(__SSE2__)
+
+static inline uint64_t Movemask(__m128i eq0, __m128i eq1, __m128i eq2, __m128i eq3){
+    return  (uint64_t)(uint16_t)_mm_movemask_epi8(eq0)        |
+            (uint64_t)(uint16_t)_mm_movemask_epi8(eq1) << 16  |
+            (uint64_t)(uint16_t)_mm_movemask_epi8(eq2) << 32  |
+            (uint64_t)(uint16_t)_mm_movemask_epi8(eq3) << 48;
+}
+
+static inline void ClassifyChunk(__m128i chunk, __m128i* space, __m128i* newline, __m128i* punct){
+    *space   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+
+    *newline = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+
+    *punct   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('['))),
+               _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(']')),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('+'))),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))));
+}
+
+static void ClassifyBlock(const char* block, blockMasks_t* masks){
+    __m128i space[4], newline[4], punct[4];
+
+    for (int i = 0; i < 4; i++){
+        ClassifyChunk(_mm_loadu_si128((const __m128i*)(block + 16 * i)), space + i, newline + i, punct + i);
+    }
+
+    masks->space   = Movemask(space[0],   space[1],   space[2],   space[3]);
+    masks->newline = Movemask(newline[0], newline[1], newline[2], newline[3]);
+    masks->punct   = Movemask(punct[0],   punct[1],   punct[2],   punct[3]);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static inline uint64_t Movemask(uint8x16_t eq){
+    const uint8x16_t weights = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(eq, weights);
+
+    return (uint64_t)vaddv_u8(vget_low_u8(bits)) | (uint64_t)vaddv_u8(vget_high_u8(bits)) << 8;
+}
+
+static void ClassifyBlock(const char* block, blockMasks_t* masks){
+    *masks = {};
+
+    for (int i = 0; i < 4; i++){
+        uint8x16_t chunk = vld1q_u8((const uint8_t*)block + 16 * i);
+
+        uint8x16_t space   = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(' ')), vceqq_u8(chunk, vdupq_n_u8('\t'))),
+                                                vceqq_u8(chunk, vdupq_n_u8('\r')));
+        uint8x16_t newline = vceqq_u8(chunk, vdupq_n_u8('\n'));
+        uint8x16_t punct   = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(':')), vceqq_u8(chunk, vdupq_n_u8('['))),
+                             vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(']')), vceqq_u8(chunk, vdupq_n_u8('+'))),
+                                                vceqq_u8(chunk, vdupq_n_u8(','))));
+
+        masks->space   |= Movemask(space)   << (16 * i);
+        masks->newline |= Movemask(newline) << (16 * i);
+        masks->punct   |= Movemask(punct)   << (16 * i);
+    }
+}
+
+#else
+
+static void ClassifyBlock(const char* block, blockMasks_t* masks){
+    *masks = {};
+
+    for (size_t i = 0; i < BLOCK_SIZE; i++){
+        char symbol = block[i];
+
+        if      (symbol == ' ' || symbol == '\t' || symbol == '\r')     masks->space   |= 1ull << i;
+        else if (symbol == '\n')                                        masks->newline |= 1ull << i;
+        else if (symbol == ':' || symbol == '[' || symbol == ']' ||
+                 symbol == '+' || symbol == ',')                        masks->punct   |= 1ull << i;
+    }
+}
+
+#endif
+
+/*=================================================================*/
+
+int LexerCtor(lexer_t* lexer, const char* buffer, size_t size){
+    if (!lexer) return -1;
+
+    lexer->buffer     = buffer;
+    lexer->size       = size;
+    lexer->pos        = 0;
+
+    lexer->tokens     = (token_t*)calloc(sizeof(token_t), MIN_TOKENS);
+    lexer->numTokens  = 0;
+    lexer->sizeTokens = MIN_TOKENS;
+
+    return (lexer->tokens) ? 0 : -1;
+}
+
+/*=================================================================*/
+
+int LexerDtor(lexer_t* lexer){
+    if (!lexer) return -1;
+
+    free(lexer->tokens);
+    lexer->tokens     = nullptr;
+    lexer->numTokens  = 0;
+    lexer->sizeTokens = 0;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static inline void AddToken(lexer_t* lexer, tokenType type, const char* addr, size_t size){
+    token_t* token = lexer->tokens + lexer->numTokens++;
+
+    token->type = type;
+    token->addr = addr;
+    token->size = (uint32_t)size;
+}
+
+/*=================================================================*/
+
+static tokenType PunctType(char symbol){
+    switch (symbol){
+        case ':':   return TOKEN_COLON;
+        case '[':   return TOKEN_LBRACKET;
+        case ']':   return TOKEN_RBRACKET;
+        case '+':   return TOKEN_PLUS;
+        case ',':
+        default:    return TOKEN_COMMA;
+    }
+}
+
+/*=================================================================*/
+
+int LexTokens(lexer_t* lexer){
+    lexer->numTokens = 0;
+
+    const char* buffer    = lexer->buffer;
+    size_t      size      = lexer->size;
+    size_t      pos       = lexer->pos;
+    size_t      wordStart = 0;
+    uint64_t    inWord    = 0;                              //last byte of the previous block was a word byte
+
+    while (pos < size){
+
+        if (lexer->sizeTokens - lexer->numTokens < BLOCK_SIZE + 2){
+            size_t lastNewline = lexer->numTokens;
+            while (lastNewline && lexer->tokens[lastNewline - 1].type != TOKEN_NEWLINE) lastNewline--;
+
+            if (lastNewline){                               //hand over whole lines, the rest is lexed again
+                lexer->numTokens = lastNewline;
+                lexer->pos = (size_t)(lexer->tokens[lastNewline - 1].addr - buffer) + 1;
+
+                return 0;
+            }
+
+            token_t* newTokens = (token_t*)realloc(lexer->tokens, sizeof(token_t) * lexer->sizeTokens * 2);
+            if (!newTokens) return -1;
+
+            lexer->tokens      = newTokens;
+            lexer->sizeTokens *= 2;
+        }
+
+        blockMasks_t masks = {};
+        size_t blockSize = size - pos;
+
+        if (blockSize >= BLOCK_SIZE){
+            blockSize = BLOCK_SIZE;
+            ClassifyBlock(buffer + pos, &masks);
+        }
+
+        else{
+            char tail[BLOCK_SIZE] = {};
+            memset(tail, ' ', BLOCK_SIZE);
+            memcpy(tail, buffer + pos, blockSize);
+
+            ClassifyBlock(tail, &masks);
+        }
+
+        uint64_t special    = masks.newline | masks.punct;
+        uint64_t word       = ~(masks.space | special);
+        uint64_t starts     =  word & ~((word << 1) | inWord);
+        uint64_t ends       = ~word &  ((word << 1) | inWord);
+        uint64_t events     = starts | ends | special;
+
+        size_t   nextPos    = pos + blockSize;
+        inWord              = word >> 63;
+
+        while (events){
+            int      bit    = __builtin_ctzll(events);
+            uint64_t mask   = 1ull << bit;
+            size_t   at     = pos + (size_t)bit;
+            events &= events - 1;
+
+            if (ends & mask)                AddToken(lexer, TOKEN_WORD, buffer + wordStart, ((at < size) ? at : size) - wordStart);
+            if (at >= size) break;                                                  //padding of the last block
+
+            if      (masks.newline & mask)  AddToken(lexer, TOKEN_NEWLINE,         buffer + at, 1);
+            else if (masks.punct   & mask)  AddToken(lexer, PunctType(buffer[at]), buffer + at, 1);
+
+            if (starts & mask){
+                if (buffer[at] == '/' && at + 1 < size && buffer[at + 1] == '/'){      //comment up to the end of line
+                    const char* newline = (const char*)memchr(buffer + at, '\n', size - at);
+
+                    nextPos = (newline) ? (size_t)(newline - buffer) : size;
+                    inWord  = 0;
+                    break;
+                }
+
+                wordStart = at;
+            }
+        }
+
+        pos = nextPos;
+    }
+
+    if (inWord) AddToken(lexer, TOKEN_WORD, buffer + wordStart, size - wordStart);
+
+    if (lexer->numTokens && lexer->tokens[lexer->numTokens - 1].type != TOKEN_NEWLINE){
+        AddToken(lexer, TOKEN_NEWLINE, buffer + size, 0);
+    }
+
+    lexer->pos = size;
+
+    return 0;
+}
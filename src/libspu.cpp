@@ -0,0 +1,876 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "../hpp/libspu.hpp"
+#include "../hpp/operations.hpp"
+#include "../hpp/container.hpp"
+
+//same instructions as Run() in processor.cpp, but every error stops the context instead of the process:
+//empty stacks, RAM addresses and blocks, division by zero; dump and draw have nothing to show here and do nothing
+
+const size_t RAM_BYTES = sizeof(int64_t) * SIZE_RAM;
+
+/*=================================================================*/
+
+static int CheckRegister(int64_t reg){
+    return (reg < 0 || reg > REGISTER_NUM) ? -1 : 0;
+}
+
+//jumps land on instructions or on numCommands, so the interpreter never decodes a word it did not verify
+static int VerifyCode(const int64_t* code, size_t numCommands){
+    bool* isStart = (bool*)calloc(sizeof(bool), numCommands + 1);
+    if (!isStart) return -1;
+
+    int status = 0;
+
+    for (size_t pc = 0; pc < numCommands && !status; ){
+        int64_t                 command     = code[pc];
+        const instruction_t*    instruction = FindInstructionByCode(command);
+        size_t                  length      = InstructionLength(command);
+
+        if (!instruction || pc + length > numCommands || IsThreadOp(command)){
+            status = -1;
+            break;
+        }
+
+        isStart[pc] = true;
+
+        if ((instruction->args == ARGS_PUSH || instruction->args == ARGS_POP) && (command & registerMask)){
+            if (CheckRegister(code[pc + 1])) status = -1;
+        }
+
+        if (instruction->args >= ARGS_BLOCK2){
+            for (size_t i = 1; i < length; i++){
+                if ((command & (BLOCK_REG_ARG << (i - 1))) && CheckRegister(code[pc + i])) status = -1;
+            }
+        }
+
+        pc += length;
+    }
+
+    isStart[numCommands] = true;
+
+    for (size_t pc = 0; pc < numCommands && !status; pc += InstructionLength(code[pc])){
+        if (FindInstructionByCode(code[pc])->args != ARGS_LABEL) continue;
+
+        int64_t target = code[pc + 1];
+        if (target < 0 || (size_t)target > numCommands || !isStart[target]) status = -1;
+    }
+
+    free(isStart);
+
+    return status;
+}
+
+/*=================================================================*/
+
+static inline bool EndsBlock(int64_t command){
+    int64_t op = command & OPERATOR_MASK;
+
+    return op == JMP || op == JA || op == JAE || op == JE || op == JNE || op == CALL || op == RET || op == HLT;
+}
+
+//from the last instruction back: a block ender costs 1, anything else 1 + the next one, numCommands is the end
+static int CountBlockCosts(spuProgram_t* program){
+    const int64_t* code        = program->code;
+    size_t         numCommands = program->numCommands;
+
+    size_t* starts    = (size_t*)  calloc(sizeof(size_t),   numCommands + 1);
+    program->blockCost = (uint32_t*)calloc(sizeof(uint32_t), numCommands + 1);
+
+    if (!starts || !program->blockCost){
+        free(starts);
+        return -1;
+    }
+
+    size_t numStarts = 0;
+    for (size_t pc = 0; pc < numCommands; pc += InstructionLength(code[pc])) starts[numStarts++] = pc;
+
+    uint32_t next = 1;
+    program->blockCost[numCommands] = 1;
+
+    for (size_t i = numStarts; i > 0; i--){
+        size_t pc = starts[i - 1];
+
+        next = (EndsBlock(code[pc])) ? 1 : next + 1;
+        program->blockCost[pc] = next;
+    }
+
+    free(starts);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static bool BadSection(const section_t* section, size_t numWords){
+    return section->address < 0 || section->address > SIZE_RAM || numWords > (size_t)(SIZE_RAM - section->address);
+}
+
+//zero sections need no copy, a context's RAM starts zeroed and goes back to zero on reset
+
+static int LoadContainer(spuProgram_t* program, const void* image, size_t size, const int64_t** code){
+    container_t container = {};
+    if (ContainerFromMemory(&container, image, size) || ContainerVerify(&container, 0)) return -1;
+
+    const section_t* codeSection = ContainerFind(&container, SECTION_CODE);
+    const section_t* data        = ContainerFind(&container, SECTION_DATA);
+    const section_t* zero        = ContainerFind(&container, SECTION_ZERO);
+
+    if (!codeSection || (zero && BadSection(zero, zero->size)) || (data && BadSection(data, data->size / sizeof(int64_t)))) return -1;
+
+    *code                = (const int64_t*)ContainerSection(&container, SECTION_CODE, nullptr);
+    program->numCommands = codeSection->size / sizeof(int64_t);
+
+    if (!data) return 0;
+
+    program->numData     = data->size / sizeof(int64_t);
+    program->dataAddress = (size_t)data->address;
+    program->data        = (int64_t*)calloc(sizeof(int64_t), program->numData);
+    if (!program->data) return -1;
+
+    memcpy(program->data, ContainerSection(&container, SECTION_DATA, nullptr), data->size);
+
+    return 0;
+}
+
+int SpuProgramFromMemory(spuProgram_t* program, const void* image, size_t size){
+    if (!program || !image || size < sizeof(header_t)) return -1;
+
+    *program = {};
+
+    const int64_t* code = (const int64_t*)((const char*)image + sizeof(header_t));
+
+    if (IsContainer(image, size)){
+        if (LoadContainer(program, image, size, &code)){
+            SpuProgramDtor(program);
+            return -1;
+        }
+    }
+    else{
+        header_t header = {};
+        memcpy(&header, image, sizeof(header_t));
+
+        if (header.signature != SIGNATURE || header.version != VERSION) return -1;
+        if (header.numCommands > (size - sizeof(header_t)) / sizeof(int64_t)) return -1;
+
+        program->numCommands = header.numCommands;
+    }
+
+    program->code = (int64_t*)calloc(sizeof(int64_t), program->numCommands + 1);            //0 past the end, no such opcode
+    if (!program->code){
+        SpuProgramDtor(program);
+        return -1;
+    }
+
+    memcpy(program->code, code, program->numCommands * sizeof(int64_t));
+
+    if (VerifyCode(program->code, program->numCommands) || CountBlockCosts(program)){
+        SpuProgramDtor(program);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int SpuProgramLoad(spuProgram_t* program, const char* fileName){
+    if (!program || !fileName) return -1;
+
+    FILE* file = fopen(fileName, "rb");
+    if (!file) return -1;
+
+    char*  image  = nullptr;
+    size_t size   = 0;
+    int    status = -1;
+
+    if (!fseek(file, 0, SEEK_END)){
+        long end = ftell(file);
+
+        if (end > 0 && !fseek(file, 0, SEEK_SET)){
+            size  = (size_t)end;
+            image = (char*)calloc(size, 1);
+        }
+    }
+
+    if (image && fread(image, 1, size, file) == size) status = SpuProgramFromMemory(program, image, size);
+
+    free(image);
+    fclose(file);
+
+    return status;
+}
+
+/*=================================================================*/
+
+int SpuProgramDtor(spuProgram_t* program){
+    if (!program) return -1;
+
+    free(program->code);
+    free(program->data);
+    free(program->blockCost);
+    *program = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int StdInput(void* data, int64_t* value, bool isFloat){
+    (void)data;
+
+    if (isFloat){
+        double number = 0;
+        if (scanf("%lf", &number) != 1) return -1;
+
+        *value = DoubleToWord(number);
+        return 0;
+    }
+
+    long long number = 0;
+    if (scanf("%lld", &number) != 1) return -1;
+
+    *value = number;
+    return 0;
+}
+
+static int StdOutput(void* data, int64_t value, bool isFloat){
+    (void)data;
+
+    if (isFloat) printf("%.*lg\n", FLOAT_OUT_PRECISION, WordToDouble(value));
+    else         printf("%lld\n",  (long long)value);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+//registers, stacks and pc the way the template left them at its snap, the stacks are big enough since the ctor
+static void StartAtImage(spuContext_t* ctx){
+    const spuImage_t* image = ctx->image;
+
+    ctx->pc  = image->pc;
+    ctx->sp  = image->sp;
+    ctx->csp = image->csp;
+
+    memcpy(ctx->registers, image->registers, sizeof(ctx->registers));
+    memcpy(ctx->stack,     image->stack,     sizeof(int64_t) * image->sp);
+    memcpy(ctx->calls,     image->calls,     sizeof(size_t)  * image->csp);
+}
+
+//the program's data words that fall in [low, high)
+
+static void CopyData(spuContext_t* ctx, size_t low, size_t high){
+    const spuProgram_t* program = ctx->program;
+
+    size_t start = (program->dataAddress > low)                      ? program->dataAddress                      : low;
+    size_t end   = (program->dataAddress + program->numData < high)  ? program->dataAddress + program->numData    : high;
+
+    if (start < end) memcpy(ctx->RAM + start, program->data + (start - program->dataAddress), sizeof(int64_t) * (end - start));
+}
+
+static int ContextCtor(spuContext_t* ctx, const spuProgram_t* program, const spuImage_t* image, const spuIo_t* io){
+    if (!ctx || !program || !program->code) return -1;
+
+    *ctx = {};
+    ctx->program   = program;
+    ctx->image     = image;
+    ctx->io        = (io) ? *io : spuIo_t{};
+    ctx->kernels   = KernelsInit();
+
+    if (!ctx->io.input)  ctx->io.input  = StdInput;
+    if (!ctx->io.output) ctx->io.output = StdOutput;
+
+    ctx->sizeStack = (image && image->sp  > SPU_MIN_STACK) ? image->sp  : SPU_MIN_STACK;
+    ctx->sizeCalls = (image && image->csp > SPU_MIN_STACK) ? image->csp : SPU_MIN_STACK;
+    ctx->stack     = (int64_t*)calloc(sizeof(int64_t), ctx->sizeStack);
+    ctx->calls     = (size_t*) calloc(sizeof(size_t),  ctx->sizeCalls);
+    ctx->ramLow    = SIZE_RAM;
+
+    if (image){
+        void* RAM = mmap(nullptr, RAM_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE, image->fd, 0);
+        ctx->RAM  = (RAM == MAP_FAILED) ? nullptr : (int64_t*)RAM;
+    }
+    else ctx->RAM = (int64_t*)calloc(sizeof(int64_t), SIZE_RAM);
+
+    if (!ctx->stack || !ctx->calls || !ctx->RAM){
+        SpuContextDtor(ctx);
+        return -1;
+    }
+
+    if (image) StartAtImage(ctx);
+    else       CopyData(ctx, 0, SIZE_RAM);
+
+    return 0;
+}
+
+int SpuContextCtor(spuContext_t* ctx, const spuProgram_t* program, const spuIo_t* io){
+    return ContextCtor(ctx, program, nullptr, io);
+}
+
+int SpuContextFromImage(spuContext_t* ctx, const spuImage_t* image, const spuIo_t* io){
+    if (!image || !image->RAM) return -1;
+
+    return ContextCtor(ctx, image->program, image, io);
+}
+
+/*=================================================================*/
+
+int SpuContextReset(spuContext_t* ctx){
+    if (!ctx || !ctx->program) return -1;
+
+    ctx->pc           = 0;
+    ctx->sp           = 0;
+    ctx->csp          = 0;
+    ctx->status       = SPU_READY;
+    ctx->errorPc      = 0;
+    ctx->instructions = 0;
+
+    memset(ctx->registers, 0, sizeof(ctx->registers));
+
+    if (ctx->ramLow < ctx->ramHigh){
+        size_t bytes = sizeof(int64_t) * (ctx->ramHigh - ctx->ramLow);
+
+        if (ctx->image) memcpy(ctx->RAM + ctx->ramLow, ctx->image->RAM + ctx->ramLow, bytes);
+        else{
+            memset(ctx->RAM + ctx->ramLow, 0, bytes);
+            CopyData(ctx, ctx->ramLow, ctx->ramHigh);
+        }
+    }
+
+    ctx->ramLow  = SIZE_RAM;
+    ctx->ramHigh = 0;
+
+    if (ctx->image) StartAtImage(ctx);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int SpuContextDtor(spuContext_t* ctx){
+    if (!ctx) return -1;
+
+    free(ctx->stack);
+    free(ctx->calls);
+
+    if      (!ctx->image)   free(ctx->RAM);
+    else if (ctx->RAM)      munmap(ctx->RAM, RAM_BYTES);
+
+    *ctx = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int RamFile(){
+#ifdef __linux__
+    return memfd_create("spu ram", MFD_CLOEXEC);
+#else
+    char name[] = "/tmp/spu_ram_XXXXXX";                                    //no memfd, an unlinked file does the same
+    int  fd     = mkstemp(name);
+
+    if (fd >= 0) unlink(name);
+
+    return fd;
+#endif
+}
+
+static void CopyRam(int64_t* RAM, const spuContext_t* ctx, size_t low, size_t high){
+    if (low < high) memcpy(RAM + low, ctx->RAM + low, sizeof(int64_t) * (high - low));
+}
+
+//only the data section and what the template wrote are copied, the rest of the file is a hole and reads as 0
+static int WriteImageRam(spuImage_t* image, const spuContext_t* ctx){
+    image->fd = RamFile();
+    if (image->fd < 0 || ftruncate(image->fd, (off_t)RAM_BYTES)) return -1;
+
+    void* RAM = mmap(nullptr, RAM_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, image->fd, 0);
+    if (RAM == MAP_FAILED) return -1;
+
+    const spuProgram_t* program = ctx->program;
+
+    CopyRam((int64_t*)RAM, ctx, program->dataAddress, program->dataAddress + program->numData);
+    CopyRam((int64_t*)RAM, ctx, ctx->ramLow, ctx->ramHigh);
+
+    image->RAM = (int64_t*)RAM;
+
+    return mprotect(RAM, RAM_BYTES, PROT_READ);
+}
+
+/*=================================================================*/
+
+int SpuImageCtor(spuImage_t* image, const spuProgram_t* program, const spuIo_t* io){
+    if (!image) return -1;
+
+    *image = {};
+    image->fd = -1;
+
+    spuContext_t ctx = {};
+    if (SpuContextCtor(&ctx, program, io)) return -1;
+
+    ctx.stopAtSnap = true;
+    int status = (SpuRun(&ctx) == SPU_SNAPPED) ? 0 : -1;
+
+    if (!status){
+        image->program      = program;
+        image->pc           = ctx.pc + 1;
+        image->sp           = ctx.sp;
+        image->csp          = ctx.csp;
+        image->instructions = ctx.instructions;
+        image->stack        = (int64_t*)calloc(sizeof(int64_t), ctx.sp  + 1);
+        image->calls        = (size_t*) calloc(sizeof(size_t),  ctx.csp + 1);
+
+        memcpy(image->registers, ctx.registers, sizeof(image->registers));
+
+        if (!image->stack || !image->calls || WriteImageRam(image, &ctx)) status = -1;
+    }
+
+    if (!status){
+        memcpy(image->stack, ctx.stack, sizeof(int64_t) * ctx.sp);
+        memcpy(image->calls, ctx.calls, sizeof(size_t)  * ctx.csp);
+    }
+
+    SpuContextDtor(&ctx);
+    if (status) SpuImageDtor(image);
+
+    return status;
+}
+
+/*=================================================================*/
+
+int SpuImageDtor(spuImage_t* image){
+    if (!image) return -1;
+
+    if (image->RAM)     munmap(image->RAM, RAM_BYTES);
+    if (image->fd >= 0) close(image->fd);
+
+    free(image->stack);
+    free(image->calls);
+    *image = {};
+    image->fd = -1;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int GrowStack(spuContext_t* ctx){
+    int64_t* stack = (int64_t*)realloc(ctx->stack, sizeof(int64_t) * ctx->sizeStack * 2);
+    if (!stack) return -1;
+
+    ctx->stack      = stack;
+    ctx->sizeStack *= 2;
+
+    return 0;
+}
+
+static int GrowCalls(spuContext_t* ctx){
+    size_t* calls = (size_t*)realloc(ctx->calls, sizeof(size_t) * ctx->sizeCalls * 2);
+    if (!calls) return -1;
+
+    ctx->calls      = calls;
+    ctx->sizeCalls *= 2;
+
+    return 0;
+}
+
+static inline spuStatus Push(spuContext_t* ctx, int64_t value){
+    if (ctx->sp == ctx->sizeStack && GrowStack(ctx)) return SPU_ERR_MEMORY;
+
+    ctx->stack[ctx->sp++] = value;
+
+    return SPU_READY;
+}
+
+static inline spuStatus Pop(spuContext_t* ctx, int64_t* value){
+    if (!ctx->sp) return SPU_ERR_STACK;
+
+    *value = ctx->stack[--ctx->sp];
+
+    return SPU_READY;
+}
+
+/*=================================================================*/
+//push/pop operand the way Run() decodes it: imm goes through registers[0], memory is RAM[reg + imm]
+
+static inline int64_t* Operand(spuContext_t* ctx, size_t* pc){
+    const int64_t* code    = ctx->program->code;
+    int64_t        command = code[*pc];
+    int64_t*       dst     = ctx->registers;
+    int64_t        value   = 0;
+    size_t         at      = *pc + 1;
+
+    if (command & registerMask){
+        dst   = ctx->registers + code[at++];
+        value = *dst;
+    }
+
+    if (command & immediateMask){
+        value = (int64_t)((uint64_t)value + (uint64_t)code[at++]);
+        dst   = ctx->registers;
+        *dst  = value;
+    }
+
+    *pc = at;
+
+    if (command & memoryMask) return (value < 0 || value >= SIZE_RAM) ? nullptr : ctx->RAM + value;
+
+    return dst;
+}
+
+static inline void BlockArgs(const spuContext_t* ctx, int64_t* args, size_t numArgs){
+    const int64_t* code    = ctx->program->code + ctx->pc;
+    int64_t        command = code[0];
+
+    for (size_t i = 0; i < numArgs; i++){
+        args[i] = (command & (BLOCK_REG_ARG << i)) ? ctx->registers[code[1 + i]] : code[1 + i];
+    }
+}
+
+static inline bool BadBlock(int64_t addr, int64_t count){
+    return addr < 0 || count < 0 || addr > SIZE_RAM - count;
+}
+
+static inline void MarkRam(spuContext_t* ctx, int64_t addr, int64_t count){                //reset clears only this much
+    if ((size_t)addr           < ctx->ramLow)  ctx->ramLow  = (size_t)addr;
+    if ((size_t)(addr + count) > ctx->ramHigh) ctx->ramHigh = (size_t)(addr + count);
+}
+
+/*=================================================================*/
+
+static inline spuStatus Binary(int64_t op, int64_t first, int64_t second, int64_t* result){
+    switch (op){
+        case ADD:   *result = (int64_t)((uint64_t)first + (uint64_t)second);               break;
+        case SUB:   *result = (int64_t)((uint64_t)first - (uint64_t)second);               break;
+        case MUL:   *result = (int64_t)((uint64_t)first * (uint64_t)second);               break;
+
+        case DIV:
+        case MOD:
+            if (!second) return SPU_ERR_DIV;
+
+            if (second == -1) *result = (op == DIV) ? (int64_t)(0 - (uint64_t)first) : 0;
+            else              *result = (op == DIV) ? first / second : first % second;
+            break;
+
+        case LS_EQ: *result = first <= second;                                              break;
+        case MR_EQ: *result = first >= second;                                              break;
+        case EQL:   *result = first == second;                                              break;
+        case LS:    *result = first <  second;                                              break;
+        case MR:    *result = first >  second;                                              break;
+
+        case FADD:  *result = DoubleToWord(WordToDouble(first) + WordToDouble(second));     break;
+        case FSUB:  *result = DoubleToWord(WordToDouble(first) - WordToDouble(second));     break;
+        case FMUL:  *result = DoubleToWord(WordToDouble(first) * WordToDouble(second));     break;
+        case FDIV:
+        default:    *result = DoubleToWord(WordToDouble(first) / WordToDouble(second));     break;
+    }
+
+    return SPU_READY;
+}
+
+static inline int64_t Unary(int64_t op, int64_t num){
+    switch (op){
+        case SQRT:  return (num >= 0) ? (int64_t)sqrt((double)num) : 0;
+        case SIN:   return (int64_t)sin((double)num);
+        case COS:   return (int64_t)cos((double)num);
+        case FSQRT: return DoubleToWord(sqrt(WordToDouble(num)));
+        case FSIN:  return DoubleToWord(sin(WordToDouble(num)));
+        case FCOS:  return DoubleToWord(cos(WordToDouble(num)));
+        case ITOF:  return DoubleToWord((double)num);
+        case FTOI:
+        default:    return DoubleToInt(WordToDouble(num));
+    }
+}
+
+static inline bool Taken(int64_t op, int64_t first, int64_t second){
+    switch (op){
+        case JA:    return first >  second;
+        case JAE:   return first >= second;
+        case JE:    return first == second;
+        case JNE:   return first != second;
+        case JMP:
+        default:    return true;
+    }
+}
+
+/*=================================================================*/
+
+static spuStatus Block(spuContext_t* ctx, int64_t op){
+    int64_t args[MAX_BLOCK_ARGS] = {};
+    int64_t* RAM = ctx->RAM;
+
+    switch (op){
+        case FILL:{                                                                         //dst, value, count
+            BlockArgs(ctx, args, 3);
+            if (BadBlock(args[0], args[2])) return SPU_ERR_RAM;
+
+            MarkRam(ctx, args[0], args[2]);
+            RamFill(RAM + args[0], args[1], (size_t)args[2]);
+            return SPU_READY;
+        }
+
+        case COPY:                                                                          //dst, src, count
+        case CMP:{                                                                          //first, second, count
+            BlockArgs(ctx, args, 3);
+            if (BadBlock(args[0], args[2]) || BadBlock(args[1], args[2])) return SPU_ERR_RAM;
+
+            if (op == COPY){
+                MarkRam(ctx, args[0], args[2]);
+                RamCopy(RAM + args[0], RAM + args[1], (size_t)args[2]);
+                return SPU_READY;
+            }
+
+            return Push(ctx, RamCompare(RAM + args[0], RAM + args[1], (size_t)args[2]));
+        }
+
+        case VADD:
+        case VSUB:
+        case VMUL:{                                                                         //dst, first, second, count
+            BlockArgs(ctx, args, 4);
+            if (BadBlock(args[0], args[3]) || BadBlock(args[1], args[3]) || BadBlock(args[2], args[3])) return SPU_ERR_RAM;
+
+            MarkRam(ctx, args[0], args[3]);
+
+            if      (op == VADD) ctx->kernels->add(RAM + args[0], RAM + args[1], RAM + args[2], (size_t)args[3]);
+            else if (op == VSUB) ctx->kernels->sub(RAM + args[0], RAM + args[1], RAM + args[2], (size_t)args[3]);
+            else                 ctx->kernels->mul(RAM + args[0], RAM + args[1], RAM + args[2], (size_t)args[3]);
+            return SPU_READY;
+        }
+
+        case VSCALE:{                                                                       //dst, src, factor, count
+            BlockArgs(ctx, args, 4);
+            if (BadBlock(args[0], args[3]) || BadBlock(args[1], args[3])) return SPU_ERR_RAM;
+
+            MarkRam(ctx, args[0], args[3]);
+            ctx->kernels->scale(RAM + args[0], RAM + args[1], args[2], (size_t)args[3]);
+            return SPU_READY;
+        }
+
+        case VDOT:{                                                                         //first, second, count
+            BlockArgs(ctx, args, 3);
+            if (BadBlock(args[0], args[2]) || BadBlock(args[1], args[2])) return SPU_ERR_RAM;
+
+            return Push(ctx, ctx->kernels->dot(RAM + args[0], RAM + args[1], (size_t)args[2]));
+        }
+
+        case VSUM:
+        case VMIN:
+        case VMAX:
+        default:{                                                                           //src, count
+            BlockArgs(ctx, args, 2);
+            if (BadBlock(args[0], args[1])) return SPU_ERR_RAM;
+
+            const int64_t* src = RAM + args[0];
+            size_t         count = (size_t)args[1];
+
+            if      (op == VSUM) return Push(ctx, ctx->kernels->sum(src, count));
+            else if (op == VMIN) return Push(ctx, ctx->kernels->min(src, count));
+            else                 return Push(ctx, ctx->kernels->max(src, count));
+        }
+    }
+}
+
+/*=================================================================*/
+//the only fuel check: a block is paid for when a jump, call or ret lands on it
+
+static inline spuStatus Enter(spuContext_t* ctx){
+    uint32_t cost = ctx->program->blockCost[ctx->pc];
+    if (ctx->fuel < cost) return SPU_OUT_OF_FUEL;
+
+    ctx->fuel -= cost;
+
+    return SPU_READY;
+}
+
+/*=================================================================*/
+//one instruction at ctx->pc, ctx->pc moves on only when it did not fail
+
+static inline spuStatus Step(spuContext_t* ctx){
+    const int64_t* code    = ctx->program->code;
+    size_t         pc      = ctx->pc;
+    int64_t        command = code[pc];
+    int64_t        op      = command & OPERATOR_MASK;
+    spuStatus      status  = SPU_READY;
+    int64_t        first   = 0;
+    int64_t        second  = 0;
+
+    switch (op){
+        case PUSH:{
+            int64_t* src = Operand(ctx, &pc);
+            if (!src) return SPU_ERR_RAM;
+
+            status = Push(ctx, *src);
+            break;
+        }
+
+        case POP:{
+            int64_t* dst = Operand(ctx, &pc);
+            if (!dst) return SPU_ERR_RAM;
+
+            if (command & memoryMask) MarkRam(ctx, dst - ctx->RAM, 1);
+            status = Pop(ctx, dst);
+            break;
+        }
+
+        case ADD:   case SUB:   case MUL:   case DIV:   case MOD:
+        case LS_EQ: case MR_EQ: case EQL:   case LS:    case MR:
+        case FADD:  case FSUB:  case FMUL:  case FDIV:{
+            if (ctx->sp < 2) return SPU_ERR_STACK;
+
+            first  = ctx->stack[ctx->sp - 1];
+            second = ctx->stack[ctx->sp - 2];
+
+            status = Binary(op, first, second, ctx->stack + ctx->sp - 2);
+            if (status) return status;
+
+            ctx->sp--;
+            pc++;
+            break;
+        }
+
+        case SQRT:  case SIN:   case COS:
+        case FSQRT: case FSIN:  case FCOS:  case ITOF:  case FTOI:{
+            if (!ctx->sp) return SPU_ERR_STACK;
+
+            ctx->stack[ctx->sp - 1] = Unary(op, ctx->stack[ctx->sp - 1]);
+            pc++;
+            break;
+        }
+
+        case OUT:
+        case FOUT:{
+            if ((status = Pop(ctx, &first))) return status;
+
+            ctx->io.output(ctx->io.data, first, op == FOUT);
+            pc++;
+            break;
+        }
+
+        case IN:
+        case FIN:{
+            int got = ctx->io.input(ctx->io.data, &first, op == FIN);
+            if (got == SPU_IO_BLOCKED) return SPU_BLOCKED;
+            if (got)                   first = 0;
+
+            status = Push(ctx, first);
+            pc++;
+            break;
+        }
+
+        case JMP:   ctx->pc = (size_t)code[pc + 1];                                         return Enter(ctx);
+
+        case JA:    case JAE:   case JE:    case JNE:{
+            if (ctx->sp < 2) return SPU_ERR_STACK;
+
+            first    = ctx->stack[--ctx->sp];
+            second   = ctx->stack[--ctx->sp];
+            ctx->pc  = (Taken(op, first, second)) ? (size_t)code[pc + 1] : pc + 2;
+            return Enter(ctx);
+        }
+
+        case CALL:{
+            if (ctx->csp == ctx->sizeCalls && GrowCalls(ctx)) return SPU_ERR_MEMORY;
+
+            ctx->calls[ctx->csp++] = pc;
+            ctx->pc = (size_t)code[pc + 1];
+            return Enter(ctx);
+        }
+
+        case RET:{
+            if (!ctx->csp) return SPU_ERR_RET;
+
+            ctx->pc = ctx->calls[--ctx->csp] + 2;
+            return Enter(ctx);
+        }
+
+        case FILL:  case COPY:  case CMP:
+        case VADD:  case VSUB:  case VMUL:  case VSCALE:
+        case VDOT:  case VSUM:  case VMIN:  case VMAX:{
+            status = Block(ctx, op);
+            pc    += InstructionLength(command);
+            break;
+        }
+
+        case DUMP:
+        case DRAW:  pc++;                                                                   break;
+
+        case SNAP:{
+            if (ctx->stopAtSnap) return SPU_SNAPPED;
+
+            pc++;
+            break;
+        }
+
+        case HLT:   return SPU_HALTED;
+
+        default:    return SPU_ERR_PC;                                                      //the 0 past the end
+    }
+
+    if (!status) ctx->pc = pc;
+
+    return status;
+}
+
+/*=================================================================*/
+
+spuStatus SpuRunSlice(spuContext_t* ctx, uint64_t fuel){
+    if (!ctx || !ctx->program) return SPU_ERR_MEMORY;
+    if (ctx->status != SPU_READY) return ctx->status;
+
+    const uint32_t* blockCost = ctx->program->blockCost;
+    uint64_t        charged   = blockCost[ctx->pc];
+
+    ctx->fuel = (fuel > charged) ? fuel - charged : 0;
+    uint64_t start = ctx->fuel;
+
+    spuStatus status = SPU_READY;
+    while (!status) status = Step(ctx);
+
+    charged += start - ctx->fuel;
+
+    //the block it stopped in was paid for in full, give back what did not run
+    if      (status == SPU_HALTED)      charged -= blockCost[ctx->pc] - 1;
+    else if (status != SPU_OUT_OF_FUEL) charged -= blockCost[ctx->pc];
+
+    ctx->instructions += charged;
+
+    if (status == SPU_OUT_OF_FUEL || status == SPU_BLOCKED || status == SPU_SNAPPED) return status;
+
+    ctx->status = status;
+
+    if (status == SPU_HALTED) ctx->pc++;
+    else                      ctx->errorPc = ctx->pc;
+
+    return status;
+}
+
+/*=================================================================*/
+
+spuStatus SpuRun(spuContext_t* ctx){
+    return SpuRunSlice(ctx, UINT64_MAX);
+}
+
+/*=================================================================*/
+
+const char* SpuStatusName(spuStatus status){
+    switch (status){
+        case SPU_READY:         return "ready";
+        case SPU_HALTED:        return "halted";
+        case SPU_OUT_OF_FUEL:   return "out of fuel";
+        case SPU_BLOCKED:       return "waiting for input";
+        case SPU_SNAPPED:       return "stopped at snap";
+        case SPU_ERR_STACK:     return "pop from an empty stack";
+        case SPU_ERR_RET:       return "ret without a call";
+        case SPU_ERR_RAM:       return "RAM address out of range";
+        case SPU_ERR_DIV:       return "division by zero";
+        case SPU_ERR_PC:        return "ran past the end of the code";
+        case SPU_ERR_MEMORY:    return "out of memory";
+        default:                return "unknown status";
+    }
+}
@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/lines.hpp"
+
+const size_t MAX_VARINT = 10;                                   //bytes of a 64 bit one
+
+/*=================================================================*/
+
+static size_t PutVarint(uint8_t* out, uint64_t value){
+    size_t size = 0;
+
+    while (value >= 0x80){
+        out[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    out[size++] = (uint8_t)value;
+
+    return size;
+}
+
+//0 - ok, -1 - runs past end
+static int GetVarint(const uint8_t** in, const uint8_t* end, uint64_t* value){
+    uint64_t result = 0;
+
+    for (unsigned shift = 0; shift < 64 && *in < end; shift += 7){
+        uint8_t byte = *(*in)++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)){
+            *value = result;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static inline uint64_t ZigZag(int64_t value){
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t UnZigZag(uint64_t value){
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline size_t Align8(size_t size){
+    return (size + 7) & ~(size_t)7;
+}
+
+/*=================================================================*/
+
+int EncodeLines(const lineRow_t* rows, size_t numRows, const char* const* files, size_t numFiles,
+                char** section, size_t* size){
+    if (!section || !size || (numRows && !rows) || (numFiles && !files)) return -1;
+
+    size_t sizeNames = 0;
+    for (size_t i = 0; i < numFiles; i++) sizeNames += strlen(files[i]) + 1;
+
+    size_t   sizeMax = sizeof(linesHeader_t) + Align8(sizeNames) + numRows * 3 * MAX_VARINT + 8;
+    char*    buffer  = (char*)calloc(sizeMax, 1);
+    if (!buffer) return -1;
+
+    char* names = buffer + sizeof(linesHeader_t);
+    for (size_t i = 0; i < numFiles; i++){
+        size_t length = strlen(files[i]) + 1;
+
+        memcpy(names, files[i], length);
+        names += length;
+    }
+
+    uint8_t* out  = (uint8_t*)buffer + sizeof(linesHeader_t) + Align8(sizeNames);
+    uint8_t* row  = out;
+    int64_t  pc   = 0;
+    uint64_t line = 0;
+    uint64_t file = 0;
+
+    for (size_t i = 0; i < numRows; i++){
+        if (rows[i].pc < pc || rows[i].file >= numFiles){
+            free(buffer);
+            return -1;
+        }
+
+        bool newFile = (rows[i].file != file);
+
+        row += PutVarint(row, ((uint64_t)(rows[i].pc - pc) << 1) | newFile);
+        if (newFile) row += PutVarint(row, rows[i].file);
+        row += PutVarint(row, ZigZag((int64_t)(rows[i].line - line)));
+
+        pc   = rows[i].pc;
+        line = rows[i].line;
+        file = rows[i].file;
+    }
+
+    linesHeader_t header = {numFiles, numRows, Align8(sizeNames), (size_t)(row - out)};
+    memcpy(buffer, &header, sizeof(header));
+
+    *section = buffer;
+    *size    = sizeof(linesHeader_t) + header.sizeNames + Align8(header.sizeRows);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int CompareSymbols(const void* first, const void* second){
+    int64_t a = (*(const containerSymbol_t* const*)first)->addr;
+    int64_t b = (*(const containerSymbol_t* const*)second)->addr;
+
+    return (a > b) - (a < b);
+}
+
+//records are 8 byte aligned in the mapped file, names run to the padding
+static int ReadSymbols(lineTable_t* table, container_t* container){
+    size_t      size  = 0;
+    const char* bytes = (const char*)ContainerSection(container, SECTION_SYMBOLS, &size);
+    if (!bytes) return ContainerFind(container, SECTION_SYMBOLS) ? -1 : 0;
+
+    size_t numSymbols = 0;
+
+    for (size_t offset = 0; offset < size; numSymbols++){
+        const containerSymbol_t* symbol = (const containerSymbol_t*)(bytes + offset);
+
+        if (size - offset < sizeof(containerSymbol_t) || symbol->nameSize > size - offset - sizeof(containerSymbol_t)) return -1;
+        offset += sizeof(containerSymbol_t) + Align8(symbol->nameSize);
+    }
+
+    table->symbols = (const containerSymbol_t**)calloc(sizeof(containerSymbol_t*), numSymbols + 1);
+    if (!table->symbols) return -1;
+
+    for (size_t offset = 0; offset < size; ){
+        const containerSymbol_t* symbol = (const containerSymbol_t*)(bytes + offset);
+
+        table->symbols[table->numSymbols++] = symbol;
+        offset += sizeof(containerSymbol_t) + Align8(symbol->nameSize);
+    }
+
+    qsort(table->symbols, table->numSymbols, sizeof(containerSymbol_t*), CompareSymbols);
+
+    return 0;
+}
+
+static int ReadFiles(lineTable_t* table, const linesHeader_t* header, const char* names){
+    table->fileNames = (const char**)calloc(sizeof(char*), header->numFiles + 1);
+    if (!table->fileNames) return -1;
+
+    const char* end = names + header->sizeNames;
+
+    for (size_t i = 0; i < header->numFiles; i++){
+        const char* nul = (const char*)memchr(names, 0, (size_t)(end - names));
+        if (!nul) return -1;
+
+        table->fileNames[table->numFiles++] = names;
+        names = nul + 1;
+    }
+
+    return 0;
+}
+
+static int ReadRows(lineTable_t* table, const linesHeader_t* header, const uint8_t* in){
+    const uint8_t* end = in + header->sizeRows;
+
+    if (header->numRows > header->sizeRows) return -1;                                  //every row is 2 bytes at least
+
+    table->pcs   = (int64_t*) calloc(sizeof(int64_t),  header->numRows + 1);
+    table->lines = (uint64_t*)calloc(sizeof(uint64_t), header->numRows + 1);
+    table->files = (uint64_t*)calloc(sizeof(uint64_t), header->numRows + 1);
+    if (!table->pcs || !table->lines || !table->files) return -1;
+
+    int64_t  pc   = 0;
+    uint64_t line = 0;
+    uint64_t file = 0;
+
+    for (size_t i = 0; i < header->numRows; i++){
+        uint64_t pcDelta = 0, lineDelta = 0;
+
+        if (GetVarint(&in, end, &pcDelta))                          return -1;
+        if ((pcDelta & 1) && GetVarint(&in, end, &file))            return -1;
+        if (GetVarint(&in, end, &lineDelta) || file >= table->numFiles) return -1;
+
+        pc   += (int64_t)(pcDelta >> 1);
+        line += (uint64_t)UnZigZag(lineDelta);
+
+        table->pcs[i]   = pc;
+        table->lines[i] = line;
+        table->files[i] = file;
+        table->numRows++;
+    }
+
+    return 0;
+}
+
+int LineTableCtor(lineTable_t* table, container_t* container){
+    if (!table || !container) return -1;
+
+    *table = {};
+
+    size_t      size  = 0;
+    const char* bytes = (const char*)ContainerSection(container, SECTION_LINES, &size);
+    if (!bytes || size < sizeof(linesHeader_t)) return -1;
+
+    linesHeader_t header = {};
+    memcpy(&header, bytes, sizeof(header));
+
+    int status = (header.sizeNames > size - sizeof(header) || header.sizeRows > size - sizeof(header) - header.sizeNames) ? -1 : 0;
+
+    if (!status) status = ReadFiles(table, &header, bytes + sizeof(header));
+    if (!status) status = ReadRows (table, &header, (const uint8_t*)bytes + sizeof(header) + header.sizeNames);
+    if (!status) status = ReadSymbols(table, container);
+
+    if (status) LineTableDtor(table);
+
+    return status;
+}
+
+/*=================================================================*/
+
+int LineTableDtor(lineTable_t* table){
+    if (!table) return -1;
+
+    free(table->pcs);
+    free(table->lines);
+    free(table->files);
+    free(table->fileNames);
+    free(table->symbols);
+    *table = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int LineTableFind(const lineTable_t* table, int64_t pc, sourceLine_t* line){
+    if (!table || !line || !table->numRows || pc < table->pcs[0]) return -1;
+
+    size_t low = 0, high = table->numRows;                                              //last row at or before pc
+
+    while (high - low > 1){
+        size_t middle = (low + high) / 2;
+
+        if (table->pcs[middle] <= pc) low  = middle;
+        else                          high = middle;
+    }
+
+    *line      = {};
+    line->file = table->fileNames[table->files[low]];
+    line->line = table->lines[low];
+
+    low  = 0;
+    high = table->numSymbols;
+
+    while (low < high){                                                                 //first symbol past pc
+        size_t middle = (low + high) / 2;
+
+        if (table->symbols[middle]->addr <= pc) low  = middle + 1;
+        else                                    high = middle;
+    }
+
+    if (low){
+        const containerSymbol_t* symbol = table->symbols[low - 1];
+
+        line->label     = (const char*)(symbol + 1);
+        line->labelSize = symbol->nameSize;
+        line->labelAddr = symbol->addr;
+    }
+
+    return 0;
+}
@@ -0,0 +1,730 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/optimizer.hpp"
+
+const size_t MAX_OPT_ROUNDS     = 16;
+const size_t MAX_INLINE_INSTRS  = 8;                                    //leaf body without the ret
+
+const char   PROFILE_SIGNATURE[] = "spu-profile";
+
+/*=================================================================*/
+
+static inline bool IsPushImm(const optInstr_t* instr){
+    return instr->command == (PUSH | immediateMask);
+}
+
+static inline bool IsPushReg(const optInstr_t* instr){
+    return instr->command == (PUSH | registerMask);
+}
+
+static inline bool IsPopReg(const optInstr_t* instr){
+    return instr->command == (POP | registerMask);
+}
+
+static inline bool IsJump(const optInstr_t* instr){
+    const instruction_t* instruction = FindInstructionByCode(instr->command);
+
+    return instruction && instruction->args == ARGS_LABEL;
+}
+
+static inline bool IsRet(const optInstr_t* instr){
+    return instr->command == RET;
+}
+
+static inline bool IsBranch(const optInstr_t* instr){                  //jumps that end a block, calls come back
+    return IsJump(instr) && instr->command != CALL;
+}
+
+static inline bool EndsFlow(const optInstr_t* instr){                  //no fall through to the next instruction
+    int64_t op = instr->command & OPERATOR_MASK;
+
+    return op == JMP || op == RET || op == HLT || op == EXIT;
+}
+
+/*=================================================================*/
+
+int OptimizerCtor(optimizer_t* opt, const int64_t* code, size_t numCommands){
+    if (!opt || !code) return -1;
+
+    *opt = {};
+    opt->numCommands = numCommands;
+    opt->sizeInstrs  = numCommands + 1;
+    opt->instrs      = (optInstr_t*)calloc(sizeof(optInstr_t), opt->sizeInstrs);
+    opt->addrIndex   = (int64_t*)   calloc(sizeof(int64_t),    numCommands + 1);
+    if (!opt->instrs || !opt->addrIndex) return -1;
+
+    for (size_t addr = 0; addr <= numCommands; addr++) opt->addrIndex[addr] = -1;
+
+    for (size_t addr = 0; addr < numCommands; ){
+        optInstr_t* instr = opt->instrs + opt->numInstrs;
+
+        if (!FindInstructionByCode(code[addr])) return -1;
+
+        instr->command = code[addr];
+        instr->length  = InstructionLength(code[addr]);
+        if (addr + instr->length > numCommands) return -1;
+
+        for (size_t i = 1; i < instr->length; i++) instr->args[i - 1] = code[addr + i];
+
+        opt->addrIndex[addr] = (int64_t)opt->numInstrs++;
+        addr += instr->length;
+    }
+
+    opt->addrIndex[numCommands] = (int64_t)opt->numInstrs;                                 //label at the very end
+
+    for (size_t i = 0; i < opt->numInstrs; i++){
+        optInstr_t* instr = opt->instrs + i;
+        if (!IsJump(instr)) continue;
+
+        int64_t addr = instr->args[0];
+        if (addr < 0 || (size_t)addr > numCommands || opt->addrIndex[addr] == -1) return -1;
+
+        instr->target = (size_t)opt->addrIndex[addr];
+    }
+
+    opt->indexMap = (size_t*)calloc(sizeof(size_t), opt->numInstrs + 1);
+    if (!opt->indexMap) return -1;
+
+    for (size_t i = 0; i <= opt->numInstrs; i++) opt->indexMap[i] = i;
+
+    opt->numInput = opt->numInstrs;
+
+    opt->report.instrsBefore = opt->numInstrs;
+    opt->report.wordsBefore  = numCommands;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int OptimizerDtor(optimizer_t* opt){
+    if (!opt) return -1;
+
+    free(opt->instrs);
+    free(opt->addrIndex);
+    free(opt->indexMap);
+    *opt = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+//drops removed instructions, a jump to one lands on the next instruction left
+
+static int Compact(optimizer_t* opt){
+    size_t* newIndex = (size_t*)calloc(sizeof(size_t), opt->numInstrs + 1);
+    if (!newIndex) return -1;
+
+    size_t numLive = 0;
+    for (size_t i = 0; i < opt->numInstrs; i++){
+        newIndex[i] = numLive;
+        if (!opt->instrs[i].removed) numLive++;
+    }
+    newIndex[opt->numInstrs] = numLive;
+
+    for (size_t i = 0, live = 0; i < opt->numInstrs; i++){
+        if (opt->instrs[i].removed) continue;
+
+        opt->instrs[live] = opt->instrs[i];
+        if (IsJump(opt->instrs + live)) opt->instrs[live].target = newIndex[opt->instrs[live].target];
+
+        live++;
+    }
+
+    for (size_t i = 0; i <= opt->numInput; i++) opt->indexMap[i] = newIndex[opt->indexMap[i]];
+
+    opt->numInstrs = numLive;
+    free(newIndex);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static void MarkLeaders(optimizer_t* opt){
+    for (size_t i = 0; i < opt->numInstrs; i++) opt->instrs[i].leader = false;
+
+    for (size_t i = 0; i < opt->numInstrs; i++){
+        optInstr_t* instr = opt->instrs + i;
+
+        if (IsJump(instr) && instr->target < opt->numInstrs) opt->instrs[instr->target].leader = true;
+    }
+}
+
+/*=================================================================*/
+//top - the value pushed last, the processor pops it first
+
+static bool FoldBinary(int64_t op, int64_t top, int64_t second, int64_t* result){
+    uint64_t a = (uint64_t)top, b = (uint64_t)second;
+
+    switch (op){
+        case ADD:   *result = (int64_t)(a + b);     return true;
+        case SUB:   *result = (int64_t)(a - b);     return true;
+        case MUL:   *result = (int64_t)(a * b);     return true;
+
+        case DIV:
+        case MOD:
+            if (second == 0 || (top == INT64_MIN && second == -1)) return false;    //left to fail at run time
+
+            *result = (op == DIV) ? top / second : top % second;
+            return true;
+
+        case LS_EQ: *result = (top <= second);      return true;
+        case MR_EQ: *result = (top >= second);      return true;
+        case EQL:   *result = (top == second);      return true;
+        case LS:    *result = (top <  second);      return true;
+        case MR:    *result = (top >  second);      return true;
+
+        default:    return false;
+    }
+}
+
+/*=================================================================*/
+//patterns never start a jump target in the middle
+
+static bool PeepholePass(optimizer_t* opt){
+    optInstr_t* instrs = opt->instrs;
+    size_t      n      = opt->numInstrs;
+    bool        changed = false;
+
+    for (size_t i = 0; i < n; i++){
+        optInstr_t* first = instrs + i;
+        if (first->removed) continue;
+
+        optInstr_t* second = (i + 1 < n && !instrs[i + 1].leader) ? instrs + i + 1 : nullptr;
+        optInstr_t* third  = (second && i + 2 < n && !instrs[i + 2].leader) ? instrs + i + 2 : nullptr;
+
+        int64_t result = 0;
+
+        if (third && IsPushImm(first) && IsPushImm(second) &&                                  //push N; push M; add
+            FoldBinary(third->command, second->args[0], first->args[0], &result)){
+
+            first->args[0]  = result;
+            second->removed = true;
+            third->removed  = true;
+            opt->report.numFolded++;
+
+            changed = true;
+            i += 2;
+        }
+
+        else if (second && IsPushImm(first) && ((first->args[0] == 1 && second->command == MUL) ||
+                                                (first->args[0] == 0 && second->command == ADD))){
+            first->removed  = true;
+            second->removed = true;
+            opt->report.numIdentities++;
+
+            changed = true;
+            i++;
+        }
+
+        else if (second && IsPushReg(first) && IsPopReg(second) && first->args[0] == second->args[0]){
+            first->removed  = true;
+            second->removed = true;
+            opt->report.numRoundTrips++;
+
+            changed = true;
+            i++;
+        }
+    }
+
+    return changed;
+}
+
+/*=================================================================*/
+
+static bool ThreadJumps(optimizer_t* opt){
+    optInstr_t* instrs = opt->instrs;
+    size_t      n      = opt->numInstrs;
+    bool        changed = false;
+
+    for (size_t i = 0; i < n; i++){
+        if (!IsJump(instrs + i)) continue;
+
+        size_t target = instrs[i].target;
+
+        for (size_t hops = 0; target < n && instrs[target].command == JMP && instrs[target].target != target && hops < n; hops++){
+            target = instrs[target].target;
+        }
+
+        if (target != instrs[i].target){
+            instrs[i].target = target;
+            opt->report.numThreaded++;
+            changed = true;
+        }
+
+        if (instrs[i].command == JMP && instrs[i].target == i + 1){
+            instrs[i].removed = true;
+            opt->report.numJumpsToNext++;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/*=================================================================*/
+//code after hlt, jmp and ret that nothing jumps to
+
+static bool RemoveDeadCode(optimizer_t* opt){
+    optInstr_t* instrs = opt->instrs;
+    size_t      n      = opt->numInstrs;
+
+    size_t* stack = (size_t*)calloc(sizeof(size_t), 2 * n + 1);
+    if (!stack) return false;                                           //keeping dead code is always safe
+
+    size_t top = 0;
+    for (size_t i = 0; i < n; i++) instrs[i].reachable = false;
+
+    if (n) stack[top++] = 0;
+
+    while (top){
+        size_t i = stack[--top];
+        if (i >= n || instrs[i].reachable) continue;
+
+        instrs[i].reachable = true;
+
+        if (!EndsFlow(instrs + i)) stack[top++] = i + 1;
+        if (IsJump(instrs + i))    stack[top++] = instrs[i].target;
+    }
+
+    free(stack);
+
+    bool changed = false;
+
+    for (size_t i = 0; i < n; i++){
+        if (instrs[i].reachable || instrs[i].removed) continue;
+
+        instrs[i].removed = true;
+        opt->report.numDead++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+/*=================================================================*/
+//straight-line code from the entry up to a ret, nothing to inline if -1
+
+static int64_t LeafSize(const optimizer_t* opt, size_t entry){
+    for (size_t i = entry; i < opt->numInstrs && i - entry <= MAX_INLINE_INSTRS; i++){
+        const optInstr_t* instr = opt->instrs + i;
+
+        if (IsRet(instr))                       return (int64_t)(i - entry);
+        if (IsJump(instr) || EndsFlow(instr))   return -1;              //calls too, so no recursion
+    }
+
+    return -1;
+}
+
+/*=================================================================*/
+//call of a small leaf becomes a copy of its body, the leaf itself dies if nothing else calls it
+
+static int InlineCalls(optimizer_t* opt){
+    size_t n       = opt->numInstrs;
+    size_t newSize = 0;
+
+    int64_t* leafSize = (int64_t*)calloc(sizeof(int64_t), n + 1);
+    size_t*  newIndex = (size_t*) calloc(sizeof(size_t),  n + 1);
+    if (!leafSize || !newIndex){
+        free(leafSize);
+        free(newIndex);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        optInstr_t* instr = opt->instrs + i;
+
+        leafSize[i] = (instr->command == CALL) ? LeafSize(opt, instr->target) : -1;
+        newSize    += (leafSize[i] == -1) ? 1 : (size_t)leafSize[i];
+    }
+
+    optInstr_t* newInstrs = (optInstr_t*)calloc(sizeof(optInstr_t), newSize + 1);
+    if (!newInstrs){
+        free(leafSize);
+        free(newIndex);
+        return -1;
+    }
+
+    size_t live = 0;
+    for (size_t i = 0; i < n; i++){
+        newIndex[i] = live;
+
+        if (leafSize[i] == -1){
+            newInstrs[live++] = opt->instrs[i];
+            continue;
+        }
+
+        size_t entry = opt->instrs[i].target;
+        for (size_t k = 0; k < (size_t)leafSize[i]; k++){
+            newInstrs[live] = opt->instrs[entry + k];
+            newInstrs[live].leader = false;
+            live++;
+        }
+
+        opt->report.numInlined++;
+    }
+    newIndex[n] = live;
+
+    for (size_t i = 0; i < live; i++){
+        if (IsJump(newInstrs + i)) newInstrs[i].target = newIndex[newInstrs[i].target];
+    }
+
+    for (size_t i = 0; i <= opt->numInput; i++) opt->indexMap[i] = newIndex[opt->indexMap[i]];
+
+    free(opt->instrs);
+    opt->instrs     = newInstrs;
+    opt->numInstrs  = live;
+    opt->sizeInstrs = newSize + 1;
+
+    free(leafSize);
+    free(newIndex);
+
+    return 0;
+}
+
+/*=================================================================*/
+//call X; ret - X returns straight to our caller, the return stack does not grow
+
+static bool EliminateTailCalls(optimizer_t* opt){
+    optInstr_t* instrs = opt->instrs;
+    size_t      n      = opt->numInstrs;
+    bool        changed = false;
+
+    for (size_t i = 0; i + 1 < n; i++){
+        if (instrs[i].command != CALL) continue;
+
+        size_t next = i + 1;
+        for (size_t hops = 0; next < n && instrs[next].command == JMP && hops < n; hops++) next = instrs[next].target;
+
+        if (next >= n || !IsRet(instrs + next)) continue;
+
+        instrs[i].command = JMP;
+        opt->report.numTailCalls++;
+        changed = true;
+    }
+
+    return changed;
+}
+
+/*=================================================================*/
+
+int LoadProfile(optimizer_t* opt, const char* fileName){
+    if (!opt || !fileName) return -1;
+
+    FILE* file = fopen(fileName, "r");
+    if (!file) return -1;
+
+    char     signature[sizeof(PROFILE_SIGNATURE)] = {};
+    size_t   numCommands = 0;
+    int      status      = 0;
+
+    if (fscanf(file, "%11s %lu", signature, &numCommands) != 2 ||
+        strcmp(signature, PROFILE_SIGNATURE) || numCommands != opt->numCommands) status = -1;
+
+    size_t   pc = 0;
+    uint64_t executed = 0, taken = 0;
+
+    while (!status && fscanf(file, "%lu %lu %lu", &pc, &executed, &taken) == 3){
+        if (pc >= opt->numCommands || opt->addrIndex[pc] == -1){
+            status = -1;
+            break;
+        }
+
+        optInstr_t* instr = opt->instrs + opt->addrIndex[pc];
+        if (!IsJump(instr) || taken > executed){
+            status = -1;
+            break;
+        }
+
+        instr->executed = executed;
+        instr->taken    = taken;
+    }
+
+    fclose(file);
+    if (status) return -1;
+
+    opt->profiled = true;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static void FreeLayout(size_t* begin, size_t* blockOf, uint64_t* heat, size_t* order, bool* placed, size_t* newIndex){
+    free(begin);
+    free(blockOf);
+    free(heat);
+    free(order);
+    free(placed);
+    free(newIndex);
+}
+
+/*=================================================================*/
+//next block to place after cur: the hotter of fall through and branch target that is not placed yet
+
+static int64_t HotSuccessor(const optimizer_t* opt, const size_t* begin, const size_t* blockOf,
+                            const bool* placed, size_t numBlocks, size_t cur){
+    const optInstr_t* last = opt->instrs + begin[cur + 1] - 1;
+
+    int64_t  best       = -1;
+    uint64_t bestWeight = 0;
+
+    if (!EndsFlow(last) && cur + 1 < numBlocks && !placed[cur + 1]){
+        best       = (int64_t)cur + 1;
+        bestWeight = (IsBranch(last)) ? last->executed - last->taken : 1;
+    }
+
+    if (IsBranch(last) && !placed[blockOf[last->target]] && last->taken > bestWeight){
+        best       = (int64_t)blockOf[last->target];
+        bestWeight = last->taken;
+    }
+
+    return (bestWeight) ? best : -1;
+}
+
+/*=================================================================*/
+//greedy chains of hot blocks, hottest chain first, blocks that never ran go to the end
+
+static int LayoutBlocks(optimizer_t* opt){
+    size_t n = opt->numInstrs;
+    if (!n || !EndsFlow(opt->instrs + n - 1)) return 0;                 //runs off the end, keep the order
+
+    for (size_t i = 0; i < n; i++){
+        if (IsJump(opt->instrs + i) && opt->instrs[i].target >= n) return 0;
+    }
+
+    size_t*   begin    = (size_t*)  calloc(sizeof(size_t),   n + 1);
+    size_t*   blockOf  = (size_t*)  calloc(sizeof(size_t),   n + 1);
+    uint64_t* heat     = (uint64_t*)calloc(sizeof(uint64_t), n + 1);
+    size_t*   order    = (size_t*)  calloc(sizeof(size_t),   n + 1);
+    bool*     placed   = (bool*)    calloc(sizeof(bool),     n + 1);
+    size_t*   newIndex = (size_t*)  calloc(sizeof(size_t),   n + 1);
+
+    if (!begin || !blockOf || !heat || !order || !placed || !newIndex){
+        FreeLayout(begin, blockOf, heat, order, placed, newIndex);
+        return -1;
+    }
+
+    optInstr_t* instrs = opt->instrs;
+
+    for (size_t i = 0; i < n; i++){                                     //placed[] marks block starts for now
+        if (i == 0)                                         placed[i] = true;
+        if (IsJump(instrs + i))                             placed[instrs[i].target] = true;
+        if ((IsBranch(instrs + i) || EndsFlow(instrs + i)) && i + 1 < n) placed[i + 1] = true;
+    }
+
+    size_t numBlocks = 0;
+    for (size_t i = 0; i < n; i++){
+        if (placed[i]) begin[numBlocks++] = i;
+        blockOf[i] = numBlocks - 1;
+        placed[i]  = false;
+    }
+    begin[numBlocks] = n;
+
+    for (size_t i = 0; i < n; i++){
+        if (IsJump(instrs + i)) heat[blockOf[instrs[i].target]] += instrs[i].taken;
+    }
+
+    heat[0]++;                                                          //entry
+    for (size_t b = 1; b < numBlocks; b++){
+        const optInstr_t* last = instrs + begin[b] - 1;
+
+        if      (EndsFlow(last))    continue;
+        else if (IsBranch(last))    heat[b] += last->executed - last->taken;
+        else                        heat[b] += heat[b - 1];
+    }
+
+    size_t numPlaced = 0;
+    int64_t cur = 0;
+
+    while (numPlaced < numBlocks){
+        if (cur == -1){
+            for (size_t b = 0; b < numBlocks; b++){
+                if (!placed[b] && heat[b] && (cur == -1 || heat[b] > heat[cur])) cur = (int64_t)b;
+            }
+        }
+
+        if (cur == -1) break;
+
+        placed[cur] = true;
+        order[numPlaced++] = (size_t)cur;
+
+        cur = HotSuccessor(opt, begin, blockOf, placed, numBlocks, (size_t)cur);
+    }
+
+    size_t numHot = numPlaced;
+    for (size_t b = 0; b < numBlocks; b++){
+        if (!placed[b]) order[numPlaced++] = b;
+    }
+
+    size_t newSize = n + numBlocks;                                     //at most one jump added per block
+    optInstr_t* newInstrs = (optInstr_t*)calloc(sizeof(optInstr_t), newSize + 1);
+    if (!newInstrs){
+        FreeLayout(begin, blockOf, heat, order, placed, newIndex);
+        return -1;
+    }
+
+    size_t live = 0;
+    for (size_t k = 0; k < numBlocks; k++){
+        size_t b = order[k];
+        if (b != k) opt->report.numBlocksMoved++;
+
+        for (size_t i = begin[b]; i < begin[b + 1]; i++){
+            newIndex[i] = live;
+            newInstrs[live] = instrs[i];
+            newInstrs[live].cold = (k >= numHot);
+            live++;
+        }
+
+        optInstr_t* last = newInstrs + live - 1;
+        if (EndsFlow(last) || (k + 1 < numBlocks && order[k + 1] == b + 1)) continue;
+
+        if ((last->command == JE || last->command == JNE) && k + 1 < numBlocks && order[k + 1] == blockOf[last->target]){
+            last->command = (last->command == JE) ? JNE : JE;               //branch to the old fall through instead
+            last->target  = begin[b + 1];
+            last->taken   = last->executed - last->taken;
+            opt->report.numInverted++;
+            continue;
+        }
+
+        optInstr_t* jump = newInstrs + live++;                          //the old fall through, also where a call returns
+        jump->command = JMP;
+        jump->length  = InstructionLength(JMP);
+        jump->target  = begin[b + 1];
+        jump->cold    = last->cold;
+        opt->report.numJumpsAdded++;
+    }
+    newIndex[n] = live;
+
+    for (size_t i = 0; i < live; i++){
+        if (IsJump(newInstrs + i)) newInstrs[i].target = newIndex[newInstrs[i].target];
+    }
+
+    for (size_t i = 0; i <= opt->numInput; i++) opt->indexMap[i] = newIndex[opt->indexMap[i]];
+
+    free(opt->instrs);
+    opt->instrs     = newInstrs;
+    opt->numInstrs  = live;
+    opt->sizeInstrs = newSize + 1;
+
+    FreeLayout(begin, blockOf, heat, order, placed, newIndex);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int RunRounds(optimizer_t* opt){
+    for (size_t round = 0; round < MAX_OPT_ROUNDS; round++){
+        bool changed = false;
+
+        MarkLeaders(opt);
+        changed |= PeepholePass(opt);
+        if (Compact(opt)) return -1;
+
+        changed |= EliminateTailCalls(opt);
+        changed |= ThreadJumps(opt);
+        if (Compact(opt)) return -1;
+
+        changed |= RemoveDeadCode(opt);
+        if (Compact(opt)) return -1;
+
+        if (!changed) break;
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int OptimizeCode(optimizer_t* opt){
+    if (!opt || !opt->instrs) return -1;
+
+    if (InlineCalls(opt))   return -1;
+    if (RunRounds(opt))     return -1;
+
+    if (!opt->profiled) return 0;
+
+    if (LayoutBlocks(opt))  return -1;
+
+    return RunRounds(opt);                                              //jumps to the next block that now follows
+}
+
+/*=================================================================*/
+
+int EmitOptimized(optimizer_t* opt, int64_t** code, size_t* numCommands, int64_t* addrMap){
+    size_t* newAddr = (size_t*)calloc(sizeof(size_t), opt->numInstrs + 1);
+    if (!newAddr) return -1;
+
+    size_t size = 0;
+    opt->report.coldWords = 0;
+
+    for (size_t i = 0; i < opt->numInstrs; i++){
+        newAddr[i] = size;
+        size += opt->instrs[i].length;
+
+        if (!opt->instrs[i].cold) continue;
+
+        if (!opt->report.coldWords) opt->report.coldStart = newAddr[i];
+        opt->report.coldWords += opt->instrs[i].length;
+    }
+    newAddr[opt->numInstrs] = size;
+
+    int64_t* newCode = (int64_t*)calloc(sizeof(int64_t), size + 1);
+    if (!newCode){
+        free(newAddr);
+        return -1;
+    }
+
+    for (size_t i = 0; i < opt->numInstrs; i++){
+        optInstr_t* instr = opt->instrs + i;
+        int64_t*    word  = newCode + newAddr[i];
+
+        word[0] = instr->command;
+        for (size_t arg = 1; arg < instr->length; arg++) word[arg] = instr->args[arg - 1];
+
+        if (IsJump(instr)) word[1] = (int64_t)newAddr[instr->target];
+    }
+
+    for (size_t addr = 0; addr <= opt->numCommands; addr++){
+        int64_t index = opt->addrIndex[addr];
+
+        addrMap[addr] = (index == -1) ? -1 : (int64_t)newAddr[opt->indexMap[index]];
+    }
+
+    opt->report.instrsAfter = opt->numInstrs;
+    opt->report.wordsAfter  = size;
+
+    *code        = newCode;
+    *numCommands = size;
+
+    free(newAddr);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+void PrintOptReport(const optReport_t* report, FILE* file){
+    fprintf(file, "optimizer: %lu -> %lu instructions, %lu -> %lu bytes, saved %lu instructions and %lu bytes\n",
+                  report->instrsBefore, report->instrsAfter,
+                  report->wordsBefore * SIZE_ARG, report->wordsAfter * SIZE_ARG,
+                  report->instrsBefore - report->instrsAfter, (report->wordsBefore - report->wordsAfter) * SIZE_ARG);
+
+    fprintf(file, "    constants folded:    %lu\n", report->numFolded);
+    fprintf(file, "    identities removed:  %lu\n", report->numIdentities);
+    fprintf(file, "    push/pop round trips:%lu\n", report->numRoundTrips);
+    fprintf(file, "    jumps threaded:      %lu\n", report->numThreaded);
+    fprintf(file, "    jumps to next:       %lu\n", report->numJumpsToNext);
+    fprintf(file, "    calls inlined:       %lu\n", report->numInlined);
+    fprintf(file, "    tail calls:          %lu\n", report->numTailCalls);
+    fprintf(file, "    dead instructions:   %lu\n", report->numDead);
+
+    if (!report->numBlocksMoved && !report->coldWords) return;
+
+    fprintf(file, "    blocks moved:        %lu\n", report->numBlocksMoved);
+    fprintf(file, "    branches inverted:   %lu\n", report->numInverted);
+    fprintf(file, "    jumps added:         %lu\n", report->numJumpsAdded);
+    fprintf(file, "    cold code:           %lu words from address %lu\n", report->coldWords, report->coldStart);
+}
@@ -2,23 +2,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include "/Users/asssh/Desktop/mystack/mystack.hpp"
 #include "../hpp/operations.hpp"
 #include "../hpp/processor.hpp"
 #include "../hpp/colors.hpp"
+#include "../hpp/kernels.hpp"
+#include "../hpp/regvm.hpp"
+#include "../hpp/jit.hpp"
+#include "../hpp/green.hpp"
+#include "../hpp/container.hpp"
+#include "../hpp/lines.hpp"
 
 #define MEOW fprintf(stderr, "\e[0;31m" "\nmeow\n" "\e[0m");
 
-const int       REGISTER_NUM    = 4;
-const int       SIZE_RAM        = 1024;
-const int64_t   SIGNATURE       = 0x574f454d;
-const int64_t   VERSION         = 5;
-const int64_t   DRAW_RES_X      = 200;
-const int64_t   DRAW_RES_Y      = 200;
-
-const char      immediateMask   = 0b00100000;
-const char      registerMask    = 0b01000000;
-const char      memoryMask      = 0b10000000;
-
 typedef struct fileNames{
 
     const char* inputFileName;
@@ -27,6 +24,20 @@ typedef struct fileNames{
 
 } fileNames_t;
 
+typedef struct runOptions{
+    const char* profileFileName;                                    //-p, branch and call counts for compile -P
+    bool        registerTier;                                       //-r, hot code on the register vm
+    bool        jit;                                                //-j, hot loops traced to native code
+
+} runOptions_t;
+
+const int64_t MAX_PAR_THREADS = 256;
+
+typedef struct parGroup{
+    pthread_barrier_t   barrier;
+    int64_t             numThreads;
+} parGroup_t;
+
 typedef struct spu{
     const char*     name;
 
@@ -46,8 +57,20 @@ typedef struct spu{
 
     size_t          errorType;                                      //errors_t?
 
+    const vectorKernels_t* kernels;
+
+    uint64_t*       profileExecuted;                                //per pc, jumps and calls only
+    uint64_t*       profileTaken;
+
+
+    regVm_t*        regVm;
+    jit_t*          jit;
+    green_t         green;                                          //spawn, yield, join, exit
+    parGroup_t*     par;                                            //the par this thread runs in, nullptr - the first one
+    container_t     container;                                      //mapped while it runs, empty for a flat binary
 
     fileNames_t*    fileNames;
+    runOptions_t*   options;
     FILE*           logFile;
     FILE*           inputFile;
     FILE*           outputFile;
@@ -58,10 +81,15 @@ enum errors{
     ERR_NULLPTR_        = 1,
     ERR_                = 2,
     INVALID_VERSION     = 3,
-    INVALID_SIGNATURE   = 4
+    INVALID_SIGNATURE   = 4,
+    RAM_OUT_OF_RANGE    = 5,
+    THREAD_DEADLOCK     = 6,
+    BAD_THREAD_ID       = 7,
+    BAD_PAR_COUNT       = 8,
+    BAD_SECTION         = 9
 };
 
-void Run(fileNames_t* fileNames);
+void Run(fileNames_t* fileNames, runOptions_t* options);
 
 static errors ProcessorCtor     (spu_t* spu);
 static errors ProcessorDtor     (spu_t* spu);
@@ -69,17 +97,28 @@ static errors CheckSignature    (spu_t* spu);
 static errors FillCodeBuffer    (spu_t* spu);
 static errors PrintFilesData    (spu_t* spu);
 static errors ProcessorDump     (spu_t* spu);
+static errors WriteProfile      (spu_t* spu);
 
 /*=================================================================*/
 
 int main(int argc, const char *argv[]){
-    fileNames_t fileNames= {};
+    fileNames_t  fileNames = {};
+    runOptions_t options   = {};
+
+    int numArgs = 1;
+    for (int i = 1; i < argc; i++){
+        if      (!strcmp(argv[i], "-p") && i + 1 < argc)    options.profileFileName = argv[++i];
+        else if (!strcmp(argv[i], "-r"))                    options.registerTier = true;
+        else if (!strcmp(argv[i], "-j"))                    options.jit = true;
+        else                                                argv[numArgs++] = argv[i];
+    }
+    argc = numArgs;
 
     fileNames.inputFileName  = (argc == 3) ? argv[1]  : "./bin/user_input.asm";
     fileNames.outputFileName = (argc == 3) ? argv[2]  : "stdout";
     fileNames.outputFileName = "meow.txt";
 
-    Run(&fileNames);
+    Run(&fileNames, &options);
 
     return 0;
 }
@@ -129,12 +168,41 @@ static errors ProcessorCtor(spu_t* spu, const char* name){
 
     //INITIALIZE RAM:
     spu->RAM                    = (int64_t*)calloc(sizeof(int64_t), SIZE_RAM);
+    spu->kernels                = KernelsInit();
+
+    GreenCtor(&spu->green, &spu->pc, &spu->registersPointer, &spu->stk, &spu->returnStack);
 
 
+    //PROFILE COUNTERS:
+    if (spu->options->profileFileName){
+        spu->profileExecuted    = (uint64_t*)calloc(sizeof(uint64_t), spu->numCommands + 1);
+        spu->profileTaken       = (uint64_t*)calloc(sizeof(uint64_t), spu->numCommands + 1);
+    }
 
     //FILL CODE BUFFER:
-    if (!spu->errorType) FillCodeBuffer(spu);
-    else ProcessorDump(spu);
+    if (FillCodeBuffer(spu)) return ERR_;
+
+    //JIT, it records traces from what the interpreter does, so it comes instead of the register tier:
+    if (!spu->errorType && spu->options->jit && !spu->profileExecuted){
+        spu->jit = (jit_t*)calloc(sizeof(jit_t), 1);
+
+        if (spu->jit && JitCtor(spu->jit, (int64_t*)spu->codePointer, spu->numCommands)){
+            printf(YEL "jit: no code generator for this machine, interpreting\n" RESET);
+
+            free(spu->jit);
+            spu->jit = nullptr;
+        }
+    }
+
+    //REGISTER TIER, the profile counts every jump so it wants the plain loop:
+    if (!spu->errorType && spu->options->registerTier && !spu->profileExecuted && !spu->options->jit){
+        spu->regVm = (regVm_t*)calloc(sizeof(regVm_t), 1);
+
+        if (spu->regVm && RegVmCtor(spu->regVm, (int64_t*)spu->codePointer, spu->numCommands)){
+            free(spu->regVm);
+            spu->regVm = nullptr;
+        }
+    }
 
     return OK_;
 }
@@ -149,6 +217,27 @@ static errors ProcessorDtor(spu_t* spu){
     if(!spu->outputFile && spu->logFile != stdout)      fclose(spu->outputFile);
     if(!spu->logFile    && spu->logFile != stdout)      fclose(spu->logFile);
 
+    if (spu->profileExecuted && spu->profileTaken) WriteProfile(spu);
+    free(spu->profileExecuted);
+    free(spu->profileTaken);
+
+    if (spu->regVm){
+        PrintRegVmStats(&spu->regVm->stats, stdout);
+        RegVmDtor(spu->regVm);
+        free(spu->regVm);
+    }
+
+    if (spu->jit){
+        PrintJitStats(&spu->jit->stats, stdout);
+        JitDtor(spu->jit);
+        free(spu->jit);
+    }
+
+    PrintGreenStats(&spu->green, stdout);
+    GreenDtor(&spu->green);                                         //the stacks below are thread 0's again
+
+    ContainerClose(&spu->container);
+
     free(spu->codePointer);
     free(spu->registersPointer);    //stack free
     StackDtor(spu->stk);
@@ -167,11 +256,32 @@ static errors ProcessorDtor(spu_t* spu){
 
 /*=================================================================*/
 
+//a container is mapped and only its table checked here, FillCodeBuffer() verifies the sections it takes
+
+static errors CheckContainer(spu_t* spu){
+    const section_t* code = nullptr;
+
+    if (ContainerMap(&spu->container, fileno(spu->inputFile)) || !(code = ContainerFind(&spu->container, SECTION_CODE))){
+        spu->errorType = BAD_SECTION;
+
+        return ERR_;
+    }
+
+    spu->numCommands = code->size / SIZE_ARG;
+
+    printf(BYEL "sign:%llx, ver:%lld, num:%lu, sections:%lu\n" RESET, CONTAINER_SIGNATURE, CONTAINER_VERSION,
+                spu->numCommands, spu->container.numSections);
+
+    return OK_;
+}
+
 static errors CheckSignature(spu_t* spu){
                                                     //verificator
     header_t header = {};
     fread(&header, sizeof(header_t), 1, spu->inputFile);
 
+    if (header.signature == CONTAINER_SIGNATURE) return CheckContainer(spu);
+
     printf(BYEL "sign:%llx, ver:%lld, num:%lld\n" RESET, header.signature, header.version, header.numCommands);
 
     if (header.signature != SIGNATURE){
@@ -193,13 +303,69 @@ static errors CheckSignature(spu_t* spu){
 
 /*=================================================================*/
 
+//zero is cleared first and data copied over it, both have to fit in RAM
+
+static bool BadSection(const section_t* section, size_t numWords){
+    return section->address < 0 || section->address > SIZE_RAM || numWords > (size_t)(SIZE_RAM - section->address);
+}
+
+static errors FillContainer(spu_t* spu){
+    container_t*     container = &spu->container;
+    const section_t* zero      = ContainerFind(container, SECTION_ZERO);
+    const section_t* data      = ContainerFind(container, SECTION_DATA);
+    const void*      code      = ContainerSection(container, SECTION_CODE, nullptr);
+    const void*      words     = (data) ? ContainerSection(container, SECTION_DATA, nullptr) : nullptr;
+
+    if (!code || (data && (!words || BadSection(data, data->size / SIZE_ARG))) || (zero && BadSection(zero, zero->size))){
+        spu->errorType = BAD_SECTION;
+
+        return ERR_;
+    }
+
+    memcpy(spu->codePointer, code, spu->numCommands * SIZE_ARG);
+
+    if (zero) memset(spu->RAM + zero->address, 0, zero->size * SIZE_ARG);
+    if (data) memcpy(spu->RAM + data->address, words, data->size);
+
+    return OK_;
+}
+
 static errors FillCodeBuffer(spu_t* spu){
+    if (spu->container.file) return FillContainer(spu);
                                                         //verificator
     fread(spu->codePointer, 1, spu->numCommands * 8, spu->inputFile);
 
     return OK_;
 }
 
+/*=================================================================*/
+//same addresses as the binary, compile -P lays out the code it was built from
+
+static errors WriteProfile(spu_t* spu){
+    FILE* profileFile = fopen(spu->options->profileFileName, "w");
+    if (!profileFile) return ERR_;
+
+    fprintf(profileFile, "spu-profile %lu\n", spu->numCommands);
+
+    for (size_t pc = 0; pc < spu->numCommands; pc++){
+        if (spu->profileExecuted[pc]) fprintf(profileFile, "%lu %lu %lu\n", pc, spu->profileExecuted[pc], spu->profileTaken[pc]);
+    }
+
+    fclose(profileFile);
+
+    return OK_;
+}
+
+/*=================================================================*/
+
+static inline void CountBranch(spu_t* spu, size_t pc, int64_t command){
+    const instruction_t* instruction = FindInstructionByCode(command);
+    if (!instruction || instruction->args != ARGS_LABEL || pc >= spu->numCommands) return;
+
+    spu->profileExecuted[pc]++;
+    if (spu->pc != pc + 2) spu->profileTaken[pc]++;
+}
+
 /*=================================================================*/
 
 static errors PrintFilesData(spu_t* spu){
@@ -258,6 +424,41 @@ static int64_t* GetPopValue(spu_t* spu, int64_t nextArg){
 
 /*=================================================================*/
 
+static void GetBlockArgs(spu_t* spu, int64_t command, int64_t* args, size_t numArgs){
+
+    for (size_t i = 0; i < numArgs; i++){
+        int64_t arg = *((int64_t*)spu->codePointer + spu->pc + 1 + i);
+
+        if (command & (BLOCK_REG_ARG << i)) args[i] = *((int64_t*)spu->registersPointer + arg);
+        else                                args[i] = arg;
+    }
+}
+
+/*=================================================================*/
+
+static errors CheckRamBlock(spu_t* spu, int64_t addr, int64_t count){
+
+    if (addr < 0 || count < 0 || addr > SIZE_RAM - count){
+        spu->errorType = RAM_OUT_OF_RANGE;
+
+        return ERR_;
+    }
+
+    return OK_;
+}
+
+/*=================================================================*/
+
+//file:line and the label with the offset into it, nothing for a pc the table does not cover
+
+static void PrintSourceLine(FILE* logFile, const lineTable_t* lines, size_t pc){
+    sourceLine_t line = {};
+    if (LineTableFind(lines, (int64_t)pc, &line)) return;
+
+    fprintf(logFile, "%s:%lu", line.file, line.line);
+    if (line.label) fprintf(logFile, " (%.*s+%lld)", (int)line.labelSize, line.label, (int64_t)pc - line.labelAddr);
+}
+
 static errors ProcessorDump(spu_t* spu){
     if (!spu->logFile){
         spu->logFile = stdout;
@@ -266,6 +467,9 @@ static errors ProcessorDump(spu_t* spu){
 
     FILE* logFile = spu->logFile;
 
+    lineTable_t lines    = {};                                          //only decoded for a dump
+    bool        hasLines = spu->container.file && !LineTableCtor(&lines, &spu->container);
+
     fprintf(logFile, "=================================================\n");
 
     if (logFile == stdout) printf(GRN);
@@ -288,11 +492,41 @@ static errors ProcessorDump(spu_t* spu){
             break;
         }
 
+        case RAM_OUT_OF_RANGE:{
+            fprintf(logFile, "\nError: %lu - RAM block out of range\n\n",  spu->errorType);
+            break;
+        }
+
+        case THREAD_DEADLOCK:{
+            fprintf(logFile, "\nError: %lu - join with no other thread left to run\n\n",  spu->errorType);
+            break;
+        }
+
+        case BAD_THREAD_ID:{
+            fprintf(logFile, "\nError: %lu - join of a thread that never was\n\n",  spu->errorType);
+            break;
+        }
+
+        case BAD_PAR_COUNT:{
+            fprintf(logFile, "\nError: %lu - par of no threads or more than %lld\n\n",  spu->errorType, MAX_PAR_THREADS);
+            break;
+        }
+
+        case BAD_SECTION:{
+            fprintf(logFile, "\nError: %lu - bad container: no code, a bad checksum or data out of RAM\n\n",  spu->errorType);
+            break;
+        }
+
         default:{
             fprintf(logFile, "\nError: %lu\n\n",  spu->errorType);
             break;
         }
     }
+    if (hasLines && spu->codePointer){
+        fprintf(logFile, "at pc %lu: ", spu->pc);
+        PrintSourceLine(logFile, &lines, spu->pc);
+        fprintf(logFile, "\n\n");
+    }
     if (logFile == stdout) printf(RESET);
 
     //STRUCT POLES:
@@ -323,10 +557,27 @@ static errors ProcessorDump(spu_t* spu){
         fprintf(logFile, "Commands:\n");
         if (logFile == stdout) printf(RESET);
 
+        size_t      nextInstruction = 0;
+        sourceLine_t lastLine        = {};
+
         for (size_t ip = 0; ip < spu->numCommands; ip++){
 
             fprintf(spu->logFile, "pc<%0.2lu>: %lld", ip, *(cmdPtr + ip));
 
+            if (ip == nextInstruction){
+                const instruction_t* instruction = FindInstructionByCode(*(cmdPtr + ip));
+
+                fprintf(spu->logFile, "\t%s", (instruction) ? instruction->mnemonic : "???");
+                nextInstruction += InstructionLength(*(cmdPtr + ip));
+
+                sourceLine_t line = {};
+
+                if (hasLines && !LineTableFind(&lines, (int64_t)ip, &line) && (line.line != lastLine.line || line.file != lastLine.file)){
+                    fprintf(spu->logFile, "\t; %s:%lu", line.file, line.line);
+                    lastLine = line;
+                }
+            }
+
             if (ip == spu->pc){
                 if (spu->logFile == stdout) fprintf(spu->logFile, BRED  "\t\t <---- ded" RESET);
                 else                        fprintf(spu->logFile,       "\t\t <---- ded");
@@ -340,6 +591,7 @@ static errors ProcessorDump(spu_t* spu){
 
     if (logFile == stdout) printf(CYN);
     fprintf(logFile, "RAM size: %d\n", SIZE_RAM);
+    if (spu->kernels) fprintf(logFile, "Vector kernels: %s\n", spu->kernels->name);
     if (logFile == stdout) printf(RESET);
 
     fprintf(logFile, "\n");
@@ -382,9 +634,18 @@ static errors ProcessorDump(spu_t* spu){
         }
     }
 
+    //GREEN THREADS, the registers above are the running one's:
+    if (spu->green.numThreads){
+        if (logFile == stdout) printf(CYN);
+        fprintf(logFile, "\nGreen threads: %lu alive, %lu runnable, running slot %u\n",
+                spu->green.numLive, spu->green.numRunnable, spu->green.current);
+        if (logFile == stdout) printf(RESET);
+    }
 
     fprintf(logFile, "=================================================\n");
 
+    LineTableDtor(&lines);
+
     //WAIT USER INPUT
     if (logFile == stdout) getchar();
 
@@ -449,39 +710,159 @@ static errors Draw2(spu_t* spu){
 }
 
 /*=================================================================*/
+//par N, label: N OS threads run from label on one RAM, each with a copy of the registers, the return stack empty
+//and its index on the stack; the thread that ran par waits for all of them and goes on after it
+//hlt or exit ends a par thread, not the program; one that ends while the others wait at a barrier hangs them
+//
+//memory order: push and pop on RAM are plain loads and stores, two threads writing or one writing and one reading
+//the same word with nothing between them get no order, a word is never torn though
+//xadd, xchg and cmpxchg are sequentially consistent read-modify-writes, barrier waits for every thread of the par
+//and everything written before it is seen by all of them after it, par itself and its end order the same way
 
-void Run(fileNames_t* fileNames){
+static void Execute(spu_t* spu);
 
-    spu_t spu = {};
-    spu.fileNames = fileNames;
+static void* ParThread(void* arg){
+    Execute((spu_t*)arg);
 
-    bool RunCommands = 1;
+    return nullptr;
+}
+
+static errors Par(spu_t* spu, int64_t numThreads, size_t target){
+    if (numThreads <= 0 || numThreads > MAX_PAR_THREADS){
+        spu->errorType = BAD_PAR_COUNT;
+
+        return ERR_;
+    }
+
+    spu_t*      threads = (spu_t*)    calloc(sizeof(spu_t),     (size_t)numThreads);
+    pthread_t*  handles = (pthread_t*)calloc(sizeof(pthread_t), (size_t)numThreads);
+    bool*       started = (bool*)     calloc(sizeof(bool),      (size_t)numThreads);
+    parGroup_t  group   = {};
+
+    if (!threads || !handles || !started){
+        free(threads);
+        free(handles);
+        free(started);
+
+        return ERR_;
+    }
 
-    if (ProcessorCtor(&spu, "1")){
-        ProcessorDump(&spu);
-        RunCommands = 0;
+    group.numThreads = numThreads;
+    pthread_barrier_init(&group.barrier, nullptr, (unsigned)numThreads);
+
+    for (int64_t i = 0; i < numThreads; i++){
+        spu_t* thread = threads + i;
+
+        *thread = *spu;
+        thread->pc               = target;
+        thread->par              = &group;
+        thread->errorType        = 0;
+        thread->regVm            = nullptr;                                 //tiers and the profile stay with the first one
+        thread->jit              = nullptr;
+        thread->profileExecuted  = nullptr;
+        thread->profileTaken     = nullptr;
+
+        thread->stk              = (Stack_t*)calloc(sizeof(Stack_t), 1);
+        thread->returnStack      = (Stack_t*)calloc(sizeof(Stack_t), 1);
+        thread->registersPointer = calloc(SIZE_ARG, spu->numRegisters + 1);
+        StackCtor(thread->stk);
+        StackCtor(thread->returnStack);
+        memcpy(thread->registersPointer, spu->registersPointer, SIZE_ARG * (spu->numRegisters + 1));
+
+        GreenCtor(&thread->green, &thread->pc, &thread->registersPointer, &thread->stk, &thread->returnStack);
+        StackPush(thread->stk, i);
     }
 
+    //thread 0 runs on this one; one that can not be started runs here afterwards, a barrier would hang it
+    for (int64_t i = 1; i < numThreads; i++) started[i] = !pthread_create(handles + i, nullptr, ParThread, threads + i);
+
+    Execute(threads);
+
+    for (int64_t i = 1; i < numThreads; i++){
+        if (started[i]) pthread_join(handles[i], nullptr);
+        else            Execute(threads + i);
+    }
+
+    for (int64_t i = 0; i < numThreads; i++){
+        spu_t* thread = threads + i;
+
+        if (thread->errorType && !spu->errorType) spu->errorType = thread->errorType;
+
+        PrintGreenStats(&thread->green, stdout);
+        GreenDtor(&thread->green);
+
+        StackDtor(thread->stk);
+        StackDtor(thread->returnStack);
+        free(thread->stk);
+        free(thread->returnStack);
+        free(thread->registersPointer);
+    }
+
+    pthread_barrier_destroy(&group.barrier);
+    free(threads);
+    free(handles);
+    free(started);
+
+    return (spu->errorType) ? ERR_ : OK_;
+}
+
+/*=================================================================*/
+//xadd: address, addend; xchg: address, value; cmpxchg: address, expected, desired; all push what was there
+
+static errors Atomic(spu_t* spu, int64_t op){
+    int64_t addr = 0, value = 0, desired = 0;
+
+    StackPop(spu->stk, &addr);
+    StackPop(spu->stk, &value);
+    if (op == CMPXCHG) StackPop(spu->stk, &desired);
+
+    if (CheckRamBlock(spu, addr, 1)) return ERR_;
+
+    int64_t* word = spu->RAM + addr;
+
+    if      (op == XADD)    value = __atomic_fetch_add(word, value, __ATOMIC_SEQ_CST);
+    else if (op == XCHG)    value = __atomic_exchange_n(word, value, __ATOMIC_SEQ_CST);
+    else                    __atomic_compare_exchange_n(word, &value, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+
+    StackPush(spu->stk, value);
+
+    return OK_;
+}
+
+/*=================================================================*/
+
+static void Execute(spu_t* spu){
+    bool RunCommands = 1;
+
     while (RunCommands){
 
-        if (spu.pc > spu.numCommands){
+        if (spu->pc > spu->numCommands){
             RunCommands = 0;
-            ProcessorDump(&spu);
+            ProcessorDump(spu);
         }
 
-        int64_t* nextArg = (int64_t*)spu.codePointer + spu.pc;
+        if (spu->regVm){
+            regVmState_t state = {(int64_t*)spu->registersPointer, spu->RAM, spu->stk, spu->outputFile};
 
-        const char OPERATOR_MUSK = 0b00011111;
-        switch (*nextArg & OPERATOR_MUSK){
+            if (!RegVmRun(spu->regVm, &state, &spu->pc)) continue;
+            spu->regVm->stats.interpreted++;
+        }
+
+        if (spu->jit && !JitRun(spu->jit, (int64_t*)spu->registersPointer, spu->RAM, spu->stk, spu->outputFile, &spu->pc)) continue;
+
+        int64_t* nextArg = (int64_t*)spu->codePointer + spu->pc;
+        size_t   lastPc  = spu->pc;
+
+        switch (*nextArg & OPERATOR_MASK){
 
             case PUSH:{
-                StackPush(spu.stk, *GetPopValue(&spu, *nextArg));
+                StackPush(spu->stk, *GetPopValue(spu, *nextArg));
 
                 break;
             }
 
             case POP:{
-                StackPop(spu.stk, GetPopValue(&spu, *nextArg));
+                StackPop(spu->stk, GetPopValue(spu, *nextArg));
 
                 break;
             }
@@ -489,98 +870,98 @@ void Run(fileNames_t* fileNames){
             case ADD:{
                 int64_t num_first = 0, num_second = 0;
 
-                StackPop(spu.stk, &num_first);
-                StackPop(spu.stk, &num_second);
+                StackPop(spu->stk, &num_first);
+                StackPop(spu->stk, &num_second);
 
-                StackPush(spu.stk, num_first + num_second);
+                StackPush(spu->stk, num_first + num_second);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case SUB:{
                 int64_t positive = 0, negative = 0;
 
-                StackPop(spu.stk, &positive);
-                StackPop(spu.stk, &negative);
+                StackPop(spu->stk, &positive);
+                StackPop(spu->stk, &negative);
 
-                StackPush(spu.stk, positive - negative);
+                StackPush(spu->stk, positive - negative);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case MUL:{
                 int64_t num_first = 0, num_second = 0;
 
-                StackPop(spu.stk, &num_first);
-                StackPop(spu.stk, &num_second);
+                StackPop(spu->stk, &num_first);
+                StackPop(spu->stk, &num_second);
 
-                StackPush(spu.stk, num_first * num_second);
+                StackPush(spu->stk, num_first * num_second);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case DIV:{
                 int64_t numerator = 0, divisor = 0;
 
-                StackPop(spu.stk, &numerator);
-                StackPop(spu.stk, &divisor);
+                StackPop(spu->stk, &numerator);
+                StackPop(spu->stk, &divisor);
 
-                StackPush(spu.stk, numerator / divisor);
+                StackPush(spu->stk, numerator / divisor);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case SQRT:{
                 int64_t num = 0;
 
-                StackPop(spu.stk, &num);
+                StackPop(spu->stk, &num);
 
                 num = (num >= 0) ? sqrt(num) : 0;
 
-                StackPush(spu.stk, num);
+                StackPush(spu->stk, num);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case SIN:{
                 int64_t num = 0;
 
-                StackPop(spu.stk, &num);
+                StackPop(spu->stk, &num);
 
                 num = sin(num);
 
-                StackPush(spu.stk, num);
+                StackPush(spu->stk, num);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case COS:{
                 int64_t num = 0;
 
-                StackPop(spu.stk, &num);
+                StackPop(spu->stk, &num);
 
                 num = cos(num);
 
-                StackPush(spu.stk, num);
+                StackPush(spu->stk, num);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case OUT:{
                 int64_t num_out = 0;
 
-                StackPop(spu.stk, &num_out);
+                StackPop(spu->stk, &num_out);
 
-                fprintf(spu.outputFile, "%lld\n", num_out);
+                fprintf(spu->outputFile, "%lld\n", num_out);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -590,17 +971,17 @@ void Run(fileNames_t* fileNames){
                 printf(CYN "enter num:\n" RESET);
                 scanf("%lld", &num_in);
 
-                StackPush(spu.stk, num_in);
+                StackPush(spu->stk, num_in);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             case DUMP:{
-                ProcessorDump(&spu);
-                StackDump(spu.stk);
+                ProcessorDump(spu);
+                StackDump(spu->stk);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -609,7 +990,7 @@ void Run(fileNames_t* fileNames){
 
                 num_arg = *(nextArg + 1);
 
-                spu.pc = num_arg;
+                spu->pc = num_arg;
 
                 break;
             }
@@ -619,17 +1000,16 @@ void Run(fileNames_t* fileNames){
 
                 num_arg = *(nextArg + 1);
 
-                StackPop(spu.stk, &first_arg);
-                StackPop(spu.stk, &second_arg);
+                StackPop(spu->stk, &first_arg);
+                StackPop(spu->stk, &second_arg);
 
                 if (first_arg > second_arg){
-                    printf(MAG "%d\n" RESET, num_arg);
-                    spu.pc = num_arg;
+                    spu->pc = num_arg;
                     break;
                 }
 
                 else{
-                    spu.pc += 2;
+                    spu->pc += 2;
                     break;
                 }
             }
@@ -639,16 +1019,16 @@ void Run(fileNames_t* fileNames){
 
                 num_arg = *(nextArg + 1);
 
-                StackPop(spu.stk, &first_arg);
-                StackPop(spu.stk, &second_arg);
+                StackPop(spu->stk, &first_arg);
+                StackPop(spu->stk, &second_arg);
 
                 if (first_arg >= second_arg){
-                    spu.pc = num_arg;
+                    spu->pc = num_arg;
                     break;
                 }
 
                 else{
-                    spu.pc += 2;
+                    spu->pc += 2;
                     break;
                 }
             }
@@ -658,16 +1038,16 @@ void Run(fileNames_t* fileNames){
 
                 num_arg = *(nextArg + 1);
 
-                StackPop(spu.stk, &first_arg);
-                StackPop(spu.stk, &second_arg);
+                StackPop(spu->stk, &first_arg);
+                StackPop(spu->stk, &second_arg);
 
                 if (first_arg == second_arg){
-                    spu.pc = num_arg;
+                    spu->pc = num_arg;
                     break;
                 }
 
                 else{
-                    spu.pc += 2;
+                    spu->pc += 2;
                     break;
                 }
             }
@@ -677,16 +1057,16 @@ void Run(fileNames_t* fileNames){
 
                 num_arg = *(nextArg + 1);
 
-                StackPop(spu.stk, &first_arg);
-                StackPop(spu.stk, &second_arg);
+                StackPop(spu->stk, &first_arg);
+                StackPop(spu->stk, &second_arg);
 
                 if (first_arg != second_arg){
-                    spu.pc = num_arg;
+                    spu->pc = num_arg;
                     break;
                 }
 
                 else{
-                    spu.pc += 2;
+                    spu->pc += 2;
                     break;
                 }
             }
@@ -694,26 +1074,26 @@ void Run(fileNames_t* fileNames){
             case CALL:{
                 int64_t jump_to = 0;
                 jump_to = *(nextArg + 1);
-                StackPush(spu.returnStack, spu.pc);
+                StackPush(spu->returnStack, spu->pc);
 
-                spu.pc = jump_to;
+                spu->pc = jump_to;
                 break;
             }
 
             case RET:{
                 int64_t num_arg = -1;
-                StackDump(spu.returnStack);
-                StackPop(spu.returnStack, &num_arg);
+                StackDump(spu->returnStack);
+                StackPop(spu->returnStack, &num_arg);
 
-                spu.pc = num_arg + 2;
+                spu->pc = num_arg + 2;
                 break;
             }
 
             case DRAW:{
 
-                Draw1(&spu);
+                Draw1(spu);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -721,12 +1101,12 @@ void Run(fileNames_t* fileNames){
 
                 int64_t numerator = 0, divisor = 0;
 
-                StackPop(spu.stk, &numerator);
-                StackPop(spu.stk, &divisor);
+                StackPop(spu->stk, &numerator);
+                StackPop(spu->stk, &divisor);
 
-                StackPush(spu.stk, numerator % divisor);
+                StackPush(spu->stk, numerator % divisor);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -734,14 +1114,14 @@ void Run(fileNames_t* fileNames){
 
                 int64_t first = 0, second = 0, ans = 0;
 
-                StackPop(spu.stk, &first);
-                StackPop(spu.stk, &second);
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
 
                 if (first <= second) ans = 1;
 
-                StackPush(spu.stk, ans);
+                StackPush(spu->stk, ans);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -749,14 +1129,14 @@ void Run(fileNames_t* fileNames){
 
                 int64_t first = 0, second = 0, ans = 0;
 
-                StackPop(spu.stk, &first);
-                StackPop(spu.stk, &second);
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
 
                 if (first >= second) ans = 1;
 
-                StackPush(spu.stk, ans);
+                StackPush(spu->stk, ans);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -764,14 +1144,14 @@ void Run(fileNames_t* fileNames){
 
                 int64_t first = 0, second = 0, ans = 0;
 
-                StackPop(spu.stk, &first);
-                StackPop(spu.stk, &second);
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
 
                 if (first < second) ans = 1;
 
-                StackPush(spu.stk, ans);
+                StackPush(spu->stk, ans);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -779,14 +1159,14 @@ void Run(fileNames_t* fileNames){
 
                 int64_t first = 0, second = 0, ans = 0;
 
-                StackPop(spu.stk, &first);
-                StackPop(spu.stk, &second);
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
 
                 if (first > second) ans = 1;
 
-                StackPush(spu.stk, ans);
+                StackPush(spu->stk, ans);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
@@ -794,33 +1174,387 @@ void Run(fileNames_t* fileNames){
 
                 int64_t first = 0, second = 0, ans = 0;
 
-                StackPop(spu.stk, &first);
-                StackPop(spu.stk, &second);
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
 
                 if (first == second) ans = 1;
 
-                StackPush(spu.stk, ans);
+                StackPush(spu->stk, ans);
+
+                spu->pc++;
+                break;
+            }
+
+            case FILL:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //dst, value, count
+                GetBlockArgs(spu, *nextArg, args, 3);
+
+                if (CheckRamBlock(spu, args[0], args[2])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                RamFill(spu->RAM + args[0], args[1], args[2]);
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case COPY:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //dst, src, count
+                GetBlockArgs(spu, *nextArg, args, 3);
+
+                if (CheckRamBlock(spu, args[0], args[2]) || CheckRamBlock(spu, args[1], args[2])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                RamCopy(spu->RAM + args[0], spu->RAM + args[1], args[2]);
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case CMP:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //first, second, count
+                GetBlockArgs(spu, *nextArg, args, 3);
+
+                if (CheckRamBlock(spu, args[0], args[2]) || CheckRamBlock(spu, args[1], args[2])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                StackPush(spu->stk, RamCompare(spu->RAM + args[0], spu->RAM + args[1], args[2]));
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case VADD:
+            case VSUB:
+            case VMUL:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //dst, first, second, count
+                GetBlockArgs(spu, *nextArg, args, 4);
+
+                if (CheckRamBlock(spu, args[0], args[3]) || CheckRamBlock(spu, args[1], args[3]) ||
+                    CheckRamBlock(spu, args[2], args[3])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                int64_t* dst    = spu->RAM + args[0];
+                int64_t* first  = spu->RAM + args[1];
+                int64_t* second = spu->RAM + args[2];
+
+                if      ((*nextArg & OPERATOR_MASK) == VADD) spu->kernels->add(dst, first, second, args[3]);
+                else if ((*nextArg & OPERATOR_MASK) == VSUB) spu->kernels->sub(dst, first, second, args[3]);
+                else                                         spu->kernels->mul(dst, first, second, args[3]);
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case VSCALE:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //dst, src, factor, count
+                GetBlockArgs(spu, *nextArg, args, 4);
+
+                if (CheckRamBlock(spu, args[0], args[3]) || CheckRamBlock(spu, args[1], args[3])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                spu->kernels->scale(spu->RAM + args[0], spu->RAM + args[1], args[2], args[3]);
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case VDOT:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //first, second, count
+                GetBlockArgs(spu, *nextArg, args, 3);
+
+                if (CheckRamBlock(spu, args[0], args[2]) || CheckRamBlock(spu, args[1], args[2])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                StackPush(spu->stk, spu->kernels->dot(spu->RAM + args[0], spu->RAM + args[1], args[2]));
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case VSUM:
+            case VMIN:
+            case VMAX:{
+                int64_t args[MAX_BLOCK_ARGS] = {};               //src, count
+                GetBlockArgs(spu, *nextArg, args, 2);
+
+                if (CheckRamBlock(spu, args[0], args[1])){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                int64_t* src = spu->RAM + args[0];
+                int64_t  result = 0;
+
+                if      ((*nextArg & OPERATOR_MASK) == VSUM) result = spu->kernels->sum(src, args[1]);
+                else if ((*nextArg & OPERATOR_MASK) == VMIN) result = spu->kernels->min(src, args[1]);
+                else                                         result = spu->kernels->max(src, args[1]);
+
+                StackPush(spu->stk, result);
+
+                spu->pc += InstructionLength(*nextArg);
+                break;
+            }
+
+            case FADD:{
+                int64_t first = 0, second = 0;
+
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
+
+                StackPush(spu->stk, DoubleToWord(WordToDouble(first) + WordToDouble(second)));
+
+                spu->pc++;
+                break;
+            }
+
+            case FSUB:{
+                int64_t positive = 0, negative = 0;
+
+                StackPop(spu->stk, &positive);
+                StackPop(spu->stk, &negative);
+
+                StackPush(spu->stk, DoubleToWord(WordToDouble(positive) - WordToDouble(negative)));
+
+                spu->pc++;
+                break;
+            }
+
+            case FMUL:{
+                int64_t first = 0, second = 0;
+
+                StackPop(spu->stk, &first);
+                StackPop(spu->stk, &second);
+
+                StackPush(spu->stk, DoubleToWord(WordToDouble(first) * WordToDouble(second)));
+
+                spu->pc++;
+                break;
+            }
+
+            case FDIV:{
+                int64_t numerator = 0, divisor = 0;
+
+                StackPop(spu->stk, &numerator);
+                StackPop(spu->stk, &divisor);
+
+                StackPush(spu->stk, DoubleToWord(WordToDouble(numerator) / WordToDouble(divisor)));
+
+                spu->pc++;
+                break;
+            }
+
+            case FSQRT:{
+                int64_t num = 0;
+
+                StackPop(spu->stk, &num);
+                StackPush(spu->stk, DoubleToWord(sqrt(WordToDouble(num))));
+
+                spu->pc++;
+                break;
+            }
+
+            case FSIN:{
+                int64_t num = 0;
+
+                StackPop(spu->stk, &num);
+                StackPush(spu->stk, DoubleToWord(sin(WordToDouble(num))));
+
+                spu->pc++;
+                break;
+            }
+
+            case FCOS:{
+                int64_t num = 0;
+
+                StackPop(spu->stk, &num);
+                StackPush(spu->stk, DoubleToWord(cos(WordToDouble(num))));
+
+                spu->pc++;
+                break;
+            }
+
+            case ITOF:{
+                int64_t num = 0;
+
+                StackPop(spu->stk, &num);
+                StackPush(spu->stk, DoubleToWord((double)num));
+
+                spu->pc++;
+                break;
+            }
+
+            case FTOI:{
+                int64_t num = 0;
+
+                StackPop(spu->stk, &num);
+                StackPush(spu->stk, DoubleToInt(WordToDouble(num)));
+
+                spu->pc++;
+                break;
+            }
+
+            case FOUT:{
+                int64_t num_out = 0;
+
+                StackPop(spu->stk, &num_out);
+
+                fprintf(spu->outputFile, "%.*lg\n", FLOAT_OUT_PRECISION, WordToDouble(num_out));
+
+                spu->pc++;
+                break;
+            }
+
+            case FIN:{
+                double num_in = 0;
+
+                printf(CYN "enter num:\n" RESET);
+                scanf("%lf", &num_in);
+
+                StackPush(spu->stk, DoubleToWord(num_in));
+
+                spu->pc++;
+                break;
+            }
+
+            case SPAWN:{
+                int64_t id = 0;
+
+                if (GreenSpawn(&spu->green, (size_t)*(nextArg + 1), &id)){
+                    printf(RED "\nERROR: no memory for a thread, pc=%lu\n" RESET, spu->pc);
+                    RunCommands = 0;
+                    break;
+                }
+
+                StackPush(spu->stk, id);
+
+                spu->pc += 2;
+                break;
+            }
+
+            case YIELD:{
+                spu->pc++;
+                GreenYield(&spu->green);
 
-                spu.pc++;
+                break;
+            }
+
+            case JOIN:{
+                int64_t id = 0;
+
+                StackPop(spu->stk, &id);
+
+                spu->pc++;
+                greenResult result = GreenJoin(&spu->green, id);
+
+                if (result){
+                    spu->pc--;
+                    spu->errorType = (result == GREEN_DEADLOCK) ? THREAD_DEADLOCK : BAD_THREAD_ID;
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                }
+
+                break;
+            }
+
+            case EXIT:{
+                spu->pc++;
+                if (GreenExit(&spu->green) == GREEN_DONE) RunCommands = 0;
+
+                break;
+            }
+
+            case PAR:{
+                int64_t numThreads = 0;
+
+                StackPop(spu->stk, &numThreads);
+
+                if (Par(spu, numThreads, (size_t)*(nextArg + 1))){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                spu->pc += 2;
+                break;
+            }
+
+            case XADD:
+            case XCHG:
+            case CMPXCHG:{
+                if (Atomic(spu, *nextArg & OPERATOR_MASK)){
+                    ProcessorDump(spu);
+                    RunCommands = 0;
+                    break;
+                }
+
+                spu->pc++;
+                break;
+            }
+
+            case SNAP:{                                                     //one instance, nothing to share
+                spu->pc++;
+                break;
+            }
+
+            case BARRIER:{
+                if (spu->par) pthread_barrier_wait(&spu->par->barrier);
+
+                spu->pc++;
                 break;
             }
 
             case HLT:{
                 RunCommands = 0;
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
 
             default :{
-                printf(RED "\nERROR:pc=%lu\n" RESET, spu.pc);
+                printf(RED "\nERROR:pc=%lu\n" RESET, spu->pc);
 
-                spu.pc++;
+                spu->pc++;
                 break;
             }
         }
+
+        if (spu->profileExecuted) CountBranch(spu, lastPc, *nextArg);
+        if (spu->jit)             JitObserve(spu->jit, lastPc, spu->pc);
     }
 
+}
+
+/*=================================================================*/
+
+void Run(fileNames_t* fileNames, runOptions_t* options){
+
+    spu_t spu = {};
+    spu.fileNames = fileNames;
+    spu.options   = options;
+
+    if (ProcessorCtor(&spu, "1")) ProcessorDump(&spu);
+    else                          Execute(&spu);
+
     ProcessorDtor(&spu);
 }
 
@@ -0,0 +1,601 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/regvm.hpp"
+#include "../hpp/operations.hpp"
+
+const size_t  MAX_REGION_INSTRS = 64;                                   //stack instructions per region
+const size_t  MAX_NODES         = 4 * MAX_REGION_INSTRS + 2 * RV_NUM_SPU_REGS;
+const int32_t NO_NODE           = -1;
+const int32_t EXIT_USE          = INT32_MAX;
+
+static region_t noRegion = {};                                          //pc where Run() goes on by itself
+
+/*=================================================================*/
+//ssa values of one region, stack temporaries never reach memory
+
+enum nodeKind{
+    NODE_CONST  = 0,
+    NODE_REG    = 1,                                                    //spu register on entry
+    NODE_POP    = 2,                                                    //from the stack below the region
+    NODE_BIN    = 3,
+    NODE_LOAD   = 4,
+    NODE_STORE  = 5,
+    NODE_OUT    = 6
+};
+
+typedef struct node{
+    nodeKind    kind;
+    rvOp        op;
+    int32_t     a;
+    int32_t     b;
+    int64_t     imm;                                                    //constant, register, stores before a load
+
+    bool        live;
+    bool        dead;                                                   //store overwritten before any load
+    int32_t     lastUse;
+    uint16_t    slot;
+} node_t;
+
+typedef struct builder{
+    node_t      nodes[MAX_NODES];
+    size_t      numNodes;
+
+    int32_t     stack[MAX_NODES];
+    size_t      depth;
+
+    int32_t     regVal[RV_NUM_SPU_REGS];                                //NO_NODE - unchanged
+    int32_t     entryReg[RV_NUM_SPU_REGS];
+
+    int64_t     numStores;
+    int32_t     lastStoreAddr;
+    int32_t     lastStoreVal;
+} builder_t;
+
+/*=================================================================*/
+
+static inline bool IsPure(nodeKind kind){
+    return kind == NODE_CONST || kind == NODE_REG || kind == NODE_BIN || kind == NODE_LOAD;
+}
+
+static int32_t NewNode(builder_t* b, nodeKind kind, rvOp op, int32_t first, int32_t second, int64_t imm){
+
+    if (IsPure(kind)){                                                  //common subexpressions
+        for (size_t i = 0; i < b->numNodes; i++){
+            const node_t* node = b->nodes + i;
+
+            if (node->kind == kind && node->op == op && node->a == first && node->b == second && node->imm == imm) return (int32_t)i;
+        }
+    }
+
+    node_t* node = b->nodes + b->numNodes;
+
+    *node      = {};
+    node->kind = kind;
+    node->op   = op;
+    node->a    = first;
+    node->b    = second;
+    node->imm  = imm;
+
+    return (int32_t)b->numNodes++;
+}
+
+static inline int32_t Const(builder_t* b, int64_t value){
+    return NewNode(b, NODE_CONST, RV_POP, NO_NODE, NO_NODE, value);
+}
+
+static inline bool IsConst(const builder_t* b, int32_t id, int64_t value){
+    return b->nodes[id].kind == NODE_CONST && b->nodes[id].imm == value;
+}
+
+static int32_t RegValue(builder_t* b, int64_t reg){
+    if (b->regVal[reg] != NO_NODE) return b->regVal[reg];
+
+    if (b->entryReg[reg] == NO_NODE) b->entryReg[reg] = NewNode(b, NODE_REG, RV_POP, NO_NODE, NO_NODE, reg);
+
+    return b->entryReg[reg];
+}
+
+/*=================================================================*/
+//first - the top of the stack, same operand order as Run()
+
+static bool FoldBinary(rvOp op, int64_t first, int64_t second, int64_t* result){
+    uint64_t x = (uint64_t)first, y = (uint64_t)second;
+
+    switch (op){
+        case RV_ADD:    *result = (int64_t)(x + y);         return true;
+        case RV_SUB:    *result = (int64_t)(x - y);         return true;
+        case RV_MUL:    *result = (int64_t)(x * y);         return true;
+
+        case RV_DIV:
+        case RV_MOD:
+            if (second == 0 || (first == INT64_MIN && second == -1)) return false;
+
+            *result = (op == RV_DIV) ? first / second : first % second;
+            return true;
+
+        case RV_LS_EQ:  *result = (first <= second);        return true;
+        case RV_MR_EQ:  *result = (first >= second);        return true;
+        case RV_EQL:    *result = (first == second);        return true;
+        case RV_LS:     *result = (first <  second);        return true;
+        case RV_MR:     *result = (first >  second);        return true;
+
+        case RV_POP:
+        case RV_LOAD:
+        case RV_STORE:
+        case RV_OUT:
+        default:        return false;
+    }
+}
+
+static int32_t Binary(builder_t* b, rvOp op, int32_t first, int32_t second){
+    int64_t result = 0;
+
+    if (b->nodes[first].kind == NODE_CONST && b->nodes[second].kind == NODE_CONST &&
+        FoldBinary(op, b->nodes[first].imm, b->nodes[second].imm, &result)) return Const(b, result);
+
+    if (op == RV_ADD && IsConst(b, first,  0)) return second;
+    if (op == RV_ADD && IsConst(b, second, 0)) return first;
+    if (op == RV_SUB && IsConst(b, second, 0)) return first;
+    if (op == RV_MUL && IsConst(b, first,  1)) return second;
+    if (op == RV_MUL && IsConst(b, second, 1)) return first;
+
+    if (op == RV_ADD || op == RV_MUL || op == RV_EQL){                 //one order for the cse
+        if (first > second){
+            int32_t temp = first;
+            first  = second;
+            second = temp;
+        }
+    }
+
+    return NewNode(b, NODE_BIN, op, first, second, 0);
+}
+
+/*=================================================================*/
+
+static inline void Push(builder_t* b, int32_t value){
+    b->stack[b->depth++] = value;
+}
+
+static inline int32_t Pop(builder_t* b){
+    if (b->depth) return b->stack[--b->depth];
+
+    return NewNode(b, NODE_POP, RV_POP, NO_NODE, NO_NODE, 0);
+}
+
+static int32_t Load(builder_t* b, int32_t addr){
+    if (b->numStores && b->lastStoreAddr == addr) return b->lastStoreVal;          //store to load forwarding
+
+    return NewNode(b, NODE_LOAD, RV_LOAD, addr, NO_NODE, b->numStores);
+}
+
+static void Store(builder_t* b, int32_t addr, int32_t value){
+    for (size_t i = b->numNodes; i-- > 0; ){
+        node_t* node = b->nodes + i;
+
+        if (node->kind == NODE_LOAD) break;
+        if (node->kind == NODE_STORE && node->a == addr){
+            node->dead = true;
+            break;
+        }
+    }
+
+    NewNode(b, NODE_STORE, RV_STORE, addr, value, 0);
+
+    b->numStores++;
+    b->lastStoreAddr = addr;
+    b->lastStoreVal  = value;
+}
+
+/*=================================================================*/
+//same effects as GetPopValue(): imm and reg + imm go through registers[0]
+
+static int TranslatePushPop(builder_t* b, const int64_t* code, size_t pc){
+    int64_t command = code[pc];
+    bool    hasReg  = command & registerMask;
+    bool    hasImm  = command & immediateMask;
+    bool    hasMem  = command & memoryMask;
+    bool    isPush  = (command & OPERATOR_MASK) == PUSH;
+    size_t  at      = pc + 1;
+
+    if (!hasReg && !hasImm) return -1;
+
+    int64_t reg   = 0;
+    int32_t value = NO_NODE;
+
+    if (hasReg){
+        reg = code[at++];
+        if (reg < 0 || (size_t)reg >= RV_NUM_SPU_REGS) return -1;
+
+        value = RegValue(b, reg);
+    }
+
+    if (hasImm){
+        int32_t imm = Const(b, code[at++]);
+
+        value = (hasReg) ? Binary(b, RV_ADD, value, imm) : imm;
+        b->regVal[0] = value;
+    }
+
+    if (hasMem){
+        if (isPush) Push(b, Load(b, value));
+        else        Store(b, value, Pop(b));
+    }
+
+    else if (hasImm){
+        if (isPush) Push(b, value);
+        else        b->regVal[0] = Pop(b);
+    }
+
+    else{
+        if (isPush) Push(b, value);
+        else        b->regVal[reg] = Pop(b);
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static bool BinaryOp(int64_t op, rvOp* rv){
+    switch (op){
+        case ADD:   *rv = RV_ADD;   return true;
+        case SUB:   *rv = RV_SUB;   return true;
+        case MUL:   *rv = RV_MUL;   return true;
+        case DIV:   *rv = RV_DIV;   return true;
+        case MOD:   *rv = RV_MOD;   return true;
+        case LS_EQ: *rv = RV_LS_EQ; return true;
+        case MR_EQ: *rv = RV_MR_EQ; return true;
+        case EQL:   *rv = RV_EQL;   return true;
+        case LS:    *rv = RV_LS;    return true;
+        case MR:    *rv = RV_MR;    return true;
+        default:    return false;
+    }
+}
+
+static bool ExitOp(int64_t op, rvExit* exit){
+    switch (op){
+        case JMP:   *exit = RV_EXIT_JMP;    return true;
+        case JA:    *exit = RV_EXIT_JA;     return true;
+        case JAE:   *exit = RV_EXIT_JAE;    return true;
+        case JE:    *exit = RV_EXIT_JE;     return true;
+        case JNE:   *exit = RV_EXIT_JNE;    return true;
+        default:    return false;
+    }
+}
+
+/*=================================================================*/
+
+static void FreeRegion(region_t* region){
+    if (!region || region == &noRegion) return;
+
+    free(region->code);
+    free(region->consts);
+    free(region->pushSlots);
+    free(region->writeDst);
+    free(region->writeSrc);
+    free(region);
+}
+
+/*=================================================================*/
+//dead values are dropped, temporaries share frame slots once their last use is behind
+
+static region_t* Generate(builder_t* b, region_t* region, int32_t condFirst, int32_t condSecond){
+    size_t n = b->numNodes;
+
+    for (size_t i = 0; i < n; i++){
+        node_t* node = b->nodes + i;
+
+        node->lastUse = NO_NODE;
+        node->live    = node->kind == NODE_POP || node->kind == NODE_OUT || (node->kind == NODE_STORE && !node->dead);
+    }
+
+    for (size_t i = 0; i < b->depth; i++) b->nodes[b->stack[i]].live = true;
+
+    for (size_t reg = 0; reg < RV_NUM_SPU_REGS; reg++){
+        if (b->regVal[reg] != NO_NODE && b->regVal[reg] != b->entryReg[reg]) b->nodes[b->regVal[reg]].live = true;
+    }
+
+    if (condFirst  != NO_NODE) b->nodes[condFirst].live  = true;
+    if (condSecond != NO_NODE) b->nodes[condSecond].live = true;
+
+    for (size_t i = n; i-- > 0; ){                                      //operands of live values
+        node_t* node = b->nodes + i;
+        if (!node->live) continue;
+
+        if (node->a != NO_NODE) b->nodes[node->a].live = true;
+        if (node->b != NO_NODE) b->nodes[node->b].live = true;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        node_t* node = b->nodes + i;
+        if (!node->live) continue;
+
+        if (node->a != NO_NODE) b->nodes[node->a].lastUse = (int32_t)i;
+        if (node->b != NO_NODE) b->nodes[node->b].lastUse = (int32_t)i;
+    }
+
+    for (size_t i = 0; i < b->depth; i++) b->nodes[b->stack[i]].lastUse = EXIT_USE;
+
+    for (size_t reg = 0; reg < RV_NUM_SPU_REGS; reg++){
+        if (b->regVal[reg] != NO_NODE && b->regVal[reg] != b->entryReg[reg]) b->nodes[b->regVal[reg]].lastUse = EXIT_USE;
+    }
+
+    if (condFirst  != NO_NODE) b->nodes[condFirst].lastUse  = EXIT_USE;
+    if (condSecond != NO_NODE) b->nodes[condSecond].lastUse = EXIT_USE;
+
+    region->code      = (rvInstr_t*)calloc(sizeof(rvInstr_t), n + 1);
+    region->consts    = (int64_t*)  calloc(sizeof(int64_t),   n + 1);
+    region->pushSlots = (uint16_t*) calloc(sizeof(uint16_t),  b->depth + 1);
+    region->writeDst  = (uint16_t*) calloc(sizeof(uint16_t),  RV_NUM_SPU_REGS);
+    region->writeSrc  = (uint16_t*) calloc(sizeof(uint16_t),  RV_NUM_SPU_REGS);
+
+    if (!region->code || !region->consts || !region->pushSlots || !region->writeDst || !region->writeSrc){
+        FreeRegion(region);
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        node_t* node = b->nodes + i;
+        if (!node->live) continue;
+
+        if (node->kind == NODE_REG)   node->slot = (uint16_t)node->imm;
+        if (node->kind == NODE_CONST){
+            node->slot = (uint16_t)(RV_NUM_SPU_REGS + region->numConsts);
+            region->consts[region->numConsts++] = node->imm;
+        }
+    }
+
+    uint16_t freeSlots[RV_MAX_FRAME] = {};
+    size_t   numFree  = 0;
+    size_t   nextSlot = RV_NUM_SPU_REGS + region->numConsts;
+
+    for (size_t i = 0; i < n; i++){
+        node_t* node = b->nodes + i;
+        if (!node->live || node->kind == NODE_CONST || node->kind == NODE_REG) continue;
+
+        const int32_t operands[2] = {node->a, node->b};
+        for (size_t k = 0; k < 2; k++){                                 //a slot read here may be written here
+            if (operands[k] == NO_NODE) continue;
+
+            node_t* operand = b->nodes + operands[k];
+            bool    isTemp  = operand->kind != NODE_CONST && operand->kind != NODE_REG;
+
+            if (isTemp && operand->lastUse == (int32_t)i && (k == 0 || operands[0] != operands[1])) freeSlots[numFree++] = operand->slot;
+        }
+
+        rvInstr_t* instr = region->code + region->numCode++;
+        instr->op = node->op;
+        instr->a  = (node->a != NO_NODE) ? b->nodes[node->a].slot : 0;
+        instr->b  = (node->b != NO_NODE) ? b->nodes[node->b].slot : 0;
+
+        if (node->kind == NODE_STORE || node->kind == NODE_OUT) continue;
+
+        node->slot = (numFree) ? freeSlots[--numFree] : (uint16_t)nextSlot++;
+        instr->dst = node->slot;
+
+        if (node->lastUse == NO_NODE) freeSlots[numFree++] = node->slot;        //popped for nothing
+    }
+
+    for (size_t i = 0; i < b->depth; i++) region->pushSlots[region->numPushes++] = b->nodes[b->stack[i]].slot;
+
+    for (size_t reg = 0; reg < RV_NUM_SPU_REGS; reg++){
+        if (b->regVal[reg] == NO_NODE || b->regVal[reg] == b->entryReg[reg]) continue;
+
+        region->writeDst[region->numWrites] = (uint16_t)reg;
+        region->writeSrc[region->numWrites] = b->nodes[b->regVal[reg]].slot;
+        region->numWrites++;
+    }
+
+    if (condFirst  != NO_NODE) region->condFirst  = b->nodes[condFirst].slot;
+    if (condSecond != NO_NODE) region->condSecond = b->nodes[condSecond].slot;
+
+    return region;
+}
+
+/*=================================================================*/
+//straight through labels and jmps up to a branch or something only Run() knows how to do
+
+static region_t* BuildRegion(const int64_t* code, size_t numCommands, size_t pc){
+    builder_t* b      = (builder_t*)calloc(sizeof(builder_t), 1);
+    region_t*  region = (region_t*) calloc(sizeof(region_t),  1);
+
+    if (!b || !region){
+        free(b);
+        free(region);
+        return nullptr;
+    }
+
+    for (size_t reg = 0; reg < RV_NUM_SPU_REGS; reg++) b->regVal[reg] = b->entryReg[reg] = NO_NODE;
+
+    int32_t condFirst  = NO_NODE;
+    int32_t condSecond = NO_NODE;
+
+    size_t entry = pc;
+    region->exit = RV_EXIT_PC;
+
+    while (pc < numCommands && region->numStackInstrs < MAX_REGION_INSTRS){
+        int64_t command = code[pc];
+        int64_t op      = command & OPERATOR_MASK;
+        size_t  length  = InstructionLength(command);
+        rvOp    rv      = RV_POP;
+        rvExit  exit    = RV_EXIT_PC;
+
+        if (pc + length > numCommands) break;
+
+        if (op == PUSH || op == POP){
+            if (TranslatePushPop(b, code, pc)) break;
+        }
+
+        else if (BinaryOp(op, &rv)){
+            int32_t first  = Pop(b);
+            int32_t second = Pop(b);
+
+            Push(b, Binary(b, rv, first, second));
+        }
+
+        else if (op == OUT){
+            NewNode(b, NODE_OUT, RV_OUT, Pop(b), NO_NODE, 0);
+        }
+
+        else if (op == JMP && (size_t)code[pc + 1] < numCommands && (size_t)code[pc + 1] != entry){
+            region->numStackInstrs++;                                   //go on at the target, the loop itself ends the region
+            pc = (size_t)code[pc + 1];
+            continue;
+        }
+
+        else if (ExitOp(op, &exit)){
+            if (exit != RV_EXIT_JMP){
+                condFirst  = Pop(b);
+                condSecond = Pop(b);
+            }
+
+            region->exit   = exit;
+            region->target = (size_t)code[pc + 1];
+            region->fallPc = pc + length;
+            region->numStackInstrs++;
+            break;
+        }
+
+        else break;                                                     //call, ret, hlt, in, ...: Run() does those
+
+        region->numStackInstrs++;
+        pc += length;
+    }
+
+    if (region->exit == RV_EXIT_PC) region->target = pc;
+
+    if (!region->numStackInstrs){
+        free(b);
+        free(region);
+        return nullptr;
+    }
+
+    region = Generate(b, region, condFirst, condSecond);
+    free(b);
+
+    if (region && region->numCode + 1 > region->numStackInstrs){      //more dispatches than Run() would do
+        FreeRegion(region);
+        return nullptr;
+    }
+
+    return region;
+}
+
+/*=================================================================*/
+
+int RegVmCtor(regVm_t* vm, const int64_t* code, size_t numCommands){
+    if (!vm || !code) return -1;
+
+    *vm = {};
+    vm->code        = code;
+    vm->numCommands = numCommands;
+    vm->regions     = (region_t**)calloc(sizeof(region_t*), numCommands + 1);
+
+    return (vm->regions) ? 0 : -1;
+}
+
+/*=================================================================*/
+
+int RegVmDtor(regVm_t* vm){
+    if (!vm) return -1;
+
+    if (vm->regions){
+        for (size_t pc = 0; pc < vm->numCommands; pc++) FreeRegion(vm->regions[pc]);
+    }
+
+    free(vm->regions);
+    *vm = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int RegVmRun(regVm_t* vm, regVmState_t* state, size_t* pc){
+    if (*pc >= vm->numCommands) return -1;
+
+    region_t* region = vm->regions[*pc];
+
+    if (!region){
+        region = BuildRegion(vm->code, vm->numCommands, *pc);
+
+        if (region) vm->stats.regionsBuilt++;
+        else        region = &noRegion;
+
+        vm->regions[*pc] = region;
+    }
+
+    if (region == &noRegion) return -1;
+
+    int64_t frame[RV_MAX_FRAME];
+    memcpy(frame, state->registers, sizeof(int64_t) * RV_NUM_SPU_REGS);
+    memcpy(frame + RV_NUM_SPU_REGS, region->consts, sizeof(int64_t) * region->numConsts);
+
+    const rvInstr_t* end = region->code + region->numCode;
+
+    for (const rvInstr_t* instr = region->code; instr < end; instr++){
+        int64_t* dst = frame + instr->dst;
+        int64_t  x   = frame[instr->a];
+        int64_t  y   = frame[instr->b];
+
+        switch (instr->op){
+            case RV_POP:    *dst = 0;
+                            StackPop(state->stk, dst);                          break;
+
+            case RV_ADD:    *dst = (int64_t)((uint64_t)x + (uint64_t)y);        break;
+            case RV_SUB:    *dst = (int64_t)((uint64_t)x - (uint64_t)y);        break;
+            case RV_MUL:    *dst = (int64_t)((uint64_t)x * (uint64_t)y);        break;
+            case RV_DIV:    *dst = x / y;                                       break;
+            case RV_MOD:    *dst = x % y;                                       break;
+
+            case RV_LS_EQ:  *dst = (x <= y);                                    break;
+            case RV_MR_EQ:  *dst = (x >= y);                                    break;
+            case RV_EQL:    *dst = (x == y);                                    break;
+            case RV_LS:     *dst = (x <  y);                                    break;
+            case RV_MR:     *dst = (x >  y);                                    break;
+
+            case RV_LOAD:   *dst = state->RAM[x];                               break;
+            case RV_STORE:  state->RAM[x] = y;                                  break;
+            case RV_OUT:    fprintf(state->outputFile, "%lld\n", x);            break;
+
+            default:                                                            break;
+        }
+    }
+
+    for (size_t i = 0; i < region->numPushes; i++) StackPush(state->stk, frame[region->pushSlots[i]]);
+    for (size_t i = 0; i < region->numWrites; i++) state->registers[region->writeDst[i]] = frame[region->writeSrc[i]];
+
+    int64_t first  = frame[region->condFirst];
+    int64_t second = frame[region->condSecond];
+    bool    taken  = true;
+
+    switch (region->exit){
+        case RV_EXIT_JA:    taken = first >  second;    break;
+        case RV_EXIT_JAE:   taken = first >= second;    break;
+        case RV_EXIT_JE:    taken = first == second;    break;
+        case RV_EXIT_JNE:   taken = first != second;    break;
+        case RV_EXIT_PC:
+        case RV_EXIT_JMP:
+        default:                                        break;
+    }
+
+    *pc = (taken) ? region->target : region->fallPc;
+
+    vm->stats.stackInstrs += region->numStackInstrs;
+    vm->stats.vmInstrs    += region->numCode + 1;
+    vm->stats.regionsRun++;
+
+    return 0;
+}
+
+/*=================================================================*/
+
+void PrintRegVmStats(const regVmStats_t* stats, FILE* file){
+    uint64_t before = stats->stackInstrs + stats->interpreted;
+    uint64_t after  = stats->vmInstrs    + stats->interpreted;
+
+    fprintf(file, "register tier: %lu regions built, %lu run\n", stats->regionsBuilt, stats->regionsRun);
+    fprintf(file, "    %lu stack instructions ran as %lu register instructions, %lu left to the interpreter\n",
+                  stats->stackInstrs, stats->vmInstrs, stats->interpreted);
+    fprintf(file, "    dispatches: %lu -> %lu (%.2f times fewer)\n", before, after, (after) ? (double)before / (double)after : 0.0);
+}
@@ -0,0 +1,489 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/scheduler.hpp"
+
+const uint64_t LOCAL_MASK = SCHED_LOCAL_QUEUE - 1;
+
+static void*        WorkerLoop  (void* arg);
+static spuTask_t*   FindTask    (worker_t* worker);
+static void         RunTask     (worker_t* worker, spuTask_t* task);
+static void         Requeue     (worker_t* worker, spuTask_t* task);
+static bool         Sleep       (worker_t* worker);
+static void         PushGlobal  (scheduler_t* scheduler, spuTask_t* task);
+static spuTask_t*   PopGlobal   (worker_t* worker);
+static bool         LocalPush   (localQueue_t* queue, spuTask_t* task);
+static spuTask_t*   LocalPop    (localQueue_t* queue);
+static spuTask_t*   Steal       (worker_t* worker);
+static int          TaskInput   (void* data, int64_t* value, bool isFloat);
+
+/*=================================================================*/
+
+int SchedulerCtor(scheduler_t* scheduler, size_t numWorkers, uint64_t fuel){
+    if (!scheduler || !numWorkers) return -1;
+
+    *scheduler = {};
+    scheduler->numWorkers = numWorkers;
+    scheduler->fuel       = (fuel) ? fuel : SCHED_DEFAULT_FUEL;
+    scheduler->workers    = (worker_t*)calloc(sizeof(worker_t), numWorkers);
+    if (!scheduler->workers) return -1;
+
+    pthread_mutex_init(&scheduler->lock, nullptr);
+    pthread_cond_init (&scheduler->wake, nullptr);
+    pthread_cond_init (&scheduler->idle, nullptr);
+
+    for (size_t i = 0; i < numWorkers; i++){
+        scheduler->workers[i].scheduler = scheduler;
+        scheduler->workers[i].seed      = (i + 1) * 0x9E3779B97F4A7C15ull;
+    }
+
+    for (size_t i = 0; i < numWorkers; i++){
+        if (pthread_create(&scheduler->workers[i].thread, nullptr, WorkerLoop, scheduler->workers + i)){
+            scheduler->numWorkers = i;
+            SchedulerDtor(scheduler);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int SchedulerDtor(scheduler_t* scheduler){
+    if (!scheduler || !scheduler->workers) return -1;
+
+    pthread_mutex_lock(&scheduler->lock);
+    __atomic_store_n(&scheduler->stop, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&scheduler->wake);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    for (size_t i = 0; i < scheduler->numWorkers; i++) pthread_join(scheduler->workers[i].thread, nullptr);
+
+    pthread_cond_destroy (&scheduler->idle);
+    pthread_cond_destroy (&scheduler->wake);
+    pthread_mutex_destroy(&scheduler->lock);
+
+    free(scheduler->workers);
+    *scheduler = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int TaskCtor(spuTask_t* task, const spuProgram_t* program, const spuImage_t* image,
+                    int (*output)(void* data, int64_t value, bool isFloat), void* data){
+    if (!task) return -1;
+
+    *task = {};
+    task->data  = data;
+    task->state = TASK_RUNNABLE;
+
+    spuIo_t io = {task, TaskInput, output};
+
+    if (image){
+        if (SpuContextFromImage(&task->ctx, image, &io)) return -1;
+    }
+    else if (SpuContextCtor(&task->ctx, program, &io)) return -1;
+
+    pthread_mutex_init(&task->lock, nullptr);
+
+    return 0;
+}
+
+int SpuTaskCtor(spuTask_t* task, const spuProgram_t* program, int (*output)(void* data, int64_t value, bool isFloat), void* data){
+    return TaskCtor(task, program, nullptr, output, data);
+}
+
+int SpuTaskFromImage(spuTask_t* task, const spuImage_t* image, int (*output)(void* data, int64_t value, bool isFloat), void* data){
+    return TaskCtor(task, nullptr, image, output, data);
+}
+
+/*=================================================================*/
+
+int SpuTaskReset(spuTask_t* task){
+    if (!task) return -1;
+
+    pthread_mutex_lock(&task->lock);
+
+    task->state       = TASK_RUNNABLE;
+    task->inputHead   = 0;
+    task->inputTail   = 0;
+    task->inputClosed = false;
+    task->slices      = 0;
+
+    pthread_mutex_unlock(&task->lock);
+
+    return SpuContextReset(&task->ctx);
+}
+
+/*=================================================================*/
+
+int SpuTaskDtor(spuTask_t* task){
+    if (!task) return -1;
+
+    SpuContextDtor(&task->ctx);
+    pthread_mutex_destroy(&task->lock);
+    *task = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int SchedulerSpawn(scheduler_t* scheduler, spuTask_t* task){
+    if (!scheduler || !task || !task->ctx.program) return -1;
+
+    task->scheduler = scheduler;
+    task->state     = TASK_RUNNABLE;
+
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->numLive++;
+    PushGlobal(scheduler, task);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return 0;
+}
+
+/*=================================================================*/
+//a parked task goes back to the global queue, a running one finds the value at its next in
+
+static int Unpark(spuTask_t* task, bool wasParked){
+    if (!wasParked) return 0;
+
+    scheduler_t* scheduler = task->scheduler;
+
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->numParked--;
+    PushGlobal(scheduler, task);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return 0;
+}
+
+int SchedulerFeed(spuTask_t* task, int64_t value){
+    if (!task) return -1;
+
+    pthread_mutex_lock(&task->lock);
+
+    if (task->inputTail - task->inputHead == SCHED_TASK_INPUT){
+        pthread_mutex_unlock(&task->lock);
+        return -1;
+    }
+
+    task->input[task->inputTail++ % SCHED_TASK_INPUT] = value;
+
+    bool wasParked = (task->state == TASK_PARKED);
+    if (wasParked) task->state = TASK_RUNNABLE;
+
+    pthread_mutex_unlock(&task->lock);
+
+    return Unpark(task, wasParked);
+}
+
+int SchedulerClose(spuTask_t* task){
+    if (!task) return -1;
+
+    pthread_mutex_lock(&task->lock);
+
+    task->inputClosed = true;
+
+    bool wasParked = (task->state == TASK_PARKED);
+    if (wasParked) task->state = TASK_RUNNABLE;
+
+    pthread_mutex_unlock(&task->lock);
+
+    return Unpark(task, wasParked);
+}
+
+/*=================================================================*/
+
+int SchedulerWait(scheduler_t* scheduler){
+    if (!scheduler) return -1;
+
+    pthread_mutex_lock(&scheduler->lock);
+    while (scheduler->numLive != scheduler->numParked) pthread_cond_wait(&scheduler->idle, &scheduler->lock);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static int TaskInput(void* data, int64_t* value, bool isFloat){
+    spuTask_t* task = (spuTask_t*)data;
+    int        got  = 0;
+    (void)isFloat;                                                          //float values are fed as their bits
+
+    pthread_mutex_lock(&task->lock);
+
+    if      (task->inputHead != task->inputTail) *value = task->input[task->inputHead++ % SCHED_TASK_INPUT];
+    else if (task->inputClosed)                  got    = -1;
+    else                                         got    = SPU_IO_BLOCKED;
+
+    pthread_mutex_unlock(&task->lock);
+
+    return got;
+}
+
+/*=================================================================*/
+
+static void* WorkerLoop(void* arg){
+    worker_t*    worker    = (worker_t*)arg;
+    scheduler_t* scheduler = worker->scheduler;
+
+    while (!__atomic_load_n(&scheduler->stop, __ATOMIC_ACQUIRE)){
+        spuTask_t* task = FindTask(worker);
+
+        if (task) RunTask(worker, task);
+        else if (Sleep(worker)) break;
+    }
+
+    return nullptr;
+}
+
+/*=================================================================*/
+//own queue, then the global one, then half of somebody else's; the global queue goes first now and then
+//so that tasks spawned or fed from outside are not starved by the ones that keep going round
+
+static spuTask_t* FindTask(worker_t* worker){
+    spuTask_t* task = nullptr;
+
+    if (++worker->tick % SCHED_GLOBAL_EVERY == 0 && (task = PopGlobal(worker))) return task;
+
+    if ((task = LocalPop(&worker->queue))) return task;
+    if ((task = PopGlobal(worker)))        return task;
+
+    return Steal(worker);
+}
+
+/*=================================================================*/
+//counters go after the task lock: Wait() may return and the caller free the task as soon as they say so
+
+static void RunTask(worker_t* worker, spuTask_t* task){
+    scheduler_t* scheduler = worker->scheduler;
+
+    spuStatus status = SpuRunSlice(&task->ctx, scheduler->fuel);
+    task->slices++;
+    worker->slices++;
+
+    if (status == SPU_OUT_OF_FUEL){
+        Requeue(worker, task);
+        return;
+    }
+
+    pthread_mutex_lock(&task->lock);
+
+    if (status == SPU_BLOCKED && (task->inputHead != task->inputTail || task->inputClosed)){
+        pthread_mutex_unlock(&task->lock);                                  //fed after the in looked
+        Requeue(worker, task);
+        return;
+    }
+
+    bool parked = (status == SPU_BLOCKED);
+    task->state = (parked) ? TASK_PARKED : TASK_DONE;
+
+    pthread_mutex_unlock(&task->lock);
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    if (parked) scheduler->numParked++;
+    else        scheduler->numLive--;
+
+    if (scheduler->numLive == scheduler->numParked) pthread_cond_broadcast(&scheduler->idle);
+
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/*=================================================================*/
+//to the back of the own queue; with more than the one this worker runs next queued, wake somebody to steal
+
+static void Requeue(worker_t* worker, spuTask_t* task){
+    scheduler_t* scheduler = worker->scheduler;
+
+    if (!LocalPush(&worker->queue, task)){
+        pthread_mutex_lock(&scheduler->lock);
+        PushGlobal(scheduler, task);
+        pthread_mutex_unlock(&scheduler->lock);
+        return;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);                                //pairs with the one in Sleep()
+
+    if (worker->queue.tail - __atomic_load_n(&worker->queue.head, __ATOMIC_RELAXED) > 1 &&
+        __atomic_load_n(&scheduler->numSleeping, __ATOMIC_RELAXED)){
+        pthread_mutex_lock(&scheduler->lock);
+        pthread_cond_signal(&scheduler->wake);
+        pthread_mutex_unlock(&scheduler->lock);
+    }
+}
+
+/*=================================================================*/
+//true - the scheduler stops; numSleeping goes up before the queues are looked at,
+//so a Requeue() either sees the sleeper or the sleeper sees what it queued
+
+static bool Sleep(worker_t* worker){
+    scheduler_t* scheduler = worker->scheduler;
+    bool         work      = false;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    __atomic_add_fetch(&scheduler->numSleeping, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    work = (scheduler->numGlobal != 0);
+
+    for (size_t i = 0; !work && i < scheduler->numWorkers; i++){
+        localQueue_t* queue = &scheduler->workers[i].queue;
+
+        work = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) > 1;
+    }
+
+    if (!work && !scheduler->stop) pthread_cond_wait(&scheduler->wake, &scheduler->lock);
+
+    __atomic_sub_fetch(&scheduler->numSleeping, 1, __ATOMIC_SEQ_CST);
+    bool stop = scheduler->stop;
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return stop;
+}
+
+/*=================================================================*/
+//under the scheduler lock
+
+static void PushGlobal(scheduler_t* scheduler, spuTask_t* task){
+    task->next = nullptr;
+
+    if (scheduler->globalTail) scheduler->globalTail->next = task;
+    else                       scheduler->globalHead       = task;
+
+    scheduler->globalTail = task;
+    __atomic_store_n(&scheduler->numGlobal, scheduler->numGlobal + 1, __ATOMIC_RELEASE);
+
+    if (scheduler->numSleeping) pthread_cond_signal(&scheduler->wake);
+}
+
+/*=================================================================*/
+//one task to run and a fair share of the rest into the own queue
+
+static spuTask_t* PopGlobal(worker_t* worker){
+    scheduler_t* scheduler = worker->scheduler;
+
+    if (!__atomic_load_n(&scheduler->numGlobal, __ATOMIC_ACQUIRE)) return nullptr;
+
+    pthread_mutex_lock(&scheduler->lock);
+
+    spuTask_t* task  = scheduler->globalHead;
+    size_t     count = 0;
+
+    if (task){
+        size_t share = scheduler->numGlobal / scheduler->numWorkers;
+        if (share > SCHED_LOCAL_QUEUE / 2) share = SCHED_LOCAL_QUEUE / 2;
+
+        spuTask_t* next = task->next;
+        count = 1;
+
+        while (next && count <= share && LocalPush(&worker->queue, next)){
+            next = next->next;
+            count++;
+        }
+
+        scheduler->globalHead = next;
+        if (!next) scheduler->globalTail = nullptr;
+
+        __atomic_store_n(&scheduler->numGlobal, scheduler->numGlobal - count, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return task;
+}
+
+/*=================================================================*/
+//a fifo ring: only the owner pushes, the owner and thieves take from the head by a compare and swap,
+//the owner never writes over a slot a thief may still be reading since it checks the head first
+
+static bool LocalPush(localQueue_t* queue, spuTask_t* task){
+    uint64_t tail = queue->tail;
+    uint64_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= SCHED_LOCAL_QUEUE) return false;
+
+    __atomic_store_n(queue->tasks + (tail & LOCAL_MASK), task, __ATOMIC_RELAXED);
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static spuTask_t* LocalPop(localQueue_t* queue){
+    uint64_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    while (true){
+        uint64_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+        if (head == tail) return nullptr;
+
+        spuTask_t* task = __atomic_load_n(queue->tasks + (head & LOCAL_MASK), __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&queue->head, &head, head + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return task;
+    }
+}
+
+/*=================================================================*/
+//half of the first queue that has anything, from a random worker on; the thief's own queue is empty
+
+static spuTask_t* StealHalf(worker_t* thief, localQueue_t* queue){
+    spuTask_t* stolen[SCHED_LOCAL_QUEUE / 2] = {};
+    uint64_t   head  = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    uint64_t   count = 0;
+
+    while (true){
+        uint64_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+        count = tail - head;
+        if (count > SCHED_LOCAL_QUEUE){                                     //the owner went round since head was read
+            head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+            continue;
+        }
+
+        count -= count / 2;
+        if (!count) return nullptr;
+
+        for (uint64_t i = 0; i < count; i++){
+            stolen[i] = __atomic_load_n(queue->tasks + ((head + i) & LOCAL_MASK), __ATOMIC_RELAXED);
+        }
+
+        if (__atomic_compare_exchange_n(&queue->head, &head, head + count, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) break;
+    }
+
+    for (uint64_t i = 1; i < count; i++){
+        if (!LocalPush(&thief->queue, stolen[i])){
+            pthread_mutex_lock(&thief->scheduler->lock);
+            PushGlobal(thief->scheduler, stolen[i]);
+            pthread_mutex_unlock(&thief->scheduler->lock);
+        }
+    }
+
+    thief->steals++;
+
+    return stolen[0];
+}
+
+static spuTask_t* Steal(worker_t* worker){
+    scheduler_t* scheduler = worker->scheduler;
+
+    worker->seed ^= worker->seed << 13;
+    worker->seed ^= worker->seed >> 7;
+    worker->seed ^= worker->seed << 17;
+
+    size_t start = worker->seed % scheduler->numWorkers;
+
+    for (size_t i = 0; i < scheduler->numWorkers; i++){
+        worker_t* victim = scheduler->workers + (start + i) % scheduler->numWorkers;
+        if (victim == worker) continue;
+
+        spuTask_t* task = StealHalf(worker, &victim->queue);
+        if (task) return task;
+    }
+
+    return nullptr;
+}
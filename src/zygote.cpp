@@ -0,0 +1,339 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "../hpp/zygote.hpp"
+#include "../hpp/operations.hpp"
+#include "../hpp/colors.hpp"
+
+//./zygote [binary] [socket] serves the binary until ctrl-c, ./zygote run [socket] is a job on stdin and stdout:
+//echo 5 | ./zygote run > out.txt, its exit code is the job's
+
+static volatile sig_atomic_t    stopServing = 0;
+static int                      wakeFd      = -1;
+
+static int RunJob(const char* socketPath);
+
+int main(int argc, const char* argv[]){
+    if (argc >= 2 && !strcmp(argv[1], "run")) return RunJob((argc >= 3) ? argv[2] : ZYGOTE_DEFAULT_SOCKET);
+
+    const char* binaryName = (argc >= 2) ? argv[1] : "./bin/output_bin.asm";
+    const char* socketPath = (argc >= 3) ? argv[2] : ZYGOTE_DEFAULT_SOCKET;
+
+    spuProgram_t program = {};
+    zygote_t     zygote  = {};
+
+    if (SpuProgramLoad(&program, binaryName)){
+        printf(RED "zygote: can not load \"%s\"\n" RESET, binaryName);
+        return 1;
+    }
+
+    if (ZygoteCtor(&zygote, &program, socketPath)){
+        printf(RED "zygote: can not listen on \"%s\"\n" RESET, socketPath);
+        SpuProgramDtor(&program);
+        return 1;
+    }
+
+    printf(BGRN "zygote: \"%s\" on \"%s\", %s\n" RESET, binaryName, socketPath,
+           (zygote.snapped) ? "jobs start after its snap" : "jobs start at pc 0");
+    fflush(stdout);
+
+    int status = ZygoteServe(&zygote);
+
+    printf("\nzygote: %lu jobs served\n", zygote.served);
+
+    ZygoteDtor(&zygote, socketPath);
+    SpuProgramDtor(&program);
+
+    return (status) ? 1 : 0;
+}
+
+static int RunJob(const char* socketPath){
+    int32_t exitCode = 0;
+
+    if (ZygoteRequest(socketPath, STDIN_FILENO, STDOUT_FILENO, &exitCode)){
+        fprintf(stderr, "zygote: no server on \"%s\"\n", socketPath);
+        return 1;
+    }
+
+    return (exitCode == ZYGOTE_NO_CHILD) ? 1 : exitCode;
+}
+
+/*=================================================================*/
+
+static void OnChild(int signal){
+    (void)signal;
+
+    int  savedErrno = errno;
+    char byte       = 0;
+
+    if (write(wakeFd, &byte, 1) < 0) {}                                     //a full pipe wakes it all the same
+    errno = savedErrno;
+}
+
+static void OnStop(int signal){
+    (void)signal;
+
+    stopServing = 1;
+}
+
+static int NotYet(void* data, int64_t* value, bool isFloat){
+    (void)data;
+    (void)value;
+    (void)isFloat;
+
+    return SPU_IO_BLOCKED;
+}
+
+/*=================================================================*/
+//the part before the snap runs here once, in only waits for a job: a program that reads before its snap,
+//or has none, starts every job at pc 0; what it prints before the snap goes to the server's stdout
+
+static bool HasSnap(const spuProgram_t* program){
+    for (size_t pc = 0; pc < program->numCommands; pc += InstructionLength(program->code[pc])){
+        if ((program->code[pc] & OPERATOR_MASK) == SNAP) return true;
+    }
+
+    return false;
+}
+
+static int Prepare(zygote_t* zygote, const spuProgram_t* program){
+    if (SpuContextCtor(&zygote->ctx, program, nullptr)) return -1;
+    if (!HasSnap(program))                              return 0;          //or the whole program runs here
+
+    spuIo_t io = zygote->ctx.io;
+
+    zygote->ctx.io.input   = NotYet;
+    zygote->ctx.stopAtSnap = true;
+
+    zygote->snapped = (SpuRun(&zygote->ctx) == SPU_SNAPPED);
+
+    zygote->ctx.io         = io;
+    zygote->ctx.stopAtSnap = false;
+
+    if (!zygote->snapped) SpuContextReset(&zygote->ctx);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int ZygoteCtor(zygote_t* zygote, const spuProgram_t* program, const char* socketPath){
+    if (!zygote || !program || !socketPath) return -1;
+
+    *zygote = {};
+    zygote->listener = -1;
+    zygote->wake[0]  = -1;
+    zygote->wake[1]  = -1;
+
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path) || Prepare(zygote, program)){
+        ZygoteDtor(zygote, nullptr);
+        return -1;
+    }
+
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+
+    zygote->listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (zygote->listener < 0 || pipe(zygote->wake) ||
+        bind(zygote->listener, (const sockaddr*)&address, sizeof(address)) || listen(zygote->listener, ZYGOTE_BACKLOG)){
+        ZygoteDtor(zygote, nullptr);
+        return -1;
+    }
+
+    for (int i = 0; i < 2; i++){
+        fcntl(zygote->wake[i], F_SETFL, O_NONBLOCK);
+        fcntl(zygote->wake[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    fcntl(zygote->listener, F_SETFD, FD_CLOEXEC);
+
+    return 0;
+}
+
+/*=================================================================*/
+
+int ZygoteDtor(zygote_t* zygote, const char* socketPath){
+    if (!zygote) return -1;
+
+    for (size_t i = 0; i < zygote->numJobs; i++) close(zygote->jobs[i].connection);
+
+    if (zygote->listener >= 0) close(zygote->listener);
+    if (zygote->wake[0]  >= 0) close(zygote->wake[0]);
+    if (zygote->wake[1]  >= 0) close(zygote->wake[1]);
+    if (socketPath)            unlink(socketPath);
+
+    free(zygote->jobs);
+    SpuContextDtor(&zygote->ctx);
+    *zygote = {};
+
+    return 0;
+}
+
+/*=================================================================*/
+
+static void Answer(int connection, int32_t exitCode){
+    if (write(connection, &exitCode, sizeof(exitCode)) < 0) {}              //a client that left gets nothing
+    close(connection);
+}
+
+//one byte with two fds in its control message, -1 - anything else
+static int ReceiveFds(int connection, int* input, int* output){
+    char    byte    = 0;
+    iovec   part    = {&byte, 1};
+    char    control[CMSG_SPACE(2 * sizeof(int))] = {};
+    msghdr  message = {};
+
+    message.msg_iov        = &part;
+    message.msg_iovlen     = 1;
+    message.msg_control    = control;
+    message.msg_controllen = sizeof(control);
+
+    if (recvmsg(connection, &message, 0) != 1) return -1;
+
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+
+    if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS ||
+        header->cmsg_len != CMSG_LEN(2 * sizeof(int))){
+        return -1;
+    }
+
+    int fds[2] = {};
+    memcpy(fds, CMSG_DATA(header), sizeof(fds));
+
+    *input  = fds[0];
+    *output = fds[1];
+
+    return 0;
+}
+
+/*=================================================================*/
+//the child: it takes the job's fds from the client, so a client that sends nothing only stalls its own child;
+//they become stdin and stdout, the context goes on from where Prepare() left it
+
+static void RunChild(zygote_t* zygote, int connection){
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGINT,  SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    for (size_t i = 0; i < zygote->numJobs; i++) close(zygote->jobs[i].connection);
+
+    int input = -1, output = -1;
+
+    if (ReceiveFds(connection, &input, &output)) _exit(ZYGOTE_BAD_REQUEST);
+    close(connection);
+
+    if (dup2(input, STDIN_FILENO) < 0 || dup2(output, STDOUT_FILENO) < 0) _exit(SPU_ERR_MEMORY);
+
+    close(input);
+    close(output);
+
+    spuStatus status = SpuRun(&zygote->ctx);
+    fflush(stdout);
+
+    _exit((status == SPU_HALTED) ? 0 : (int)status);
+}
+
+static void Accept(zygote_t* zygote){
+    int connection = accept(zygote->listener, nullptr, nullptr);
+    if (connection < 0) return;
+
+    if (zygote->numJobs == zygote->sizeJobs){
+        size_t       newSize = (zygote->sizeJobs) ? zygote->sizeJobs * 2 : ZYGOTE_BACKLOG;
+        zygoteJob_t* jobs    = (zygoteJob_t*)realloc(zygote->jobs, sizeof(zygoteJob_t) * newSize);
+
+        if (!jobs){
+            Answer(connection, ZYGOTE_NO_CHILD);
+            return;
+        }
+
+        zygote->jobs     = jobs;
+        zygote->sizeJobs = newSize;
+    }
+
+    fflush(stdout);                                                         //or the child prints it again
+    pid_t pid = fork();
+
+    if (!pid) RunChild(zygote, connection);
+
+    if (pid < 0){
+        Answer(connection, ZYGOTE_NO_CHILD);
+        return;
+    }
+
+    zygote->jobs[zygote->numJobs++] = {pid, connection};
+}
+
+/*=================================================================*/
+
+static void Reap(zygote_t* zygote){
+    char drain[64] = {};
+    while (read(zygote->wake[0], drain, sizeof(drain)) > 0) {}
+
+    int   status = 0;
+    pid_t pid    = 0;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0){
+        for (size_t i = 0; i < zygote->numJobs; i++){
+            if (zygote->jobs[i].pid != pid) continue;
+
+            int32_t exitCode = (WIFEXITED(status)) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+            Answer(zygote->jobs[i].connection, exitCode);
+            zygote->jobs[i] = zygote->jobs[--zygote->numJobs];
+            zygote->served++;
+            break;
+        }
+    }
+}
+
+/*=================================================================*/
+
+int ZygoteServe(zygote_t* zygote){
+    if (!zygote || zygote->listener < 0) return -1;
+
+    wakeFd      = zygote->wake[1];
+    stopServing = 0;
+
+    struct sigaction onChild = {}, onStop = {};
+
+    onChild.sa_handler = OnChild;
+    onChild.sa_flags   = SA_RESTART | SA_NOCLDSTOP;
+    onStop.sa_handler  = OnStop;
+
+    sigaction(SIGCHLD, &onChild, nullptr);
+    sigaction(SIGINT,  &onStop,  nullptr);
+    sigaction(SIGTERM, &onStop,  nullptr);
+
+    pollfd fds[2] = {{zygote->listener, POLLIN, 0}, {zygote->wake[0], POLLIN, 0}};
+    int    status = 0;
+
+    while (!stopServing){
+        if (poll(fds, 2, -1) < 0){
+            if (errno == EINTR) continue;
+
+            status = -1;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) Reap(zygote);
+        if (fds[0].revents & POLLIN) Accept(zygote);
+    }
+
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGINT,  SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    return status;
+}
@@ -0,0 +1,59 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../hpp/zygote.hpp"
+
+//the client half of the zygote, ./zygote run and the benchmark both go through it
+
+/*=================================================================*/
+
+static int SendFds(int connection, int input, int output){
+    char    byte    = 'j';
+    iovec   part    = {&byte, 1};
+    char    control[CMSG_SPACE(2 * sizeof(int))] = {};
+    msghdr  message = {};
+
+    message.msg_iov        = &part;
+    message.msg_iovlen     = 1;
+    message.msg_control    = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr* header    = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type  = SCM_RIGHTS;
+    header->cmsg_len   = CMSG_LEN(2 * sizeof(int));
+
+    int fds[2] = {input, output};
+    memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+    return (sendmsg(connection, &message, 0) == 1) ? 0 : -1;
+}
+
+/*=================================================================*/
+
+int ZygoteRequest(const char* socketPath, int input, int output, int32_t* exitCode){
+    if (!socketPath || !exitCode) return -1;
+
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path)) return -1;
+    strcpy(address.sun_path, socketPath);
+
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0) return -1;
+
+    int     status = -1;
+    int32_t answer = 0;
+
+    if (!connect(connection, (const sockaddr*)&address, sizeof(address)) && !SendFds(connection, input, output) &&
+        read(connection, &answer, sizeof(answer)) == (ssize_t)sizeof(answer)){
+        *exitCode = answer;
+        status    = 0;
+    }
+
+    close(connection);
+
+    return status;
+}
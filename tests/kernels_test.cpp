@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+#include "../hpp/kernels.hpp"
+
+//every vector table against the scalar one, with dst before, on and past its sources: make kernels_test
+const size_t  TEST_WORDS   = 128;
+const size_t  TEST_BASE    = 48;                            //dst, sources start -8..8 words from it
+const int64_t MAX_SHIFT    = 8;
+const size_t  MAX_COUNT    = 37;
+
+static void Fill(int64_t* words){
+    for (size_t i = 0; i < TEST_WORDS; i++) words[i] = (int64_t)(i * 0x9E3779B97F4A7C15 >> 20) - 5000;
+}
+
+static int Check(const char* what, const int64_t* fast, const int64_t* scalar, int64_t shift, size_t count){
+    if (!memcmp(fast, scalar, TEST_WORDS * sizeof(int64_t))) return 0;
+
+    printf("%s differs from scalar: source at dst%+ld, %lu words\n", what, shift, count);
+
+    return -1;
+}
+
+int main(){
+    const vectorKernels_t* fast   = KernelsInit();
+    const vectorKernels_t* scalar = KernelsScalar();
+
+    int64_t a[TEST_WORDS] = {};
+    int64_t b[TEST_WORDS] = {};
+    int     status        = 0;
+
+    for (int64_t shift = -MAX_SHIFT; shift <= MAX_SHIFT; shift++){
+        for (size_t count = 0; count <= MAX_COUNT; count++){
+            int64_t* dstA = a + TEST_BASE;
+            int64_t* dstB = b + TEST_BASE;
+            size_t   src  = (size_t)((int64_t)TEST_BASE + shift);
+
+            Fill(a); Fill(b);
+            fast->add  (dstA, a + src, a + TEST_BASE / 2, count);
+            scalar->add(dstB, b + src, b + TEST_BASE / 2, count);
+            status |= Check("add", a, b, shift, count);
+
+            Fill(a); Fill(b);
+            fast->sub  (dstA, a + TEST_BASE / 2, a + src, count);
+            scalar->sub(dstB, b + TEST_BASE / 2, b + src, count);
+            status |= Check("sub", a, b, shift, count);
+
+            Fill(a); Fill(b);
+            fast->mul  (dstA, a + src, a + src, count);
+            scalar->mul(dstB, b + src, b + src, count);
+            status |= Check("mul", a, b, shift, count);
+
+            Fill(a); Fill(b);
+            fast->scale  (dstA, a + src, -3, count);
+            scalar->scale(dstB, b + src, -3, count);
+            status |= Check("scale", a, b, shift, count);
+        }
+    }
+
+    printf("%s against scalar: %s\n", fast->name, (status) ? "FAILED" : "ok");
+
+    return (status) ? 1 : 0;
+}
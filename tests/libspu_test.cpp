@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hpp/libspu.hpp"
+#include "../hpp/container.hpp"
+#include "../hpp/operations.hpp"
+
+//a container with a data section, run from pc 0 and from an image of it, before and after a reset: make libspu_test
+const int64_t DATA_ADDRESS = 100;
+const int64_t DATA_VALUE   = 4242;
+
+//snap before the data is read or written, so only the image can carry it: push [100], out, push 1, pop [100]
+static const int64_t CODE[] = {
+    SNAP,
+    PUSH | immediateMask | memoryMask,  DATA_ADDRESS,
+    OUT,
+    PUSH | immediateMask,               1,
+    POP  | immediateMask | memoryMask,  DATA_ADDRESS,
+    HLT
+};
+
+static const int64_t DATA[] = {7, DATA_VALUE};
+
+static int Output(void* data, int64_t value, bool isFloat){
+    (void)isFloat;
+    *(int64_t*)data = value;
+
+    return 0;
+}
+
+static int BuildProgram(spuProgram_t* program){
+    sectionData_t sections[] = {
+        {SECTION_CODE, CODE, sizeof(CODE), 0},
+        {SECTION_DATA, DATA, sizeof(DATA), DATA_ADDRESS - 1}
+    };
+
+    char*  image = nullptr;
+    size_t size  = 0;
+    FILE*  file  = open_memstream(&image, &size);
+    if (!file) return -1;
+
+    int status = ContainerWrite(file, sections, sizeof(sections) / sizeof(sections[0]));
+    if (fclose(file)) status = -1;
+
+    if (!status) status = SpuProgramFromMemory(program, image, size);
+    free(image);
+
+    return status;
+}
+
+//the context runs twice, the second time after a reset undid its write to the data
+static int Check(const char* what, spuContext_t* ctx, int64_t* out){
+    int status = 0;
+
+    for (int run = 0; run < 2; run++){
+        *out = 0;
+
+        if (run) SpuContextReset(ctx);
+        if (SpuRun(ctx) != SPU_HALTED || *out != DATA_VALUE){
+            printf("%s, run %d: read %ld, not %ld\n", what, run, *out, DATA_VALUE);
+            status = -1;
+        }
+    }
+
+    return status;
+}
+
+int main(){
+    spuProgram_t program = {};
+    spuImage_t   image   = {};
+    spuContext_t ctx     = {};
+    int64_t      out     = 0;
+    spuIo_t      io      = {&out, nullptr, Output};
+    int          status  = 0;
+
+    if (BuildProgram(&program) || SpuImageCtor(&image, &program, &io)){
+        printf("no program or image\n");
+        return 1;
+    }
+
+    if (SpuContextCtor(&ctx, &program, &io)) status = -1;
+    else{
+        status |= Check("context", &ctx, &out);
+        SpuContextDtor(&ctx);
+    }
+
+    if (SpuContextFromImage(&ctx, &image, &io)) status = -1;
+    else{
+        status |= Check("image", &ctx, &out);
+        SpuContextDtor(&ctx);
+    }
+
+    SpuImageDtor(&image);
+    SpuProgramDtor(&program);
+
+    printf("data section in contexts and images: %s\n", (status) ? "FAILED" : "ok");
+
+    return (status) ? 1 : 0;
+}